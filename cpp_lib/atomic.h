@@ -2,4 +2,106 @@
 
 extern "C" void atomicStore(unsigned int* destination, unsigned int value);
 
-extern "C" bool conditionalExchange(unsigned int* destination, unsigned int expected, unsigned int desired);
\ No newline at end of file
+extern "C" bool conditionalExchange(unsigned int* destination, unsigned int expected, unsigned int desired);
+
+extern "C" void spinLockAcquire(unsigned int* pLocked);
+extern "C" void spinLockRelease(unsigned int* pLocked);
+
+extern "C" void ticketLockAcquire(unsigned int* pTickets);
+extern "C" void ticketLockRelease(unsigned int* pTickets);
+
+#define EFLAGS_INTERRUPT_FLAG (1 << 9)
+
+// Disables interrupts and returns the previous eflags, this way it can also be used where interrupts are already disabled
+// Important: cli is a privileged instruction, this should only be used by the kernel
+inline unsigned int saveFlagsAndDisableInterrupts(){
+    unsigned int eflags;
+    __asm__ __volatile__("pushf; pop %0; cli" : "=r"(eflags) :: "memory");
+    return eflags;
+}
+
+// Only enables interrupts again if they were enabled in eflags
+inline void restoreInterrupts(unsigned int eflags){
+    if(eflags & EFLAGS_INTERRUPT_FLAG){
+        __asm__ __volatile__("sti" ::: "memory");
+    }
+}
+
+// Full memory barrier, stores before it are visible to other cpu cores before loads after it are executed
+inline void memoryBarrier(){
+    __asm__ __volatile__("lock; orl $0, (%%esp)" ::: "memory", "cc");
+}
+
+// Lock for data shared between cpu cores, a cpu core trying to take a lock which is already taken keeps spinning until 
+// it is released
+// Important: the holder should never be interrupted by code which takes the same lock (or be switched away from), 
+// thus the kernel only takes spin locks with interrupts disabled
+class SpinLock{
+    private:
+        unsigned int locked = 0;
+
+    public:
+        inline void lock(){
+            spinLockAcquire(&locked);
+        }
+
+        // Returns false immediately if the lock is already taken
+        inline bool tryLock(){
+            return conditionalExchange(&locked, 0, 1);
+        }
+
+        inline void unlock(){
+            spinLockRelease(&locked);
+        }
+
+        // Disables interrupts before taking the lock, the returned eflags should be passed to unlockAndRestoreInterrupts
+        inline unsigned int lockAndDisableInterrupts(){
+            unsigned int eflags = saveFlagsAndDisableInterrupts();
+            lock();
+            return eflags;
+        }
+
+        inline void unlockAndRestoreInterrupts(unsigned int eflags){
+            unlock();
+            restoreInterrupts(eflags);
+        }
+};
+
+// Same as SpinLock but cpu cores get the lock in the order in which they asked for it, with a SpinLock a cpu core can 
+// keep losing the race for a heavily contended lock
+// The upper 16 bits of tickets are the next ticket to hand out, the lower 16 bits are the ticket which currently holds 
+// the lock, thus the lock is free if both are equal
+class TicketLock{
+    private:
+        unsigned int tickets = 0;
+
+    public:
+        inline void lock(){
+            ticketLockAcquire(&tickets);
+        }
+
+        // Returns false immediately if the lock is already taken
+        inline bool tryLock(){
+            unsigned int currentTickets = *((volatile unsigned int*)&tickets);
+            if((currentTickets >> 16)!=(currentTickets & 0xFFFF)){
+                return false;
+            }
+            return conditionalExchange(&tickets, currentTickets, currentTickets+(1 << 16));
+        }
+
+        inline void unlock(){
+            ticketLockRelease(&tickets);
+        }
+
+        // Disables interrupts before taking the lock, the returned eflags should be passed to unlockAndRestoreInterrupts
+        inline unsigned int lockAndDisableInterrupts(){
+            unsigned int eflags = saveFlagsAndDisableInterrupts();
+            lock();
+            return eflags;
+        }
+
+        inline void unlockAndRestoreInterrupts(unsigned int eflags){
+            unlock();
+            restoreInterrupts(eflags);
+        }
+};
@@ -1,5 +1,9 @@
 global atomicStore
 global conditionalExchange
+global spinLockAcquire
+global spinLockRelease
+global ticketLockAcquire
+global ticketLockRelease
 
 ;atomicStore(unsigned int* destination, unsigned int value)
 ;store value at destination using the lock prefix
@@ -38,4 +42,76 @@ conditionalExchange:
     
     pop ecx
     pop ebx
-    ret
\ No newline at end of file
+    ret
+
+;spinLockAcquire(unsigned int* pLocked)
+;set *pLocked from 0 to 1, spin while it is 1
+spinLockAcquire:
+    push ebx
+
+    mov ebx, dword [esp+8] ; ebx = pLocked
+
+spin_lock_acquire_try:
+    mov eax, 1
+    xchg eax, dword [ebx]  ; xchg with a memory operand is always locked
+    test eax, eax
+    jz spin_lock_acquired
+
+spin_lock_acquire_wait:
+    ; Only read the lock while it is taken, this way the cache line isn't bounced between the waiting cpu cores
+    pause
+    cmp dword [ebx], 0
+    jne spin_lock_acquire_wait
+    jmp spin_lock_acquire_try
+
+spin_lock_acquired:
+    pop ebx
+    ret
+
+;spinLockRelease(unsigned int* pLocked)
+;*pLocked=0, stores are not reordered with earlier loads and stores on x86 so this is enough to release the lock
+spinLockRelease:
+    push ebx
+
+    mov ebx, dword [esp+8] ; ebx = pLocked
+    mov dword [ebx], 0
+
+    pop ebx
+    ret
+
+
+;ticketLockAcquire(unsigned int* pTickets)
+;take a ticket by incrementing the upper 16 bits of *pTickets, spin until the lower 16 bits are equal to this ticket
+ticketLockAcquire:
+    push ebx
+    push ecx
+
+    mov ebx, dword [esp+12]     ; ebx = pTickets
+    mov eax, 0x10000
+    lock xadd dword [ebx], eax  ; eax = *pTickets, *pTickets += 0x10000
+    mov ecx, eax
+    shr ecx, 16                 ; cx = ticket of this cpu core, ax = ticket which holds the lock
+
+ticket_lock_acquire_wait:
+    cmp ax, cx
+    je ticket_lock_acquired
+    pause
+    mov ax, word [ebx]
+    jmp ticket_lock_acquire_wait
+
+ticket_lock_acquired:
+    pop ecx
+    pop ebx
+    ret
+
+;ticketLockRelease(unsigned int* pTickets)
+;hand the lock to the next ticket, only the holder writes the lower 16 bits thus the increment doesn't need the lock 
+;prefix (a 16-bit increment also never carries into the upper 16 bits)
+ticketLockRelease:
+    push ebx
+
+    mov ebx, dword [esp+8] ; ebx = pTickets
+    inc word [ebx]
+
+    pop ebx
+    ret
@@ -173,7 +173,10 @@ void CoAPServer::run(){
         attemptReceiveBufferSwap();
         attemptWriteBufferSwap();
 
-        yield();
+        // Sleep until a packet was received or a response was sent
+        if(waitForSocketEvent(socketID)==-1){
+            yield();
+        }
     }
 }
 
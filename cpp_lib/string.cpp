@@ -25,6 +25,30 @@ void unsignedIntToDecimalString(unsigned int n, char str[]){
     reverse(str);
 }
 
+void unsignedLongLongToDecimalString(unsigned long long n, char str[]){
+    // Dividing a 64-bit number needs helper functions from libgcc which aren't available, instead divide by 10 per 
+    // 16 bits using 32-bit divisions
+    unsigned short parts[4];
+    for(int j=0; j<4; j++){
+        parts[j] = (unsigned short)(n >> (16*(3-j)));
+    }
+
+    int i = 0;
+    do {
+        unsigned int remainder = 0;
+        for(int j=0; j<4; j++){
+            unsigned int current = (remainder << 16) | parts[j];
+            parts[j] = (unsigned short)(current / 10);
+            remainder = current % 10;
+        }
+        str[i++] = remainder + '0';
+    } while (parts[0]!=0 || parts[1]!=0 || parts[2]!=0 || parts[3]!=0);
+
+    str[i] = '\0';
+
+    reverse(str);
+}
+
 void intToHexadecimalString(unsigned int n, char str[]){
     int i = 0;
     do {
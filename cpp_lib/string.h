@@ -4,6 +4,8 @@ void intToDecimalString(int n, char str[]);
 
 void unsignedIntToDecimalString(unsigned int n, char str[]);
 
+void unsignedLongLongToDecimalString(unsigned long long n, char str[]);
+
 void intToHexadecimalString(unsigned int n, char str[]);
 
 void reverse(char s[]);
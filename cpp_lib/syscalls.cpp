@@ -2,13 +2,52 @@
 #include "../operating_system/cpu_core/cpu_core.h"
 #include "../operating_system/network_management_task/socket_manager.h"
 #include "string.h"
+#include "atomic.h"
+
+// 0 if not checked yet, 1 if syscalls should use interrupts and 2 if they should use sysenter
+static unsigned int syscallEntryMethod = 0;
+
+// Kernel tasks can't use sysenter since sysexit always returns to ring 3, user tasks use it if the cpu supports it 
+// (the kernel checks the same SEP flag before enabling it)
+static unsigned int getSyscallEntryMethod(){
+    unsigned int codeSegment;
+    __asm__ __volatile__("movl %%cs, %0" : "=r"(codeSegment));
+    if((codeSegment & 3)==0){
+        return 1;
+    }
+
+    unsigned int eax = 1;
+    unsigned int ebx;
+    unsigned int ecx;
+    unsigned int edx;
+    __asm__ __volatile__("cpuid" : "+a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx));
+    return (edx & (1 << 11)) ? 2 : 1;
+}
+
+// Syscall number n is interrupt 48+n, with sysenter the syscall number is passed in ebx and ecx/edx hold the esp/eip 
+// to return to
+template<unsigned int syscallNumber>
+static inline void doSyscall(unsigned int eax){
+    if(syscallEntryMethod==0){
+        syscallEntryMethod = getSyscallEntryMethod();
+    }
+
+    if(syscallEntryMethod==2){
+        unsigned int ebx = syscallNumber;
+        __asm__ __volatile__(
+            "movl %%esp, %%ecx;"
+            "movl $1f, %%edx;"
+            "sysenter;"
+            "1:"
+        : "+a"(eax), "+b"(ebx) : : "ecx", "edx", "esi", "memory", "cc");
+    }
+    else{
+        __asm__ __volatile__("int %1" : "+a"(eax) : "i"(48+syscallNumber) : "memory");
+    }
+}
 
 void yield(){
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 49;"
-        ".att_syntax;"
-    : : : );
+    doSyscall<SYSCALL_YIELD>(0);
 }
 
 int openSocket(unsigned short udpPort){
@@ -16,11 +55,7 @@ int openSocket(unsigned short udpPort){
     args.udpPort = udpPort;
     args.socketID = -1;
     unsigned int eax = (unsigned int)&args;
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 50;"
-        ".att_syntax;"
-    : : "a"(eax) : "memory");
+    doSyscall<SYSCALL_OPEN_SOCKET>(eax);
     return args.socketID;
 }
 
@@ -37,11 +72,7 @@ int setReceiveBuffer(unsigned char socketID, unsigned char* buffer, unsigned int
     args.bufferSize = bufferSize;
     args.success = -1;
     unsigned int eax = (unsigned int)&args;
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 51;"
-        ".att_syntax;"
-    : : "a"(eax) : "memory");
+    doSyscall<SYSCALL_SET_RECEIVE_BUFFER>(eax);
     return args.success;
 }
 
@@ -57,11 +88,7 @@ int setSendBuffer(unsigned char socketID, unsigned char* buffer, unsigned int bu
     args.indicatorWhenFinished = indicatorWhenFinished;
     args.success = -1;
     unsigned int eax = (unsigned int)&args;
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 52;"
-        ".att_syntax;"
-    : : "a"(eax) : "memory");
+    doSyscall<SYSCALL_SET_SEND_BUFFER>(eax);
     return args.success;
 }
 
@@ -69,11 +96,7 @@ void closeSocket(unsigned char socketID){
     CloseSocketSyscallArgs args;
     args.socketID = socketID;
     unsigned int eax = (unsigned int)&args;
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 53;"
-        ".att_syntax;"
-    : : "a"(eax) : "memory");
+    doSyscall<SYSCALL_CLOSE_SOCKET>(eax);
 }
 
 void print(char* string){
@@ -82,28 +105,172 @@ void print(char* string){
     args.string = string;
 
     unsigned int eax = (unsigned int)&args;
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 54;"
-        ".att_syntax;"
-    : : "a"(eax) : "memory");
+    doSyscall<SYSCALL_PRINT>(eax);
 }
 
 unsigned int getTimerCounter(){
     GetTimerSyscallArgs args;
     unsigned int eax = (unsigned int)&args;
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 55;"
-        ".att_syntax;"
-    : : "a"(eax) : "memory");
+    doSyscall<SYSCALL_GET_TIMER>(eax);
     return args.timerCounter;
 }
 
+unsigned int getTimerTicks(){
+    GetTimerSyscallArgs args;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_GET_TIMER>(eax);
+    return args.timerTicks;
+}
+
+void readKernelInfoPage(KernelInfoPage* copy){
+    volatile KernelInfoPage* pKernelInfoPage = (volatile KernelInfoPage*)(VIRTUAL_TASK_SPACE_BEGIN_ADDR+USER_TASK_KERNEL_INFO_PAGE_OFFSET);
+
+    // The OS only updates the page while this task is interrupted, the page is read again if that happened in between
+    unsigned int sequence;
+    do{
+        sequence = pKernelInfoPage->sequence;
+        __asm__ __volatile__("" ::: "memory");
+        copy->taskID = pKernelInfoPage->taskID;
+        copy->timerTicks = pKernelInfoPage->timerTicks;
+        copy->timerCounter = pKernelInfoPage->timerCounter;
+        copy->timestampCounter = pKernelInfoPage->timestampCounter;
+        copy->timestampCounterToNsMultiplier = pKernelInfoPage->timestampCounterToNsMultiplier;
+        copy->timestampCounterToNsShift = pKernelInfoPage->timestampCounterToNsShift;
+        __asm__ __volatile__("" ::: "memory");
+    }while((sequence & 1) || sequence!=pKernelInfoPage->sequence);
+
+    copy->sequence = sequence;
+}
+
+unsigned long long getTimestampNs(){
+    volatile KernelInfoPage* pKernelInfoPage = (volatile KernelInfoPage*)(VIRTUAL_TASK_SPACE_BEGIN_ADDR+USER_TASK_KERNEL_INFO_PAGE_OFFSET);
+
+    // The calibration never changes, so no need to check the sequence
+    unsigned int multiplier = pKernelInfoPage->timestampCounterToNsMultiplier;
+    unsigned int shift = pKernelInfoPage->timestampCounterToNsShift;
+
+    unsigned int low;
+    unsigned int high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+
+    // A 64 bit times 32 bit multiplication, split in two so nothing overflows (the shift is smaller than 32)
+    return ((((unsigned long long)low)*multiplier) >> shift) + ((((unsigned long long)high)*multiplier) << (32-shift));
+}
+
+void sleepFor(unsigned int milliseconds){
+    SleepSyscallArgs args;
+    args.timerTicks = milliseconds/(1000/TIMER_TICK_FREQUENCY);
+    args.isDeadline = 0;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_SLEEP>(eax);
+}
+
+void sleepUntil(unsigned int timerTick){
+    SleepSyscallArgs args;
+    args.timerTicks = timerTick;
+    args.isDeadline = 1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_SLEEP>(eax);
+}
+
+int waitForSocketEvent(unsigned char socketID){
+    WaitForSocketEventSyscallArgs args;
+    args.socketID = socketID;
+    args.success = -1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_WAIT_FOR_SOCKET_EVENT>(eax);
+    return args.success;
+}
+
+int setupSocketRings(SocketRings* rings, unsigned char* bufferArea, unsigned int bufferAreaSize){
+    SetupSocketRingsSyscallArgs args;
+    args.rings = rings;
+    args.bufferArea = bufferArea;
+    args.bufferAreaSize = bufferAreaSize;
+    args.success = -1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_SETUP_SOCKET_RINGS>(eax);
+    return args.success;
+}
+
+bool postSocketRingSubmission(SocketRings* rings, SocketRingSubmission* submission){
+    unsigned int submissionTail = rings->submissionTail;
+    if(submissionTail-rings->submissionHead >= SOCKET_RINGS_NUM_ENTRIES){
+        return false;
+    }
+
+    rings->submissions[submissionTail & (SOCKET_RINGS_NUM_ENTRIES-1)] = *submission;
+
+    // atomicStore is also a full memory barrier, the OS sets SOCKET_RINGS_NEED_WAKEUP before it looks at the 
+    // submission tail one last time, so either the OS sees this submission or this task sees the flag
+    atomicStore((unsigned int*)&rings->submissionTail, submissionTail+1);
+    if(rings->flags & SOCKET_RINGS_NEED_WAKEUP){
+        wakeUpSocketRings();
+    }
+
+    return true;
+}
+
+bool takeSocketRingCompletion(SocketRings* rings, SocketRingCompletion* completion){
+    unsigned int completionHead = rings->completionHead;
+    if(completionHead==rings->completionTail){
+        return false;
+    }
+
+    // The completion is only read after the completion tail was read
+    __asm__ __volatile__("" ::: "memory");
+    *completion = rings->completions[completionHead & (SOCKET_RINGS_NUM_ENTRIES-1)];
+    __asm__ __volatile__("" ::: "memory");
+
+    rings->completionHead = completionHead+1;
+    return true;
+}
+
+void wakeUpSocketRings(){
+    doSyscall<SYSCALL_WAKE_UP_SOCKET_RINGS>(0);
+}
+
+int sendBatch(SendBatchEntry* entries, unsigned int numEntries){
+    SendBatchSyscallArgs args;
+    args.entries = entries;
+    args.numEntries = numEntries;
+    args.numAccepted = -1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_SEND_BATCH>(eax);
+    return args.numAccepted;
+}
+
+int recvBatch(ReceiveBatchEntry* entries, unsigned int numEntries){
+    ReceiveBatchSyscallArgs args;
+    args.entries = entries;
+    args.numEntries = numEntries;
+    args.numAccepted = -1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_RECEIVE_BATCH>(eax);
+    return args.numAccepted;
+}
+
+int futexWait(volatile int* addr, int expected, unsigned int timeout){
+    FutexWaitSyscallArgs args;
+    args.addr = addr;
+    args.expected = expected;
+    args.timeout = (timeout==WAIT_FOREVER) ? WAIT_FOREVER : timeout/(1000/TIMER_TICK_FREQUENCY);
+    args.result = -1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_FUTEX_WAIT>(eax);
+    return args.result;
+}
+
+int waitSockets(unsigned int socketMask, unsigned int timeout){
+    WaitSocketsSyscallArgs args;
+    args.socketMask = socketMask;
+    args.timeout = (timeout==WAIT_FOREVER) ? WAIT_FOREVER : timeout/(1000/TIMER_TICK_FREQUENCY);
+    args.result = -1;
+    unsigned int eax = (unsigned int)&args;
+    doSyscall<SYSCALL_WAIT_SOCKETS>(eax);
+    return args.result;
+}
+
 void e2eTestingLog(int loggedValue){
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 48;"
-        ".att_syntax;"
-    : : "a"((unsigned int)loggedValue) : "memory");
+    doSyscall<SYSCALL_E2E_TESTING_LOG>((unsigned int)loggedValue);
 }
\ No newline at end of file
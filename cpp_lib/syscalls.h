@@ -5,6 +5,110 @@
 
 #define UDP_HEADER_SIZE 8
 
+// Number of entries in the submission ring and in the completion ring of SocketRings, should be a power of 2
+#define SOCKET_RINGS_NUM_ENTRIES 64
+
+#define SOCKET_RING_SEND 1
+#define SOCKET_RING_RECEIVE 2
+
+// Set in SocketRings::flags when the OS stopped looking at the submission ring, wakeUpSocketRings should then be called
+// after submitting (postSocketRingSubmission does this)
+#define SOCKET_RINGS_NEED_WAKEUP 1
+
+typedef struct SocketRingSubmission{
+    // Not used by the OS, copied to the completion of this submission
+    unsigned int userData;
+    // SOCKET_RING_SEND or SOCKET_RING_RECEIVE
+    unsigned char opcode;
+    unsigned char socketID;
+    // Only used for sends
+    unsigned short destinationPort;
+    unsigned int destinationIP;
+    // Offset and size of the buffer in the buffer area given to setupSocketRings
+    // Sends: the first UDP_HEADER_SIZE bytes of the buffer are reserved for the OS, the data follows after them
+    // Receives: the data of a received datagram is copied to the buffer (without any header)
+    unsigned int bufferOffset;
+    unsigned int bufferSize;
+} SocketRingSubmission;
+
+typedef struct SocketRingCompletion{
+    unsigned int userData;
+    // -1 for failure, otherwise the number of data bytes which were sent or received
+    int result;
+    // Only used for receives
+    unsigned int sourceIP;
+    unsigned short sourcePort;
+} SocketRingCompletion;
+
+// The task produces submissions and consumes completions, the OS (the network management task) consumes submissions 
+// and produces completions, the indexes keep increasing and wrap around (index % SOCKET_RINGS_NUM_ENTRIES is the entry)
+typedef struct SocketRings{
+    // Written by the task
+    volatile unsigned int submissionTail;
+    volatile unsigned int completionHead;
+    // Written by the OS
+    volatile unsigned int submissionHead;
+    volatile unsigned int completionTail;
+    volatile unsigned int flags;
+    SocketRingSubmission submissions[SOCKET_RINGS_NUM_ENTRIES];
+    SocketRingCompletion completions[SOCKET_RINGS_NUM_ENTRIES];
+} SocketRings;
+
+// Every user task can read its own kernel info page (at VIRTUAL_TASK_SPACE_BEGIN_ADDR+USER_TASK_KERNEL_INFO_PAGE_OFFSET, 
+// defined in cpu_core.h) without a syscall, the OS updates it at every timer tick while the task is running
+typedef struct KernelInfoPage{
+    // Odd while the OS is updating the page, readKernelInfoPage reads again if it changed while reading
+    volatile unsigned int sequence;
+    volatile unsigned int taskID;
+    // Timer ticks and timer counter (see getTimerTicks and getTimerCounter) of the cpu core running the task, at the 
+    // moment the timestamp counter (RDTSC) had value timestampCounter
+    // In tickless mode these are only updated once the timer interrupts start again
+    volatile unsigned int timerTicks;
+    volatile unsigned int timerCounter;
+    volatile unsigned long long timestampCounter;
+    // Nanoseconds = (cycles*timestampCounterToNsMultiplier) >> timestampCounterToNsShift, the multiplier is 0 if the 
+    // timestamp counter could not be calibrated
+    volatile unsigned int timestampCounterToNsMultiplier;
+    volatile unsigned int timestampCounterToNsShift;
+} KernelInfoPage;
+
+#define BATCH_ENTRY_PENDING 0
+#define BATCH_ENTRY_DONE 1
+#define BATCH_ENTRY_FAILED -1
+
+typedef struct SendBatchEntry{
+    unsigned char socketID;
+    unsigned short destinationPort;
+    unsigned int destinationIP;
+    // The first UDP_HEADER_SIZE bytes of the buffer are reserved for the OS, the data follows after them
+    unsigned char* buffer;
+    unsigned int bufferSize;
+    // Written by the OS: BATCH_ENTRY_FAILED if the entry was not accepted, BATCH_ENTRY_PENDING until the datagram is 
+    // sent and BATCH_ENTRY_DONE afterwards
+    volatile int status;
+} SendBatchEntry;
+
+typedef struct ReceiveBatchEntry{
+    unsigned char socketID;
+    // The data of a received datagram is copied to the buffer (without any header)
+    unsigned char* buffer;
+    unsigned int bufferSize;
+    // Written by the OS before status becomes BATCH_ENTRY_DONE
+    unsigned int sourceIP;
+    unsigned short sourcePort;
+    unsigned int receivedSize;
+    // Written by the OS: BATCH_ENTRY_FAILED if the entry was not accepted, BATCH_ENTRY_PENDING until a datagram is 
+    // received and BATCH_ENTRY_DONE afterwards
+    volatile int status;
+} ReceiveBatchEntry;
+
+// Timeout which never expires
+#define WAIT_FOREVER 0xFFFFFFFF
+
+#define FUTEX_WOKEN_UP 0
+#define FUTEX_VALUE_CHANGED 1
+#define FUTEX_TIMED_OUT 2
+
 /*
     Allow the OS to switch to the next task
 */
@@ -88,6 +192,204 @@ void print(char* string);
 */
 unsigned int getTimerCounter();
 
+/*
+    Read the kernel info page of this task without a syscall
+
+    No return value, copies a consistent snapshot of the kernel info page to copy (sequence is the sequence number of 
+    the snapshot)
+
+    Only works in user tasks, kernel tasks don't have a kernel info page
+*/
+void readKernelInfoPage(KernelInfoPage* copy);
+
+/*
+    Get a timestamp in nanoseconds without a syscall
+
+    Returns the number of nanoseconds since the cpu was reset according to the timestamp counter, 0 if the OS could 
+    not calibrate the timestamp counter
+
+    Only works in user tasks, like readKernelInfoPage. Meant for measuring durations: cpu cores might not have reset 
+    their timestamp counters at exactly the same moment
+*/
+unsigned long long getTimestampNs();
+
+/*
+    Get the number of timer ticks
+
+    Returns the number of timer ticks since the OS was started, there are TIMER_TICK_FREQUENCY (defined in cpu_core.h) 
+    timer ticks per second
+
+    Like a normal unsigned int, it wraps around when it reaches the maximum value
+*/
+unsigned int getTimerTicks();
+
+/*
+    Sleep for a number of milliseconds
+
+    No return value, the task is blocked (it won't be scheduled) until the given number of milliseconds has passed, the 
+    task is woken up at the timer tick at which the sleep ends
+
+    Sleeping is precise up to one timer tick, thus the task can also be woken up up to 1000/TIMER_TICK_FREQUENCY 
+    milliseconds too early
+*/
+void sleepFor(unsigned int milliseconds);
+
+/*
+    Sleep until getTimerTicks() returns timerTick
+
+    No return value, the task is blocked (it won't be scheduled) until the timer tick is reached, returns immediately 
+    if the timer tick already passed
+
+    The timer ticks are compared with wrap around, thus timerTick should not be more than 2^31 timer ticks in the future
+*/
+void sleepUntil(unsigned int timerTick);
+
+/*
+    Wait for an event on a socket
+
+    Returns -1 for failure, otherwise returns 0
+
+    The task is blocked (it won't be scheduled) until a packet was received on the socket or until the OS finished 
+    sending a send buffer of the socket. If such an event already occurred since the previous call to 
+    waitForSocketEvent, then this call returns immediately.
+
+    When does failure occur?
+        - If the socketID does not point to an open socket
+        - If the socket is closed while waiting
+*/
+int waitForSocketEvent(unsigned char socketID);
+
+/*
+    Let the OS handle socket I/O through a pair of rings in the memory of the task
+
+    Returns -1 for failure, otherwise returns 0
+
+    After this call the task can send and receive datagrams on its open sockets without syscalls: submissions are 
+    posted with postSocketRingSubmission and the OS posts a completion for each of them, which can be taken with 
+    takeSocketRingCompletion. A completion also counts as an event for waitForSocketEvent on the socket of the 
+    submission. The buffers of the submissions are given as offsets in bufferArea, the buffer of a submission should 
+    not be used by the task until its completion was taken.
+
+    Receive submissions are used in order for the next datagrams received on their socket (before the buffer of 
+    setReceiveBuffer), datagrams which don't fit in the buffer are dropped. At most MAX_NUM_POSTED_RECEIVES_PER_SOCKET 
+    (defined in socket_manager.h) receives can be pending per socket, a receive submission beyond that fails. Pending 
+    receives of a socket that is closed are dropped without completion.
+
+    Sends are done one by one in the order they were submitted.
+
+    When does failure occur?
+        - If the rings or the buffer area are not in the task accessible space
+        - If the OS already has too many tasks using socket rings, limit is defined by MAX_NUM_SOCKET_RINGS in 
+          socket_manager.h
+    
+    However!:
+        rings==nullptr, bufferArea==nullptr and bufferAreaSize==0 is valid input, this will tell the OS to stop using 
+        the previous rings (submissions which were not completed yet are dropped)
+
+    Calling setupSocketRings again replaces the previous rings, the indexes of the rings are reset to 0
+*/
+int setupSocketRings(SocketRings* rings, unsigned char* bufferArea, unsigned int bufferAreaSize);
+
+/*
+    Post a submission to the socket rings
+
+    Returns false if the submission ring is full, otherwise returns true
+
+    Only does a syscall (wakeUpSocketRings) if the OS asked for it with SOCKET_RINGS_NEED_WAKEUP
+*/
+bool postSocketRingSubmission(SocketRings* rings, SocketRingSubmission* submission);
+
+/*
+    Take the oldest completion from the socket rings
+
+    Returns false if there is no completion, otherwise returns true and copies the completion
+*/
+bool takeSocketRingCompletion(SocketRings* rings, SocketRingCompletion* completion);
+
+/*
+    Tell the OS that new submissions were posted to the socket rings
+
+    No return value, only needed if the OS set SOCKET_RINGS_NEED_WAKEUP in the flags of the rings
+*/
+void wakeUpSocketRings();
+
+/*
+    Send multiple datagrams with one syscall
+
+    Returns -1 for failure, otherwise returns the number of accepted entries
+
+    The datagrams are queued for the network in the order of the entries, the status of every entry tells whether it was accepted and 
+    when it was sent (finishing a datagram also counts as an event for waitForSocketEvent on its socket). The entries 
+    and their buffers should not be changed by the task until their status is no longer BATCH_ENTRY_PENDING. Datagrams 
+    of a socket that is closed before they are sent are dropped and their status stays BATCH_ENTRY_PENDING.
+
+    When does failure occur?
+        - If the entries are not in the task accessible space
+        - If numEntries is bigger than MAX_BATCH_SIZE defined in socket_manager.h
+    When is an entry not accepted?
+        - If the socketID does not point to an open socket
+        - If the buffer is not in the task accessible space or is smaller than UDP_HEADER_SIZE
+        - If the OS already has too many datagrams waiting to be sent, limit is defined by 
+          MAX_NUM_TRANSMISSION_REQUESTS in socket_manager.h
+*/
+int sendBatch(SendBatchEntry* entries, unsigned int numEntries);
+
+/*
+    Post receives for multiple datagrams with one syscall
+
+    Returns -1 for failure, otherwise returns the number of accepted entries
+
+    Accepted entries are used in order for the next datagrams received on their socket (before the buffer of 
+    setReceiveBuffer), datagrams which don't fit in the buffer of the entry are dropped. When a datagram is copied to 
+    the buffer, the status of the entry becomes BATCH_ENTRY_DONE (this also counts as an event for waitForSocketEvent 
+    on the socket). The entries and their buffers should not be changed by the task until their status is no longer 
+    BATCH_ENTRY_PENDING. Entries of a socket that is closed are dropped and their status stays BATCH_ENTRY_PENDING.
+
+    When does failure occur?
+        - If the entries are not in the task accessible space
+        - If numEntries is bigger than MAX_BATCH_SIZE defined in socket_manager.h
+    When is an entry not accepted?
+        - If the socketID does not point to an open socket
+        - If the buffer is not in the task accessible space
+        - If MAX_NUM_POSTED_RECEIVES_PER_SOCKET (defined in socket_manager.h) receives are already pending on the socket
+*/
+int recvBatch(ReceiveBatchEntry* entries, unsigned int numEntries);
+
+/*
+    Wait until the OS writes to a word in the memory of the task
+
+    Returns -1 for failure, otherwise returns FUTEX_WOKEN_UP, FUTEX_VALUE_CHANGED or FUTEX_TIMED_OUT
+
+    If *addr is still expected, the task is blocked (it won't be scheduled) until the OS wrote the word and woke the task 
+    up (FUTEX_WOKEN_UP) or until timeout milliseconds have passed (FUTEX_TIMED_OUT), WAIT_FOREVER means no timeout. 
+    Otherwise this call returns FUTEX_VALUE_CHANGED immediately. The task is woken up for:
+        - The indicatorWhenFinished of setSendBuffer
+        - The 4 byte aligned word containing the last byte of the header (the high byte of the packet size) of a 
+          packet in the receive buffer of setReceiveBuffer
+        - The status of an entry of sendBatch or recvBatch
+    A task should always check the word again after this call, the word might have been written again in the meantime.
+
+    When does failure occur?
+        - If addr is not 4 byte aligned or is not in the task accessible space
+*/
+int futexWait(volatile int* addr, int expected, unsigned int timeout);
+
+/*
+    Wait for events on multiple sockets
+
+    Returns -1 for failure, 0 if the timeout passed, otherwise returns a bitmap of the ready sockets (bit i for socketID i)
+
+    socketMask lists the sockets to wait on (bit i for socketID i). The task is blocked (it won't be scheduled) until a 
+    packet was received on one of these sockets or until the OS finished sending a send buffer (or a sendBatch or socket 
+    rings datagram) of one of them, or until timeout milliseconds have passed (WAIT_FOREVER means no timeout). The events 
+    of the ready sockets are consumed just like with waitForSocketEvent, if events already occurred on the listed sockets 
+    then this call returns immediately. Sockets which are not open (or are closed while waiting) are reported as ready too.
+
+    When does failure occur?
+        - If socketMask is 0 or has bits set for socketIDs of MAX_NUM_SOCKETS_PER_TASK (defined in socket_manager.h) or higher
+*/
+int waitSockets(unsigned int socketMask, unsigned int timeout);
+
 /*
     Log a value for end-to-end testing
 
@@ -32,4 +32,27 @@ class BasicTests(VmTests):
             num_actual_logs += 1
         except TimeoutError as e:
             self.fail(f"Expected {num_expected_logs} logs in the cpu core but only encountered {num_actual_logs} actual logs")
-        self.assertEqual(num_expected_logs, num_actual_logs, f"Expected {num_expected_logs} logs in the cpu core but only encountered {num_actual_logs} actual logs")
\ No newline at end of file
+        self.assertEqual(num_expected_logs, num_actual_logs, f"Expected {num_expected_logs} logs in the cpu core but only encountered {num_actual_logs} actual logs")
+
+    def test_all_cpu_cores_should_be_started(self) -> None:
+        # The qemu config used for e2e testing should start the VM with 4 cpu cores (-smp 4)
+        try:
+            for line in self.vm.follow_logfile(marker="SMP:"):
+                self.assertEqual(line, "SMP: number of cpu cores: 4", "Not all cpu cores were started")
+                break
+        except TimeoutError as e:
+            self.fail("The number of started cpu cores was never logged")
+
+    def test_network_interrupts_should_be_sent_to_the_network_cpu_core(self) -> None:
+        # The network card and the RTC timer (both handled by the network management task) use the I/O APIC with the qemu 
+        # config used for e2e testing, the network management task gets the last cpu core instead of the first one
+        lapic_ids = []
+        try:
+            for line in self.vm.follow_logfile(marker="IOAPIC: IRQ"):
+                lapic_ids.append(line.split(" ")[-1])
+                if len(lapic_ids)==2:
+                    break
+        except TimeoutError as e:
+            self.fail(f"Expected 2 interrupts to be routed by the I/O APIC but only encountered {len(lapic_ids)}")
+        self.assertEqual(lapic_ids[0], lapic_ids[1], "Network card and RTC timer interrupts were sent to different cpu cores")
+        self.assertNotEqual(lapic_ids[0], "0", "Network interrupts shouldn't be sent to the first cpu core")
@@ -30,7 +30,9 @@ class OSManagementTaskTests(VmTests):
     CREATED_RESPONSE_CODE = 0x41
     CHANGED_RESPONSE_CODE = 0x44
     CONTENT_RESPONSE_CODE = 0x45
+    BAD_REQUEST_RESPONSE_CODE = 0x80
     FORBIDDEN_RESPONSE_CODE = 0x83
+    NOT_FOUND_RESPONSE_CODE = 0x84
 
     MAX_RUNNING_TASKS = (5+2)
     MAX_TASKS = 2*MAX_RUNNING_TASKS
@@ -119,6 +121,42 @@ class OSManagementTaskTests(VmTests):
 
         return asyncio.run(check_task_state(self.os_ip, OSManagementTaskTests.OS_MGMT_PORT, id))
 
+    def set_task_weight(self, id: int, weight: int) -> OSMgmtResponse:
+        async def set_weight(ip: str, port: int, id: int, weight: int) -> OSMgmtResponse:
+            context = await Context.create_client_context()
+            uri = f"coap://{ip}:{port}/tasks/{id}/weight"
+            request = Message(code=PUT, uri=uri, content_format=ContentFormat.TEXT, payload=str(weight).encode())
+            return await self.coap_request_with_timeout(request, context, OSManagementTaskTests.COAP_TIMEOUT)
+
+        return asyncio.run(set_weight(self.os_ip, OSManagementTaskTests.OS_MGMT_PORT, id, weight))
+
+    def set_task_quantum(self, id: int, quantum: int) -> OSMgmtResponse:
+        async def set_quantum(ip: str, port: int, id: int, quantum: int) -> OSMgmtResponse:
+            context = await Context.create_client_context()
+            uri = f"coap://{ip}:{port}/tasks/{id}/quantum"
+            request = Message(code=PUT, uri=uri, content_format=ContentFormat.TEXT, payload=str(quantum).encode())
+            return await self.coap_request_with_timeout(request, context, OSManagementTaskTests.COAP_TIMEOUT)
+
+        return asyncio.run(set_quantum(self.os_ip, OSManagementTaskTests.OS_MGMT_PORT, id, quantum))
+
+    def get_task_stats(self, id: int) -> OSMgmtResponse:
+        async def get_stats(ip: str, port: int, id: int) -> OSMgmtResponse:
+            context = await Context.create_client_context()
+            uri = f"coap://{ip}:{port}/tasks/{id}/stats"
+            request = Message(code=GET, uri=uri)
+            return await self.coap_request_with_timeout(request, context, OSManagementTaskTests.COAP_TIMEOUT)
+
+        return asyncio.run(get_stats(self.os_ip, OSManagementTaskTests.OS_MGMT_PORT, id))
+
+    def get_scheduler_stats(self) -> OSMgmtResponse:
+        async def get_stats(ip: str, port: int) -> OSMgmtResponse:
+            context = await Context.create_client_context()
+            uri = f"coap://{ip}:{port}/scheduler/stats"
+            request = Message(code=GET, uri=uri)
+            return await self.coap_request_with_timeout(request, context, OSManagementTaskTests.COAP_TIMEOUT)
+
+        return asyncio.run(get_stats(self.os_ip, OSManagementTaskTests.OS_MGMT_PORT))
+
     def remove_user_task(self, id: int) -> OSMgmtResponse:
         async def remove_task(ip: str, port: int, id: int) -> OSMgmtResponse:
             context = await Context.create_client_context()
@@ -337,24 +375,13 @@ class OSManagementTaskTests(VmTests):
         self.start_user_task(2)
 
         # Check that the task is running
-        begin = time.perf_counter()
-        while True:
-            found_exceptionentry = False
-
-            try:
-                for line in self.vm.follow_logfile(marker="Exception:"):
-                    exceptionValue = line.split(" ")[1]
-                    if exceptionValue == "14":
-                        found_exceptionentry = True
-                        break
-            except TimeoutError as e:
-                self.fail(f"Timout while waiting for exception entry to occur")
-            
-            if found_exceptionentry:
+        try:
+            for line in self.vm.follow_logfile(marker="Exception:"):
+                exceptionValue = line.split(" ")[1]
+                self.assertEqual(exceptionValue, "14", f"Expected value 14 but got {exceptionValue}")
                 break
-
-            end = time.perf_counter()
-            self.assertTrue((end-begin) <= 5, "Waiting for 'Exception: 14' timed out after 5 seconds")
+        except TimeoutError as e:
+            self.fail(f"Timout while waiting for exception entry to occur")
         
         # Create task logging LogInt: 1
         self.create_new_task(3)
@@ -370,34 +397,44 @@ class OSManagementTaskTests(VmTests):
         except TimeoutError as e:
             self.fail(f"Timout while waiting for log entry to occur")
         
-        # Now check that tasks alternate LogInt: 1 -> Exception: 14 -> Exception: 13
+        # Tasks which caused an exception should never be scheduled again
+        try:
+            for line in self.vm.follow_logfile(marker="Exception:", timeout=5):
+                self.fail(f"Crashed task was scheduled again and caused another exception: {line}")
+        except TimeoutError as e:
+            pass
+
         try:
-            for line in self.vm.follow_logfile(marker="Exception:"):
-                exceptionValue = line.split(" ")[1]
-                self.assertEqual(exceptionValue, "14", f"Expected value 14 but got {exceptionValue}")
-                break
-            for line in self.vm.follow_logfile(marker="Exception:"):
-                exceptionValue = line.split(" ")[1]
-                self.assertEqual(exceptionValue, "13", f"Expected value 13 but got {exceptionValue}")
-                break
-            for line in self.vm.follow_logfile(marker="LogInt:"):
-                logintValue = line.split(" ")[1]
-                self.assertEqual(logintValue, "1", f"Expected value 1 but got {logintValue}")
-                break
-            for line in self.vm.follow_logfile(marker="Exception:"):
-                exceptionValue = line.split(" ")[1]
-                self.assertEqual(exceptionValue, "14", f"Expected value 14 but got {exceptionValue}")
-                break
-            for line in self.vm.follow_logfile(marker="Exception:"):
-                exceptionValue = line.split(" ")[1]
-                self.assertEqual(exceptionValue, "13", f"Expected value 13 but got {exceptionValue}")
-                break
             for line in self.vm.follow_logfile(marker="LogInt:"):
                 logintValue = line.split(" ")[1]
                 self.assertEqual(logintValue, "1", f"Expected value 1 but got {logintValue}")
                 break
         except TimeoutError as e:
-            self.fail(f"Timout while waiting for log entry or exception entry to occur")
+            self.fail(f"Timout while waiting for log entry to occur")
+        
+        # The state of the crashed tasks should tell which exception occurred
+        response = self.check_task_state(1)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CONTENT_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CONTENT_RESPONSE_CODE} but got {response.response.code}")
+        lines = response.response.payload.decode().split("\n")
+        self.assertEqual(lines[0], "Crashed", f"Expected Crashed but got {lines[0]}")
+        self.assertEqual(lines[1], "exception: 13", f"Expected exception 13 but got {lines[1]}")
+
+        response = self.check_task_state(2)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CONTENT_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CONTENT_RESPONSE_CODE} but got {response.response.code}")
+        lines = response.response.payload.decode().split("\n")
+        self.assertEqual(lines[0], "Crashed", f"Expected Crashed but got {lines[0]}")
+        self.assertEqual(lines[1], "exception: 14", f"Expected exception 14 but got {lines[1]}")
+        # page_fault_task writes to address 100
+        self.assertEqual(lines[2], "faultAddress: 0x64", f"Expected faultAddress 0x64 but got {lines[2]}")
+
+        response = self.check_task_state(3)
+        self.assertEqual(response.response.payload.decode(), "Running", f"Expected Running but got {response.response.payload.decode()}")
+
+        # Crashed tasks can still be removed
+        response = self.remove_user_task(1)
+        self.assertEqual(response.response.code, OSManagementTaskTests.DELETED_REPONSE_CODE, f"Expected {OSManagementTaskTests.DELETED_REPONSE_CODE} but got {response.response.code}")
+        response = self.remove_user_task(2)
+        self.assertEqual(response.response.code, OSManagementTaskTests.DELETED_REPONSE_CODE, f"Expected {OSManagementTaskTests.DELETED_REPONSE_CODE} but got {response.response.code}")
 
     def test_removing_task_should_close_all_opened_sockets(self) -> None:
         # Create tasks which opens some sockets
@@ -590,4 +627,189 @@ class OSManagementTaskTests(VmTests):
 
             end = time.perf_counter()
             self.assertTrue((end-begin) <= 5, "Waiting for 'Logint: 2' timed out after 5 seconds")
-        
\ No newline at end of file
+        
+    
+    def test_setting_task_weight_should_only_accept_valid_weights(self) -> None:
+        # Setting the weight of a task which doesn't exist should fail
+        response = self.set_task_weight(1, 2048)
+        self.assertEqual(response.response.code, OSManagementTaskTests.NOT_FOUND_RESPONSE_CODE, f"Expected {OSManagementTaskTests.NOT_FOUND_RESPONSE_CODE} but got {response.response.code}")
+
+        self.create_new_task(1)
+        self.set_task_code("logint_1_task_no_yield", 1)
+
+        # Weight can be set before the task is running
+        response = self.set_task_weight(1, 4096)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CHANGED_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CHANGED_RESPONSE_CODE} but got {response.response.code}")
+
+        self.start_user_task(1)
+
+        # Weight can also be changed while the task is running
+        response = self.set_task_weight(1, 65536)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CHANGED_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CHANGED_RESPONSE_CODE} but got {response.response.code}")
+
+        # Weights outside of 1 till 65536 are not allowed
+        response = self.set_task_weight(1, 0)
+        self.assertEqual(response.response.code, OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE, f"Expected {OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE} but got {response.response.code}")
+        response = self.set_task_weight(1, 65537)
+        self.assertEqual(response.response.code, OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE, f"Expected {OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE} but got {response.response.code}")
+
+        # A task with the lowest weight should still get some cpu time
+        self.create_new_task(2)
+        self.set_task_code("logint_2_task_no_yield", 2)
+        response = self.set_task_weight(2, 1)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CHANGED_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CHANGED_RESPONSE_CODE} but got {response.response.code}")
+        self.start_user_task(2)
+
+        begin = time.perf_counter()
+        while True:
+            found_logentry = False
+
+            try:
+                for line in self.vm.follow_logfile(marker="LogInt:"):
+                    logintValue = line.split(" ")[1]
+                    if logintValue == "2":
+                        found_logentry = True
+                        break
+            except TimeoutError as e:
+                self.fail(f"Timout while waiting for log entry to occur")
+
+            if found_logentry:
+                break
+
+            end = time.perf_counter()
+            self.assertTrue((end-begin) <= 5, "Waiting for 'Logint: 2' timed out after 5 seconds")
+
+    
+    def test_tasks_with_different_quanta_should_both_run(self) -> None:
+        self.create_new_task(1)
+        self.set_task_code("logint_1_task_no_yield", 1)
+
+        # Quanta outside of 1 till 1000 are not allowed
+        response = self.set_task_quantum(1, 0)
+        self.assertEqual(response.response.code, OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE, f"Expected {OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE} but got {response.response.code}")
+        response = self.set_task_quantum(1, 1001)
+        self.assertEqual(response.response.code, OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE, f"Expected {OSManagementTaskTests.BAD_REQUEST_RESPONSE_CODE} but got {response.response.code}")
+
+        response = self.set_task_quantum(1, 1000)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CHANGED_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CHANGED_RESPONSE_CODE} but got {response.response.code}")
+        self.start_user_task(1)
+
+        self.create_new_task(2)
+        self.set_task_code("logint_2_task_no_yield", 2)
+        response = self.set_task_quantum(2, 1)
+        self.assertEqual(response.response.code, OSManagementTaskTests.CHANGED_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CHANGED_RESPONSE_CODE} but got {response.response.code}")
+        self.start_user_task(2)
+
+        # Both tasks should keep alternating
+        for expected_value in ["1", "2", "1", "2"]:
+            begin = time.perf_counter()
+            while True:
+                found_logentry = False
+
+                try:
+                    for line in self.vm.follow_logfile(marker="LogInt:"):
+                        logintValue = line.split(" ")[1]
+                        if logintValue == expected_value:
+                            found_logentry = True
+                            break
+                except TimeoutError as e:
+                    self.fail(f"Timout while waiting for log entry to occur")
+
+                if found_logentry:
+                    break
+
+                end = time.perf_counter()
+                self.assertTrue((end-begin) <= 5, f"Waiting for 'Logint: {expected_value}' timed out after 5 seconds")
+
+    
+    def test_tasks_using_sse_registers_should_not_see_each_others_values(self) -> None:
+        self.create_new_task(1)
+        self.set_task_code("sse_1_task", 1)
+        self.start_user_task(1)
+
+        self.create_new_task(2)
+        self.set_task_code("sse_2_task", 2)
+        self.start_user_task(2)
+
+        # Both tasks should keep running and never log 99 (meaning their SSE register was changed by another task)
+        found_logentries = set()
+        begin = time.perf_counter()
+        while True:
+            try:
+                for line in self.vm.follow_logfile(marker="LogInt:"):
+                    logintValue = line.split(" ")[1]
+                    self.assertNotEqual(logintValue, "99", "SSE register of a task was changed by another task")
+                    found_logentries.add(logintValue)
+                    break
+            except TimeoutError as e:
+                self.fail(f"Timout while waiting for log entry to occur")
+
+            end = time.perf_counter()
+            if (end-begin) > 5:
+                break
+
+        self.assertTrue("1" in found_logentries and "2" in found_logentries, "Both tasks should have been running")
+
+
+    def test_scheduler_stats_should_count_task_switches(self) -> None:
+        response = self.get_scheduler_stats()
+        self.assertEqual(response.response.code, OSManagementTaskTests.CONTENT_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CONTENT_RESPONSE_CODE} but got {response.response.code}")
+
+        stats = {}
+        for line in response.response.payload.decode().split("\n"):
+            name, value = line.split(": ")
+            stats[name] = int(value)
+
+        self.assertTrue(stats["taskSwitches"] > 0, "Some task switches should already have happened")
+        self.assertTrue(stats["pageDirectoryReloads"] <= stats["taskSwitches"], "There can't be more page directory reloads than task switches")
+        self.assertTrue(stats["averageTaskSwitchCycles"] > 0, "A task switch can't take 0 cycles")
+        self.assertTrue(stats["wakeUpPreemptions"] > 0, "Packets received by the network interface should have woken up the network management task")
+        self.assertTrue(stats["wakeUpPreemptions"] <= stats["taskSwitches"], "There can't be more wake up preemptions than task switches")
+
+
+    def test_timer_interrupts_should_be_skipped_while_idle(self) -> None:
+        stats = []
+        for i in range(2):
+            if i>0:
+                time.sleep(2)
+
+            response = self.get_scheduler_stats()
+            self.assertEqual(response.response.code, OSManagementTaskTests.CONTENT_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CONTENT_RESPONSE_CODE} but got {response.response.code}")
+
+            stats.append({})
+            for line in response.response.payload.decode().split("\n"):
+                name, value = line.split(": ")
+                stats[i][name] = int(value)
+
+        ticks = stats[1]["timerTicks"] - stats[0]["timerTicks"]
+        # Timer interrupts are added up over all cpu cores, every cpu core counts the same timer ticks
+        interrupts = stats[1]["timerInterrupts"] - stats[0]["timerInterrupts"]
+        cpu_cores = stats[1]["cpuCores"]
+        self.assertTrue(ticks >= 1500, f"Expected about 2000 timer ticks in 2 seconds but got {ticks}")
+        self.assertTrue(interrupts < cpu_cores*ticks/2, f"Expected less timer interrupts than timer ticks while idle but got {interrupts} interrupts for {ticks} ticks on {cpu_cores} cpu cores")
+
+
+    def test_task_stats_should_increase_while_task_is_running(self) -> None:
+        response = self.get_task_stats(1)
+        self.assertEqual(response.response.code, OSManagementTaskTests.NOT_FOUND_RESPONSE_CODE, f"Expected {OSManagementTaskTests.NOT_FOUND_RESPONSE_CODE} but got {response.response.code}")
+
+        self.create_new_task(1)
+        self.set_task_code("logint_1_task_no_yield", 1)
+        self.start_user_task(1)
+
+        all_stats = []
+        for i in range(2):
+            time.sleep(1)
+            response = self.get_task_stats(1)
+            self.assertEqual(response.response.code, OSManagementTaskTests.CONTENT_RESPONSE_CODE, f"Expected {OSManagementTaskTests.CONTENT_RESPONSE_CODE} but got {response.response.code}")
+
+            stats = {}
+            for line in response.response.payload.decode().split("\n"):
+                name, value = line.split(": ")
+                stats[name] = int(value)
+            all_stats.append(stats)
+
+        self.assertTrue(all_stats[0]["scheduled"] > 0, "Task should have been scheduled")
+        self.assertTrue(all_stats[1]["runtimeCycles"] > all_stats[0]["runtimeCycles"], "Runtime of a running task should increase")
+        # The task never yields itself, so it can only be preempted
+        self.assertTrue(all_stats[1]["involuntarySwitches"] > 0, "Task which never yields should have been preempted")
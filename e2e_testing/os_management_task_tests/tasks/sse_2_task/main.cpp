@@ -0,0 +1,20 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+void main(){
+    // Keep a value in an SSE register, other tasks using SSE should not be able to change it
+    unsigned int value = 2;
+    __asm__ __volatile__("movd %0, %%xmm0" : : "r"(value));
+
+    while(1){
+        yield();
+
+        unsigned int xmm0Value;
+        __asm__ __volatile__("movd %%xmm0, %0" : "=r"(xmm0Value));
+        if(xmm0Value==value){
+            e2eTestingLog(value);
+        }
+        else{
+            e2eTestingLog(99);
+        }
+    }
+}
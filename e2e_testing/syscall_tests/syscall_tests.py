@@ -327,6 +327,23 @@ class SyscallTests(VmTests):
         except TimeoutError as e:
             self.fail(f"Timeout while waiting for log entry")
     
+    def test_task_waiting_for_socket_event_should_be_woken_up_by_received_packet(self) -> None:
+        success = self.deploy_user_task("wait_for_socket_event_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        self.sock.sendto(b"hello world!", (self.os_ip_string, 1000))
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "299":
+                    break
+                elif logintValue == "309":
+                    self.fail("Task was not woken up correctly")
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+    
     def test_task_receives_fragmented_packet_should_arrive_correctly(self) -> None:
         success = self.deploy_user_task("receive_fragmented_packet_task", 1)
         if not success:
@@ -447,6 +464,81 @@ class SyscallTests(VmTests):
             end = time.perf_counter()
             self.assertTrue((end-begin) <= 20, "Waiting for log entry timed out after 20 seconds")
 
+    def test_task_sends_packet_to_itself_through_socket_rings_should_be_possible(self) -> None:
+        success = self.deploy_user_task("socket_rings_to_self_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "500":
+                    break
+                elif logintValue == "509":
+                    self.fail("Task did not get the correct completions from its socket rings")
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
+    def test_task_sends_batch_of_packets_to_itself_should_be_possible(self) -> None:
+        success = self.deploy_user_task("batch_send_receive_to_self_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "600":
+                    break
+                elif logintValue == "609":
+                    self.fail("Task did not send or receive the batch of packets correctly")
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
+    def test_task_reads_kernel_info_page_should_be_possible(self) -> None:
+        success = self.deploy_user_task("read_kernel_info_page_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "700":
+                    break
+                elif logintValue == "709":
+                    self.fail("Task did not read correct values from its kernel info page")
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
+    def test_task_waiting_on_futex_should_be_woken_up_by_send_and_receive(self) -> None:
+        success = self.deploy_user_task("futex_wait_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "800":
+                    break
+                elif logintValue == "809":
+                    self.fail("Task was not woken up correctly")
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
+    def test_task_waiting_on_multiple_sockets_should_be_woken_up_by_send_and_receive(self) -> None:
+        success = self.deploy_user_task("wait_sockets_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "900":
+                    break
+                elif logintValue == "909":
+                    self.fail("Task was not woken up correctly")
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
     def test_tasks_send_packets_to_eachother_should_be_possible(self) -> None:
         success = self.deploy_user_task("receive_fragmented_from_self_and_send_ack_task", 1)
         if not success:
@@ -528,6 +620,59 @@ class SyscallTests(VmTests):
         self.assertTrue(passed_time >= 10*(1-ALLOWABLE_ERROR), f"Task finished already after {passed_time} seconds")
         self.assertTrue(passed_time <= 10*(1+ALLOWABLE_ERROR), f"Task only finished after {passed_time} seconds")
     
+    def test_sleeping_10_seconds_should_be_approximately_correct(self) -> None:
+        ALLOWABLE_ERROR = 0.2
+
+        success = self.deploy_user_task("sleep_10s_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+        
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "1998":
+                    break
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+        
+        begin = time.perf_counter()
+
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "1999":
+                    break
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
+        end = time.perf_counter()
+        passed_time = end-begin
+
+        self.assertTrue(passed_time >= 10*(1-ALLOWABLE_ERROR), f"Task finished already after {passed_time} seconds")
+        self.assertTrue(passed_time <= 10*(1+ALLOWABLE_ERROR), f"Task only finished after {passed_time} seconds")
+    
+    def test_sysenter_syscalls_should_be_faster_than_interrupt_syscalls(self) -> None:
+        success = self.deploy_user_task("syscall_benchmark_task", 1)
+        if not success:
+            self.fail("Failed to deploy task")
+
+        logintValues = []
+        try:
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValue = line.split(" ")[1]
+                if logintValue == "3000":
+                    break
+            for line in self.vm.follow_logfile(marker="LogInt:"):
+                logintValues.append(int(line.split(" ")[1]))
+                if len(logintValues) == 2:
+                    break
+        except TimeoutError as e:
+            self.fail(f"Timeout while waiting for log entry")
+
+        interrupt_cycles, sysenter_cycles = logintValues
+        print(f"Cycles per syscall: {interrupt_cycles} with int, {sysenter_cycles} with sysenter")
+        self.assertTrue(sysenter_cycles < interrupt_cycles, f"Syscalls with sysenter took {sysenter_cycles} cycles while syscalls with int took {interrupt_cycles} cycles")
+
     def test_setting_receive_buffer_to_nullptr_should_succeed_if_size_also_zero(self) -> None:
         success = self.deploy_user_task("set_receive_buffer_to_nullptr_task", 1)
         if not success:
@@ -0,0 +1,103 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+// Obviously this won't work with TEST_CLIENT_IP=1, thus make sure to pass correct TEST_CLIENT_IP to compiler
+#ifndef MY_IP
+#define MY_IP 1
+#endif
+
+#define NUM_DATAGRAMS 3
+
+bool dataIsCorrect(unsigned char* buffer, const char* expectedData, unsigned int expectedSize){
+    for(unsigned int i=0; i<expectedSize; i++){
+        if(buffer[i] != expectedData[i]){
+            return false;
+        }
+    }
+    return true;
+}
+
+void main(){
+    int socket1ID = openSocket(1000);
+    int socket2ID = openSocket(2000);
+    int socket3ID = openSocket(3000);
+
+    if(socket1ID!=-1 && socket2ID!=-1 && socket3ID!=-1){
+        // Expected messages are "first", "second" on port 2000 and "third!" on port 3000
+        const char* messages[NUM_DATAGRAMS] = {"first", "second", "third!"};
+        unsigned int messageSizes[NUM_DATAGRAMS] = {5, 6, 6};
+        unsigned short destinationPorts[NUM_DATAGRAMS] = {2000, 2000, 3000};
+
+        unsigned char receiveBuffers[NUM_DATAGRAMS][100];
+        ReceiveBatchEntry receiveEntries[NUM_DATAGRAMS];
+        for(int i=0; i<NUM_DATAGRAMS; i++){
+            receiveEntries[i].socketID = (destinationPorts[i]==2000) ? socket2ID : socket3ID;
+            receiveEntries[i].buffer = receiveBuffers[i];
+            receiveEntries[i].bufferSize = 100;
+        }
+
+        // The first UDP_HEADER_SIZE bytes of a send buffer are reserved for the OS
+        unsigned char sendBuffers[NUM_DATAGRAMS][UDP_HEADER_SIZE+10];
+        SendBatchEntry sendEntries[NUM_DATAGRAMS];
+        for(int i=0; i<NUM_DATAGRAMS; i++){
+            for(unsigned int j=0; j<messageSizes[i]; j++){
+                sendBuffers[i][UDP_HEADER_SIZE+j] = messages[i][j];
+            }
+            sendEntries[i].socketID = socket1ID;
+            sendEntries[i].destinationPort = destinationPorts[i];
+            sendEntries[i].destinationIP = MY_IP;
+            sendEntries[i].buffer = sendBuffers[i];
+            sendEntries[i].bufferSize = UDP_HEADER_SIZE+messageSizes[i];
+        }
+
+        bool everythingCorrect = recvBatch(receiveEntries, NUM_DATAGRAMS)==NUM_DATAGRAMS;
+        everythingCorrect = everythingCorrect && sendBatch(sendEntries, NUM_DATAGRAMS)==NUM_DATAGRAMS;
+
+        bool allDone = false;
+        while(everythingCorrect && !allDone){
+            allDone = true;
+            for(int i=0; i<NUM_DATAGRAMS; i++){
+                if(sendEntries[i].status==BATCH_ENTRY_FAILED || receiveEntries[i].status==BATCH_ENTRY_FAILED){
+                    everythingCorrect = false;
+                }
+                if(sendEntries[i].status!=BATCH_ENTRY_DONE || receiveEntries[i].status!=BATCH_ENTRY_DONE){
+                    allDone = false;
+                }
+            }
+
+            if(!allDone){
+                yield();
+            }
+        }
+
+        // The datagrams for port 2000 should be received in the order they were sent
+        for(int i=0; i<NUM_DATAGRAMS && everythingCorrect; i++){
+            if(receiveEntries[i].receivedSize!=messageSizes[i] || receiveEntries[i].sourceIP!=MY_IP ||
+                receiveEntries[i].sourcePort!=1000 || !dataIsCorrect(receiveBuffers[i], messages[i], messageSizes[i])){
+                everythingCorrect = false;
+            }
+        }
+
+        if(everythingCorrect){
+            e2eTestingLog(600);
+        }
+        else{
+            e2eTestingLog(609);
+        }
+    }
+
+    if(socket1ID!=-1){
+        closeSocket(socket1ID);
+    }
+
+    if(socket2ID!=-1){
+        closeSocket(socket2ID);
+    }
+
+    if(socket3ID!=-1){
+        closeSocket(socket3ID);
+    }
+
+    while(1){
+        yield();
+    }
+}
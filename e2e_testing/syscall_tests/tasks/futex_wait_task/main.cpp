@@ -0,0 +1,106 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+// Obviously this won't work with TEST_CLIENT_IP=1, thus make sure to pass correct TEST_CLIENT_IP to compiler
+#ifndef MY_IP
+#define MY_IP 1
+#endif
+
+// Generous bound, the packet should arrive long before this
+#define TIMEOUT_MS 5000
+
+void main(){
+    bool everythingCorrect = true;
+
+    // Nothing wakes up a task waiting on this word, thus only the timeout can end the wait
+    int word = 0;
+    if(futexWait(&word, 1, 100)!=FUTEX_VALUE_CHANGED || futexWait(&word, 0, 100)!=FUTEX_TIMED_OUT){
+        everythingCorrect = false;
+    }
+    if(futexWait((int*)(((unsigned char*)&word)+1), 0, 100)!=-1){
+        everythingCorrect = false;
+    }
+
+    int socket1ID = openSocket(1000);
+    int socket2ID = openSocket(2000);
+
+    if(socket1ID!=-1 && socket2ID!=-1){
+        // The receive buffer is declared as words so that the header words are aligned for futexWait
+        int receiveBufferWords[(12+2*RECEIVE_BUFFER_HEADER_SIZE)/4];
+        unsigned char* receiveBuffer = (unsigned char*)receiveBufferWords;
+        for(int i=0; i<12+2*RECEIVE_BUFFER_HEADER_SIZE; i++){
+            receiveBuffer[i] = 0;
+        }
+        setReceiveBuffer(socket2ID, receiveBuffer, 12+2*RECEIVE_BUFFER_HEADER_SIZE);
+
+        unsigned char sendBuffer[100];
+        sendBuffer[0] = (unsigned char)(((unsigned int)MY_IP) & 0xFF);
+        sendBuffer[1] = (unsigned char)((((unsigned int)MY_IP) >> 8) & 0xFF);
+        sendBuffer[2] = (unsigned char)((((unsigned int)MY_IP) >> 16) & 0xFF);
+        sendBuffer[3] = (unsigned char)((((unsigned int)MY_IP) >> 24) & 0xFF);
+        unsigned short destinationPort = 2000;
+        sendBuffer[4] = destinationPort & 0xFF;
+        sendBuffer[5] = (destinationPort >> 8) & 0xFF;
+        // Message is "hello world!"
+        unsigned short udpLength = 12 + UDP_HEADER_SIZE;
+        sendBuffer[6] = udpLength & 0xFF;
+        sendBuffer[7] = (udpLength >> 8) & 0xFF;
+        for(int i=0; i<UDP_HEADER_SIZE; i++){
+            sendBuffer[8+i] = 0;
+        }
+        for(int i=0; i<12; i++){
+            sendBuffer[8+UDP_HEADER_SIZE+i] = "hello world!"[i];
+        }
+        for(int i=0; i<SEND_BUFFER_HEADER_SIZE; i++){
+            sendBuffer[SEND_BUFFER_HEADER_SIZE + i] = 0;
+        }
+
+        int indicatorWhenFinished = 0;
+
+        if(setSendBuffer(socket1ID, sendBuffer, udpLength + 2*SEND_BUFFER_HEADER_SIZE, &indicatorWhenFinished)==-1){
+            everythingCorrect = false;
+        }
+
+        // No polling here, the task should only be woken up once the buffer is sent
+        while(everythingCorrect && indicatorWhenFinished==0){
+            if(futexWait(&indicatorWhenFinished, 0, TIMEOUT_MS)==FUTEX_TIMED_OUT){
+                everythingCorrect = false;
+            }
+        }
+
+        // The second word of the header contains the source port and the packet size
+        volatile int* pHeaderWord = &receiveBufferWords[1];
+        while(everythingCorrect && *pHeaderWord==0){
+            if(futexWait(pHeaderWord, 0, TIMEOUT_MS)==FUTEX_TIMED_OUT){
+                everythingCorrect = false;
+            }
+        }
+
+        unsigned short sourcePort = (((unsigned short)receiveBuffer[5]) << 8) + ((unsigned short)receiveBuffer[4]);
+        unsigned short packetSize = (((unsigned int)receiveBuffer[7]) << 8) + ((unsigned int)receiveBuffer[6]);
+        if(sourcePort!=1000 || packetSize!=12){
+            everythingCorrect = false;
+        }
+    }
+    else{
+        everythingCorrect = false;
+    }
+
+    if(everythingCorrect){
+        e2eTestingLog(800);
+    }
+    else{
+        e2eTestingLog(809);
+    }
+
+    if(socket1ID!=-1){
+        closeSocket(socket1ID);
+    }
+
+    if(socket2ID!=-1){
+        closeSocket(socket2ID);
+    }
+
+    while(1){
+        yield();
+    }
+}
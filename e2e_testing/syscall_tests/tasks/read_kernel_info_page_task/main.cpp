@@ -0,0 +1,45 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+// Generous bounds for a 500ms sleep, the VM might not run at a steady pace
+#define MIN_SLEEP_NS 250000000ULL
+#define MAX_SLEEP_NS 5000000000ULL
+
+void main(){
+    KernelInfoPage info;
+    readKernelInfoPage(&info);
+
+    bool everythingCorrect = (info.sequence & 1)==0 && info.timestampCounterToNsMultiplier!=0;
+
+    unsigned long long timestampBefore = getTimestampNs();
+    sleepFor(500);
+    unsigned long long timestampAfter = getTimestampNs();
+
+    if(timestampAfter < timestampBefore+MIN_SLEEP_NS || timestampAfter > timestampBefore+MAX_SLEEP_NS){
+        everythingCorrect = false;
+    }
+
+    // The page is updated at every timer tick (cpu cores count their timer ticks separately, so allow a small 
+    // difference in case the task was moved to another cpu core in between)
+    unsigned int timerTicks = getTimerTicks();
+    readKernelInfoPage(&info);
+    if(info.timerTicks+10 < timerTicks || info.timerTicks > timerTicks+10){
+        everythingCorrect = false;
+    }
+
+    KernelInfoPage info2;
+    readKernelInfoPage(&info2);
+    if(info2.taskID!=info.taskID || info2.timestampCounter < info.timestampCounter){
+        everythingCorrect = false;
+    }
+
+    if(everythingCorrect){
+        e2eTestingLog(700);
+    }
+    else{
+        e2eTestingLog(709);
+    }
+
+    while(1){
+        yield();
+    }
+}
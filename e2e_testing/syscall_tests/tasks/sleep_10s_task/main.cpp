@@ -0,0 +1,13 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+void main(){
+    e2eTestingLog(1998);
+
+    sleepFor(10*1000);
+
+    e2eTestingLog(1999);
+
+    while(true){
+        yield();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+// Obviously this won't work with TEST_CLIENT_IP=1, thus make sure to pass correct TEST_CLIENT_IP to compiler
+#ifndef MY_IP
+#define MY_IP 1
+#endif
+
+#define SEND_BUFFER_OFFSET 0
+#define RECEIVE_BUFFER_OFFSET 100
+
+void main(){
+    int socket1ID = openSocket(1000);
+    int socket2ID = openSocket(2000);
+
+    SocketRings rings;
+    unsigned char bufferArea[200];
+
+    if(socket1ID!=-1 && socket2ID!=-1 && setupSocketRings(&rings, bufferArea, 200)!=-1){
+        // Expected message is "hello world!"
+        SocketRingSubmission receiveSubmission;
+        receiveSubmission.userData = 1;
+        receiveSubmission.opcode = SOCKET_RING_RECEIVE;
+        receiveSubmission.socketID = socket2ID;
+        receiveSubmission.destinationPort = 0;
+        receiveSubmission.destinationIP = 0;
+        receiveSubmission.bufferOffset = RECEIVE_BUFFER_OFFSET;
+        receiveSubmission.bufferSize = 100;
+
+        // The first UDP_HEADER_SIZE bytes of a send buffer are reserved for the OS
+        for(int i=0; i<12; i++){
+            bufferArea[SEND_BUFFER_OFFSET+UDP_HEADER_SIZE+i] = "hello world!"[i];
+        }
+        SocketRingSubmission sendSubmission;
+        sendSubmission.userData = 2;
+        sendSubmission.opcode = SOCKET_RING_SEND;
+        sendSubmission.socketID = socket1ID;
+        sendSubmission.destinationPort = 2000;
+        sendSubmission.destinationIP = MY_IP;
+        sendSubmission.bufferOffset = SEND_BUFFER_OFFSET;
+        sendSubmission.bufferSize = UDP_HEADER_SIZE+12;
+
+        bool everythingCorrect = postSocketRingSubmission(&rings, &receiveSubmission);
+        everythingCorrect = everythingCorrect && postSocketRingSubmission(&rings, &sendSubmission);
+
+        bool receiveCompleted = false;
+        bool sendCompleted = false;
+        while(everythingCorrect && (!receiveCompleted || !sendCompleted)){
+            SocketRingCompletion completion;
+            if(!takeSocketRingCompletion(&rings, &completion)){
+                yield();
+                continue;
+            }
+
+            if(completion.userData==1 && !receiveCompleted){
+                receiveCompleted = true;
+                if(completion.result!=12 || completion.sourceIP!=MY_IP || completion.sourcePort!=1000){
+                    everythingCorrect = false;
+                }
+                for(int i=0; i<12; i++){
+                    if(bufferArea[RECEIVE_BUFFER_OFFSET+i] != "hello world!"[i]){
+                        everythingCorrect = false;
+                        break;
+                    }
+                }
+            }
+            else if(completion.userData==2 && !sendCompleted){
+                sendCompleted = true;
+                if(completion.result!=12){
+                    everythingCorrect = false;
+                }
+            }
+            else{
+                everythingCorrect = false;
+            }
+        }
+
+        if(everythingCorrect){
+            e2eTestingLog(500);
+        }
+        else{
+            e2eTestingLog(509);
+        }
+    }
+
+    if(socket1ID!=-1){
+        closeSocket(socket1ID);
+    }
+
+    if(socket2ID!=-1){
+        closeSocket(socket2ID);
+    }
+
+    while(1){
+        yield();
+    }
+}
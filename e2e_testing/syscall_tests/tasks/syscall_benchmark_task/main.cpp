@@ -0,0 +1,60 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+#define NUM_ROUNDS 20
+#define NUM_CALLS_PER_ROUND 1000
+
+// Same layout as GetTimerCounterSyscallArgs
+struct TimerArgs{
+    unsigned int timerCounter;
+    unsigned int timerTicks;
+};
+
+static inline unsigned int readTimestampCounterLow(){
+    unsigned int low;
+    unsigned int high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return low;
+}
+
+// getTimerTicks through the syscall interrupt, which is what getTimerTicks used before sysenter
+static inline unsigned int getTimerTicksWithInterrupt(){
+    TimerArgs args;
+    unsigned int eax = (unsigned int)&args;
+    __asm__ __volatile__("int $55" : "+a"(eax) : : "memory");
+    return args.timerTicks;
+}
+
+void main(){
+    // The fastest round is used, rounds interrupted by the timer or by other tasks would only add noise
+    unsigned int minInterruptCycles = 0xFFFFFFFF;
+    unsigned int minSysenterCycles = 0xFFFFFFFF;
+
+    for(int round=0; round<NUM_ROUNDS; round++){
+        unsigned int begin = readTimestampCounterLow();
+        for(int i=0; i<NUM_CALLS_PER_ROUND; i++){
+            getTimerTicksWithInterrupt();
+        }
+        unsigned int cycles = (readTimestampCounterLow()-begin)/NUM_CALLS_PER_ROUND;
+        if(cycles<minInterruptCycles){
+            minInterruptCycles = cycles;
+        }
+
+        begin = readTimestampCounterLow();
+        for(int i=0; i<NUM_CALLS_PER_ROUND; i++){
+            getTimerTicks();
+        }
+        cycles = (readTimestampCounterLow()-begin)/NUM_CALLS_PER_ROUND;
+        if(cycles<minSysenterCycles){
+            minSysenterCycles = cycles;
+        }
+    }
+
+    // Cycles per syscall with the interrupt and with sysenter
+    e2eTestingLog(3000);
+    e2eTestingLog(minInterruptCycles);
+    e2eTestingLog(minSysenterCycles);
+
+    while(1){
+        yield();
+    }
+}
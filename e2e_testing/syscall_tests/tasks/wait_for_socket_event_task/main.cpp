@@ -0,0 +1,31 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+void main(){
+    int socketID = openSocket(1000);
+
+    if(socketID != -1){
+        unsigned char receiveBuffer[12+2*RECEIVE_BUFFER_HEADER_SIZE];
+        setReceiveBuffer(socketID, receiveBuffer, 12+2*RECEIVE_BUFFER_HEADER_SIZE);
+
+        // Waiting on a socket which isn't open should fail immediately
+        if(waitForSocketEvent(socketID+1) != -1){
+            e2eTestingLog(309);
+        }
+
+        // No polling here, the task should only be woken up once the packet has arrived
+        int success = waitForSocketEvent(socketID);
+
+        if(success==0 && (receiveBuffer[6]!=0 || receiveBuffer[7]!=0)){
+            e2eTestingLog(299);
+        }
+        else{
+            e2eTestingLog(309);
+        }
+
+        closeSocket(socketID);
+    }
+
+    while(1){
+        yield();
+    }
+}
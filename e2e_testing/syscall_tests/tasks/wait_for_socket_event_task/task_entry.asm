@@ -0,0 +1,6 @@
+[bits 32]
+[extern main]
+
+MainEntry:
+    call main
+    ret
\ No newline at end of file
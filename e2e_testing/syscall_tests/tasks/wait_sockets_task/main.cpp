@@ -0,0 +1,100 @@
+#include "../../../../cpp_lib/syscalls.h"
+
+// Obviously this won't work with TEST_CLIENT_IP=1, thus make sure to pass correct TEST_CLIENT_IP to compiler
+#ifndef MY_IP
+#define MY_IP 1
+#endif
+
+// Generous bound, the packet should arrive long before this
+#define TIMEOUT_MS 5000
+
+void main(){
+    int socket1ID = openSocket(1000);
+    int socket2ID = openSocket(2000);
+    int socket3ID = openSocket(3000);
+
+    if(socket1ID!=-1 && socket2ID!=-1 && socket3ID!=-1){
+        bool everythingCorrect = true;
+
+        unsigned int socket1Bit = 1 << socket1ID;
+        unsigned int socket2Bit = 1 << socket2ID;
+        unsigned int socket3Bit = 1 << socket3ID;
+
+        // Nothing happened on the sockets yet, thus only the timeout can end the wait
+        if(waitSockets(0, 100)!=-1 || waitSockets(socket2Bit | socket3Bit, 100)!=0){
+            everythingCorrect = false;
+        }
+
+        unsigned char receiveBuffer2[12+2*RECEIVE_BUFFER_HEADER_SIZE];
+        unsigned char receiveBuffer3[12+2*RECEIVE_BUFFER_HEADER_SIZE];
+        setReceiveBuffer(socket2ID, receiveBuffer2, 12+2*RECEIVE_BUFFER_HEADER_SIZE);
+        setReceiveBuffer(socket3ID, receiveBuffer3, 12+2*RECEIVE_BUFFER_HEADER_SIZE);
+
+        unsigned char sendBuffer[100];
+        sendBuffer[0] = (unsigned char)(((unsigned int)MY_IP) & 0xFF);
+        sendBuffer[1] = (unsigned char)((((unsigned int)MY_IP) >> 8) & 0xFF);
+        sendBuffer[2] = (unsigned char)((((unsigned int)MY_IP) >> 16) & 0xFF);
+        sendBuffer[3] = (unsigned char)((((unsigned int)MY_IP) >> 24) & 0xFF);
+        unsigned short destinationPort = 3000;
+        sendBuffer[4] = destinationPort & 0xFF;
+        sendBuffer[5] = (destinationPort >> 8) & 0xFF;
+        // Message is "hello world!"
+        unsigned short udpLength = 12 + UDP_HEADER_SIZE;
+        sendBuffer[6] = udpLength & 0xFF;
+        sendBuffer[7] = (udpLength >> 8) & 0xFF;
+        for(int i=0; i<UDP_HEADER_SIZE; i++){
+            sendBuffer[8+i] = 0;
+        }
+        for(int i=0; i<12; i++){
+            sendBuffer[8+UDP_HEADER_SIZE+i] = "hello world!"[i];
+        }
+        for(int i=0; i<SEND_BUFFER_HEADER_SIZE; i++){
+            sendBuffer[SEND_BUFFER_HEADER_SIZE + i] = 0;
+        }
+
+        int indicatorWhenFinished = 0;
+
+        if(setSendBuffer(socket1ID, sendBuffer, udpLength + 2*SEND_BUFFER_HEADER_SIZE, &indicatorWhenFinished)==-1){
+            everythingCorrect = false;
+        }
+
+        // No polling here, socket 1 should become ready once the buffer is sent and socket 3 once the packet arrived
+        unsigned int readySockets = 0;
+        while(everythingCorrect && (readySockets & (socket1Bit | socket3Bit))!=(socket1Bit | socket3Bit)){
+            int result = waitSockets(socket1Bit | socket2Bit | socket3Bit, TIMEOUT_MS);
+            if(result<=0){
+                everythingCorrect = false;
+            }
+            else{
+                readySockets |= (unsigned int)result;
+            }
+        }
+
+        if((readySockets & socket2Bit)!=0 || indicatorWhenFinished!=1 || (receiveBuffer3[6]==0 && receiveBuffer3[7]==0)){
+            everythingCorrect = false;
+        }
+
+        if(everythingCorrect){
+            e2eTestingLog(900);
+        }
+        else{
+            e2eTestingLog(909);
+        }
+    }
+
+    if(socket1ID!=-1){
+        closeSocket(socket1ID);
+    }
+
+    if(socket2ID!=-1){
+        closeSocket(socket2ID);
+    }
+
+    if(socket3ID!=-1){
+        closeSocket(socket3ID);
+    }
+
+    while(1){
+        yield();
+    }
+}
@@ -60,7 +60,8 @@ void main(){
                 setReceiveBuffer(socketID, receiveBuffer, 1000);
             }
 
-            yield();
+            // Block until a new packet arrives
+            waitForSocketEvent(socketID);
         }
     }
     else{
@@ -70,8 +70,9 @@ void main(){
             print((char*)"Sending packets...\n");
             // Wait till indicatorWhenFinished is set to 1, indicating
             // that all packets have been sent over the physical network interface
+            // waitForSocketEvent blocks the task until this happens, instead of wasting timeslices
             while(indicatorWhenFinished==0){
-                yield();
+                waitForSocketEvent(socketID);
             }
             print((char*)"Packets successfully sent!\n");
         }
@@ -0,0 +1,63 @@
+global ap_trampoline_start
+global ap_trampoline_params
+global ap_trampoline_end
+
+; Application processors start in real mode at the page given by the startup IPI, thus this code is copied to
+; AP_TRAMPOLINE_ADDR (see cpu_core.h) by the bootstrap processor, the addresses below are relative to that copy
+AP_TRAMPOLINE_ADDR equ 0x20000
+%define TRAMPOLINE_OFFSET(label) ((label)-ap_trampoline_start)
+%define TRAMPOLINE_ADDR(label) (AP_TRAMPOLINE_ADDR+TRAMPOLINE_OFFSET(label))
+
+[bits 16]
+
+ap_trampoline_start:
+    cli
+    cld
+    mov ax, cs
+    mov ds, ax
+
+    ; Use the gdt of the bootstrap processor until the CpuCore of this processor loads its own copy
+    ; (o32 because otherwise only 24 bits of the gdt base address are loaded)
+    o32 lgdt [TRAMPOLINE_OFFSET(ApGdtDescriptor)]
+
+    mov eax, cr0
+    or eax, 0x1
+    mov cr0, eax
+    jmp dword 0x08:TRAMPOLINE_ADDR(ApInitPm)
+
+[bits 32]
+
+ApInitPm:
+    mov ax, (2 * 8)     ; GdtKernelData
+    mov ds, ax
+    mov ss, ax
+    mov es, ax
+    mov fs, ax
+    mov gs, ax
+
+    mov esp, [TRAMPOLINE_ADDR(ApStack)]
+    mov ebp, esp
+
+    ; void entry(), should never return
+    mov eax, [TRAMPOLINE_ADDR(ApEntry)]
+    call eax
+
+ApHalt:
+    cli
+    hlt
+    jmp ApHalt
+
+align 4
+
+; Filled in by the bootstrap processor before every startup IPI, has the layout of ApTrampolineParams (see cpu_core.h)
+ap_trampoline_params:
+ApGdtDescriptor:
+    dw 0                ; gdt limit
+    dd 0                ; gdt base
+    dw 0                ; padding
+ApStack:
+    dd 0
+ApEntry:
+    dd 0
+
+ap_trampoline_end:
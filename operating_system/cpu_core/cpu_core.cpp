@@ -7,11 +7,43 @@
 #include "../../cpp_lib/syscalls.h"
 #include "../network_management_task/socket_manager.h"
 #include "../../cpp_lib/callback.h"
+#include "timestamp_counter.h"
+#include "../global_resources/acpi_tables.h"
 
 // This assembly code will call the yieldTaskSwitch function
 extern "C" void yieldTaskSwitchIntHandler(unsigned int interruptParam, unsigned int eax);
 
+extern "C" void getCpuidFeatureFlags(unsigned int* returnValue);
+extern "C" void enableFpu();
+extern "C" void setTaskSwitchedFlag();
+extern "C" void clearTaskSwitchedFlag();
+extern "C" void initFpuState();
+extern "C" void saveFpuState(unsigned char* pFpuState);
+extern "C" void restoreFpuState(unsigned char* pFpuState);
+extern "C" void getCr2(unsigned int* returnValue);
+
+extern "C" unsigned char ap_trampoline_start;
+extern "C" unsigned char ap_trampoline_params;
+extern "C" unsigned char ap_trampoline_end;
+
+// Code executed by the idle task, simply wait for the next interrupt without using the cpu
+void idleTaskCode(){
+    while(1){
+        __asm__ __volatile__("sti; hlt" ::: "memory");
+    }
+}
+
 void genericExceptionHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    InterruptFrame* pInterruptFrame = GET_INTERRUPT_FRAME();
+
+    // NMIs and machine checks are not caused by the current task
+    if(pInterruptFrame->interruptNumber!=(unsigned int)InterruptType::NMI && 
+        pInterruptFrame->interruptNumber!=(unsigned int)InterruptType::MachineCheck)
+    {
+        pCpuCore->crashCurrentTask(pInterruptFrame->interruptNumber, 0, pInterruptFrame->eip);
+    }
+
     yield();
 }
 
@@ -24,7 +56,11 @@ void generalProtectionFaultExceptionHandler(unsigned int interruptParam, unsigne
     Screen* pScreen = Screen::getScreen();
     pScreen->printk((char*)"General Protection Fault interrupt was called\n");
 
-    genericExceptionHandler(interruptParam, eax);
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    InterruptFrame* pInterruptFrame = GET_INTERRUPT_FRAME();
+    pCpuCore->crashCurrentTask((unsigned int)InterruptType::GeneralProtectionFault, 0, pInterruptFrame->eip);
+
+    yield();
 }
 
 void pageFaultExceptionHandler(unsigned int interruptParam, unsigned int eax){
@@ -35,26 +71,102 @@ void pageFaultExceptionHandler(unsigned int interruptParam, unsigned int eax){
 
     Screen* pScreen = Screen::getScreen();
     pScreen->printk((char*)"Page Fault interrupt was called\n");
+
+    unsigned int faultAddress;
+    getCr2(&faultAddress);
+
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    InterruptFrame* pInterruptFrame = GET_INTERRUPT_FRAME();
+    pCpuCore->crashCurrentTask((unsigned int)InterruptType::PageFault, faultAddress, pInterruptFrame->eip);
     
-    genericExceptionHandler(interruptParam, eax);
+    yield();
+}
+
+void coprocessorNotAvailableExceptionHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    DoublyLinkedListElement<TaskDescriptor>* currentTask = pCpuCore->currentTask;
+
+    // The current task uses the FPU for the first time since it was scheduled, swap the FPU state of the previous
+    // owner with the FPU state of the current task
+    clearTaskSwitchedFlag();
+    pCpuCore->taskSwitchedFlagSet = false;
+
+    // Another cpu core which stops the previous owner resets fpuOwner before freeing its descriptor
+    pCpuCore->runQueueLock.lock();
+
+    if(pCpuCore->fpuOwner!=currentTask){
+        if(pCpuCore->fpuOwner!=nullptr){
+            saveFpuState(pCpuCore->fpuOwner->value.fpuState);
+            pCpuCore->fpuOwner->value.fpuStateValid = true;
+        }
+
+        if(currentTask!=nullptr && currentTask->value.fpuStateValid){
+            restoreFpuState(currentTask->value.fpuState);
+        }
+        else{
+            restoreFpuState(pCpuCore->initialFpuState);
+        }
+
+        pCpuCore->fpuOwner = currentTask;
+    }
+
+    pCpuCore->runQueueLock.unlock();
 }
 
 extern "C" void yieldTaskSwitch(unsigned int interruptParam, unsigned int* pEsp){
     CpuCore* pCpuCore = (CpuCore*)interruptParam;
 
-    if(pCpuCore->taskSwitchingPaused || pCpuCore->activeTasksListHead == nullptr){
+    bool currentTaskWasPreempted = pCpuCore->preemptionRequested;
+    pCpuCore->preemptionRequested = false;
+
+    if(pCpuCore->taskSwitchingPaused){
         return;
     }
 
+    // Other cpu cores might be adding tasks to the run queues of this cpu core or stealing tasks from them, the lock is 
+    // held until the state of the current task is saved so that a cpu core which steals it resumes it correctly (this 
+    // runs on the task switch stack of this cpu core, so the stack of the current task isn't used anymore after that)
+    pCpuCore->runQueueLock.lock();
+
+    bool rescheduleWasRequested = pCpuCore->rescheduleRequested;
+    pCpuCore->rescheduleRequested = false;
+
+    unsigned long long taskSwitchBeginTimestamp = readTimestampCounter();
+
     DoublyLinkedListElement<TaskDescriptor>* currentTask = pCpuCore->currentTask;
-    DoublyLinkedListElement<TaskDescriptor>* nextTask = (currentTask==nullptr || currentTask->next==nullptr) ? pCpuCore->activeTasksListHead : currentTask->next;
+    DoublyLinkedListElement<TaskDescriptor>* nextTask = pCpuCore->pickNextTask(currentTaskWasPreempted);
+    pCpuCore->remainingQuantumTicks = nextTask->value.quantum;
+    pCpuCore->startTicklessModeIfPossible(nextTask);
 
     if(currentTask == nextTask){
+        pCpuCore->runQueueLock.unlock();
         return;
     }
 
+    if(currentTask!=nullptr && currentTask!=&pCpuCore->idleTask){
+        if(currentTaskWasPreempted){
+            currentTask->value.statistics.numInvoluntarySwitches++;
+        }
+        else{
+            currentTask->value.statistics.numVoluntarySwitches++;
+        }
+    }
+    nextTask->value.statistics.numTimesScheduled++;
+
     pCpuCore->currentTask = nextTask;
 
+    // Only if the next task uses the FPU, its FPU state will be loaded (by coprocessorNotAvailableExceptionHandler)
+    if(nextTask==pCpuCore->fpuOwner){
+        if(pCpuCore->taskSwitchedFlagSet){
+            clearTaskSwitchedFlag();
+            pCpuCore->taskSwitchedFlagSet = false;
+        }
+    }
+    else if(!pCpuCore->taskSwitchedFlagSet){
+        setTaskSwitchedFlag();
+        pCpuCore->taskSwitchedFlagSet = true;
+    }
+
     if(currentTask != nullptr){
         currentTask->value.taskEsp = *pEsp;
     }
@@ -63,13 +175,31 @@ extern "C" void yieldTaskSwitch(unsigned int interruptParam, unsigned int* pEsp)
     pCpuCore->tss.setEsp0(nextTask->value.kernelEspStackBegin);
 
     unsigned int newPageDirectoryPhysicalAddr = nextTask->value.pageDirectoryPhysicalAddr;
+    unsigned int oldPageDirectoryPhysicalAddr = pCpuCore->currentPagingStructure.swapPageDirectory(newPageDirectoryPhysicalAddr);
 
     if(currentTask != nullptr){
-        currentTask->value.pageDirectoryPhysicalAddr = pCpuCore->currentPagingStructure.swapPageDirectory(newPageDirectoryPhysicalAddr);
+        currentTask->value.pageDirectoryPhysicalAddr = oldPageDirectoryPhysicalAddr;
     }
-    else{
-        pCpuCore->currentPagingStructure.swapPageDirectory(newPageDirectoryPhysicalAddr);
+
+    // The kernel info page is written through the mapping of the next task, thus only once its page directory is loaded
+    pCpuCore->updateKernelInfoPage(nextTask);
+
+    // Keep track of the cost of task switches
+    TaskSwitchStatistics* pStatistics = &pCpuCore->taskSwitchStatistics;
+    pStatistics->numTaskSwitches++;
+    if(currentTaskWasPreempted && rescheduleWasRequested){
+        pStatistics->numWakeUpPreemptions++;
+    }
+    if(newPageDirectoryPhysicalAddr!=oldPageDirectoryPhysicalAddr){
+        pStatistics->numPageDirectoryReloads++;
+    }
+    unsigned long long taskSwitchCycles = readTimestampCounter()-taskSwitchBeginTimestamp;
+    if(taskSwitchCycles>0xFFFFFFFF){
+        taskSwitchCycles = 0xFFFFFFFF;
     }
+    pStatistics->averageTaskSwitchCycles = pStatistics->averageTaskSwitchCycles - (pStatistics->averageTaskSwitchCycles >> 4) + (((unsigned int)taskSwitchCycles) >> 4);
+
+    pCpuCore->runQueueLock.unlock();
 }
 
 void openSocketSyscallHandler(unsigned int interruptParam, unsigned int eax){
@@ -87,7 +217,7 @@ void openSocketSyscallHandler(unsigned int interruptParam, unsigned int eax){
     SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
     // It is impossible that taskID should be -1 here since the task is running
-    unsigned char taskId = pTask->getTaskID();
+    unsigned short taskId = pTask->getTaskID();
     pOpenSocketSyscallArgs->socketID = pSocketManager->openSocket(taskId, pOpenSocketSyscallArgs->udpPort);
 }
 
@@ -107,7 +237,7 @@ void setReceiveBufferSyscallHandler(unsigned int interruptParam, unsigned int ea
     SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
     // It is impossible that taskID should be -1 here since the task is running
-    unsigned char taskId = (unsigned char)pTask->getTaskID();
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
 
     // Now there is an important little detail about pSetReceiveBufferSyscallArgs->buffer:
     //
@@ -163,7 +293,7 @@ void setSendBufferSyscallHandler(unsigned int interruptParam, unsigned int eax){
     SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
     // It is impossible that taskID should be -1 here since the task is running
-    unsigned char taskId = (unsigned char)pTask->getTaskID();
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
 
     // Now there is an important little detail about pSetSendBufferSyscallArgs->buffer:
     //
@@ -205,6 +335,10 @@ void setSendBufferSyscallHandler(unsigned int interruptParam, unsigned int eax){
             taskId, pSetSendBufferSyscallArgs->socketID, (unsigned char*)convertedAddrBlock.second, 
             pSetSendBufferSyscallArgs->bufferSize, (int*)convertedAddrBlock2.second);
     }
+
+    // Setting a send buffer wakes up the network management task which has a higher priority than user tasks (if it 
+    // runs on another cpu core, that cpu core got a reschedule IPI instead)
+    pCpuCore->rescheduleIfRequested();
 }
 
 void closeSocketSyscallHandler(unsigned int interruptParam, unsigned int eax){
@@ -223,7 +357,7 @@ void closeSocketSyscallHandler(unsigned int interruptParam, unsigned int eax){
     SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
     // It is impossible that taskID should be -1 here since the task is running
-    unsigned char taskId = (unsigned char)pCpuCore->getCurrentTask()->getTaskID();
+    unsigned short taskId = (unsigned short)pCpuCore->getCurrentTask()->getTaskID();
     pSocketManager->closeSocket(taskId, pCloseSocketSyscallArgs->socketID);
 }
 
@@ -271,207 +405,2115 @@ void getTimerCounterSyscallHandler(unsigned int interruptParam, unsigned int eax
         }
     }
 
-    pGetTimerCounterSyscallArgs->timerCounter = pCpuCore->timerCounter;
-}
+    pCpuCore->stopTicklessMode();
 
-#if E2E_TESTING
-void debugLogInterruptHandler(unsigned int interruptParam, unsigned int eax){
-    SerialLog* pSerialLog = SerialLog::getSerialLog();
-    pSerialLog->log((char*)"LogInt: ");
-    pSerialLog->log(eax);
-    pSerialLog->log((char*)"\n");
+    pGetTimerCounterSyscallArgs->timerCounter = pCpuCore->timerCounter;
+    pGetTimerCounterSyscallArgs->timerTicks = pCpuCore->timerTicks;
 }
-#endif
 
-CpuCore* CpuCore::cpuCorePointers[1];
+void sleepSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
 
-unsigned int CpuCore::getThisCpuCoreId(){
-    // Since we are only working with a single core at the moment, this will suffice
-    // CPUID instruction will need to be used when working in multi-core environment
-    return 0;
-}
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(SleepSyscallArgs))){
+            return;
+        }
+    }
 
-CpuCore::CpuCore(SocketManager* pSocketManager, unsigned int kernelPageDirectoryPhysicalAddr, PageAllocator* pKernelPageAlloctor)
-    :
-    tss((unsigned int)MAIN_KERNEL_STACK),
-    interruptHandlerManager(),
-    currentPagingStructure(kernelPageDirectoryPhysicalAddr),
-    isRunning(false),
-    timerCounter(0),
-    unusedtaskDescriptorElementsListHead(nullptr),
-    activeTasksListHead(nullptr),
-    currentTask(nullptr),
-    taskSwitchingPaused(false),
-    pSocketManager(pSocketManager),
-    kernelPageDirectoryPhysicalAddr(kernelPageDirectoryPhysicalAddr),
-    pKernelPageAlloctor(pKernelPageAlloctor),
-    timer(TASK_SWITCHING_FREQUENCY),
-    timerCallback(this)
-{
-    #if E2E_TESTING
-    SerialLog* pSerialLog = SerialLog::getSerialLog();
-    pSerialLog->log((char*)"CpuCore: constructor\n");
-    #endif
+    SleepSyscallArgs* pSleepSyscallArgs = (SleepSyscallArgs*)eax;
 
-    if((unsigned int)this != (unsigned int)taskSwitchStack){
-        Screen* pScreen = Screen::getScreen();
-        pScreen->printk((char*)"It is assumed the compiler should place CpuCore and CpuCore::taskSwitchStack at the same address but this isn't the case! OS won't start...\n");
-        while(true);
-    }
+    pCpuCore->stopTicklessMode();
 
-    for(unsigned int i=0; i<NUM_POSSIBLE_TASKS; i++){
-        if(i==NUM_POSSIBLE_TASKS-1){
-            taskDescriptorListElements[i].next = nullptr;
-        }
-        else{
-            taskDescriptorListElements[i].next = &taskDescriptorListElements[i+1];
-        }
+    unsigned int wakeUpTick;
+    if(pSleepSyscallArgs->isDeadline==1){
+        wakeUpTick = pSleepSyscallArgs->timerTicks;
     }
-    unusedtaskDescriptorElementsListHead = &taskDescriptorListElements[0];
-    
-    // Setup some interrupt handlers specific for this cpu core meaning:
-    // - Exceptions
-    // - Default PIC interrupt handlers
-    // - Syscalls
-    for(unsigned int intType=(unsigned int)InterruptType::DivideByZero; 
-        intType<=(unsigned int)InterruptType::ReservedException8;
-        intType++)
-    {
-        if(intType!=(unsigned int)InterruptType::GeneralProtectionFault && intType!=(unsigned int)InterruptType::PageFault){
-            interruptHandlerManager.setInterruptHandlerParam((InterruptType)intType, (unsigned int)this);
-            interruptHandlerManager.setInterruptHandler((InterruptType)intType, genericExceptionHandler);
+    else{
+        // Deadlines are compared with wrap around, so longer sleeps would be seen as deadlines in the past
+        unsigned int numTicks = pSleepSyscallArgs->timerTicks;
+        if(numTicks > 0x7FFFFFFF){
+            numTicks = 0x7FFFFFFF;
         }
+        wakeUpTick = pCpuCore->timerTicks+numTicks;
     }
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::GeneralProtectionFault, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::GeneralProtectionFault, generalProtectionFaultExceptionHandler);
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::PageFault, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::PageFault, pageFaultExceptionHandler);
+    // Interrupts are disabled during the syscall, so the timer wheel can't be changed concurrently
+    pCpuCore->sleepUntil(wakeUpTick);
+}
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int49, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int49, yieldTaskSwitchIntHandler);
+void waitForSocketEventSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int50, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int50, openSocketSyscallHandler);
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(WaitForSocketEventSyscallArgs))){
+            return;
+        }
+    }
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int51, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int51, setReceiveBufferSyscallHandler);
+    WaitForSocketEventSyscallArgs* pWaitForSocketEventSyscallArgs = (WaitForSocketEventSyscallArgs*)eax;
+    SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int52, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int52, setSendBufferSyscallHandler);
-    
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int53, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int53, closeSocketSyscallHandler);
+    // It is impossible that taskID should be -1 here since the task is running
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
+    unsigned char socketID = pWaitForSocketEventSyscallArgs->socketID;
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int54, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int54, printToScreenSyscallHandler);
+    TicketLock* pSocketLock = pSocketManager->getSocketLock(taskId, socketID);
+    if(pSocketLock==nullptr){
+        pWaitForSocketEventSyscallArgs->success = -1;
+        return;
+    }
 
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int55, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int55, getTimerCounterSyscallHandler);
+    // Events are only notified while holding the lock of the socket, which waitOn only releases once the task is in 
+    // the wait queue, so no event can be missed between checking for an event and blocking the task
+    pSocketLock->lock();
+    int eventState = pSocketManager->consumeSocketEvent(taskId, socketID);
+    while(eventState==0){
+        pCpuCore->waitOn(pSocketManager->getSocketWaitQueue(taskId, socketID), pSocketLock);
+        eventState = pSocketManager->consumeSocketEvent(taskId, socketID);
+    }
+    pSocketLock->unlock();
 
-    #if E2E_TESTING
-    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int48, (unsigned int)this);
-    interruptHandlerManager.setInterruptHandler(InterruptType::Int48, debugLogInterruptHandler);
-    #endif
+    pWaitForSocketEventSyscallArgs->success = (eventState==1) ? 0 : -1;
 }
 
-void CpuCore::bind(){
-    // Indicate that the CpuCore object responsible for handling this actual cpu core is "this"
-    unsigned int thisCpuCoreId = getThisCpuCoreId();
-    if(thisCpuCoreId>=1){
-        Screen* pScreen = Screen::getScreen();
-        pScreen->printk((char*)"In CpuCore::bind(), getThisCpuCoreId() returned ");
-        pScreen->printk(thisCpuCoreId);
-        pScreen->printk((char*)" which is unexpected!\n");
-        while(1);
+void setupSocketRingsSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
+
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(SetupSocketRingsSyscallArgs))){
+            return;
+        }
     }
-    CpuCore::cpuCorePointers[thisCpuCoreId] = this;
 
-    // Bind cpu core private resources to this cpu core
-    timer.bind();
-    tss.bind();
-    currentPagingStructure.bind();
-    interruptHandlerManager.bind();
+    SetupSocketRingsSyscallArgs* pSetupSocketRingsSyscallArgs = (SetupSocketRingsSyscallArgs*)eax;
+    SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
-    // Indicate that the core is running
-    isRunning = true;
-    
-    // Only now bind task switching to the timer interrupt handler
-    timer.setTimerCallback(&timerCallback);
-}
+    // It is impossible that taskID should be -1 here since the task is running
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
 
-CpuCore* CpuCore::getCpuCore(unsigned int cpuCoreId){
-    if(cpuCoreId==0){
-        return CpuCore::cpuCorePointers[0];
+    // Just like the buffers of setReceiveBuffer and setSendBuffer, the network management task uses the rings and the 
+    // buffer area through their kernel addresses, the rings are only initialized here through the address of the task
+    if(pTask->isKernelTask() || pSetupSocketRingsSyscallArgs->rings==nullptr){
+        if(pSetupSocketRingsSyscallArgs->rings==nullptr && (pSetupSocketRingsSyscallArgs->bufferArea!=nullptr || pSetupSocketRingsSyscallArgs->bufferAreaSize!=0)){
+            pSetupSocketRingsSyscallArgs->success = -1;
+            return;
+        }
+
+        pSetupSocketRingsSyscallArgs->success = pSocketManager->setupSocketRings(
+            taskId, pSetupSocketRingsSyscallArgs->rings, pSetupSocketRingsSyscallArgs->rings, 
+            pSetupSocketRingsSyscallArgs->bufferArea, pSetupSocketRingsSyscallArgs->bufferAreaSize);
     }
+    else{
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
 
-    return nullptr;
-}
+        Pair<bool, unsigned int> convertedAddrBlock = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(
+            (unsigned int)pSetupSocketRingsSyscallArgs->rings, sizeof(SocketRings));
+        Pair<bool, unsigned int> convertedAddrBlock2 = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(
+            (unsigned int)pSetupSocketRingsSyscallArgs->bufferArea, pSetupSocketRingsSyscallArgs->bufferAreaSize);
 
-InterruptHandlerManager* CpuCore::getInterruptHandlerManager(){
-    return &interruptHandlerManager;
-}
+        if(!convertedAddrBlock.first || !convertedAddrBlock2.first){
+            pSetupSocketRingsSyscallArgs->success = -1;
+            return;
+        }
 
-Tss* CpuCore::getCurrentTss(){
-    return &tss;
+        pSetupSocketRingsSyscallArgs->success = pSocketManager->setupSocketRings(
+            taskId, pSetupSocketRingsSyscallArgs->rings, (SocketRings*)convertedAddrBlock.second, 
+            (unsigned char*)convertedAddrBlock2.second, pSetupSocketRingsSyscallArgs->bufferAreaSize);
+    }
 }
 
-CurrentPagingStructure* CpuCore::getCurrentPagingStructure(){
-    return &currentPagingStructure;
-}
+void wakeUpSocketRingsSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
 
-void CpuCore::withTaskSwitchingPaused(Runnable& runnable){
-    taskSwitchingPaused = true;
-    runnable.run();
-    taskSwitchingPaused = false;
-}
+    // The rings themselves are only looked at by the network management task (through their kernel addresses)
+    pCpuCore->pSocketManager->ringSocketRingsDoorbell();
 
-Task* CpuCore::getCurrentTask(){
-    return currentTask->value.pTask;
+    // The network management task has a higher priority than user tasks
+    pCpuCore->rescheduleIfRequested();
 }
 
-Task::Task(CpuCore* pCpuCore)
-    :
-    pCpuCore(pCpuCore),
-    taskID(-1),
-    isRunning(false)
-{}
+void sendBatchSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
 
-int Task::getTaskID(){
-    return taskID;
-}
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(SendBatchSyscallArgs))){
+            return;
+        }
+    }
 
-bool Task::getRunningState(){
-    return isRunning;
-}
+    SendBatchSyscallArgs* pSendBatchSyscallArgs = (SendBatchSyscallArgs*)eax;
+    SocketManager* pSocketManager = pCpuCore->pSocketManager;
 
-CpuCore::UserTask::UserTask(CpuCore* pCpuCore, unsigned int taskSpaceBeginVirtualAddr)
-    :
-    Task(pCpuCore),
-    taskSpaceBeginVirtualAddr(taskSpaceBeginVirtualAddr)
-{
-    pTask8MBRegion = 0;
+    // It is impossible that taskID should be -1 here since the task is running
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
 
-    if(pCpuCore->isRunning 
-        && pCpuCore->currentPagingStructure.getPageDirectoryPhysicalAddr()==pCpuCore->kernelPageDirectoryPhysicalAddr
-        && (taskSpaceBeginVirtualAddr % (4096*1024))==0){
-        pTask8MBRegion = pCpuCore->pKernelPageAlloctor->allocateContiguousPages(1024*2);
+    unsigned int numEntries = pSendBatchSyscallArgs->numEntries;
+    if(numEntries > MAX_BATCH_SIZE){
+        pSendBatchSyscallArgs->numAccepted = -1;
+        return;
+    }
+    if(numEntries==0){
+        pSendBatchSyscallArgs->numAccepted = 0;
+        return;
     }
 
-    if(pTask8MBRegion!=0){
-        // taskSpaceBeginVirtualAddr should be 4MB alligned, a.k.a a multiple of 1024*4096
-        unsigned int taskFirstPdeIndex = taskSpaceBeginVirtualAddr/(1024*4096);
-        unsigned int taskSecondPdeIndex = taskFirstPdeIndex+1;
-        // pTaskRegion should be page alligned, a.k.a a multiple of 4096
-        unsigned int taskRegionPageIndex = (pTask8MBRegion)/4096;
+    // Just like the send buffer of setSendBuffer, the network management task uses the entries and their buffers through 
+    // their kernel addresses, an entry with an invalid buffer gets nullptr as buffer and is not accepted
+    // Here the page directory of the task is loaded, thus the entries are read and written through the address of the task
+    SendBatchEntry* entries = pSendBatchSyscallArgs->entries;
+    SendBatchEntry* kernelEntries = entries;
+    unsigned char* buffers[MAX_BATCH_SIZE];
+    if(pTask->isKernelTask()){
+        for(unsigned int i = 0; i < numEntries; i++){
+            buffers[i] = entries[i].buffer;
+        }
+    }
+    else{
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
 
-        unsigned int currentPage = pTask8MBRegion;
+        Pair<bool, unsigned int> convertedAddrBlock = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(
+            (unsigned int)entries, numEntries*sizeof(SendBatchEntry));
+        if(!convertedAddrBlock.first){
+            pSendBatchSyscallArgs->numAccepted = -1;
+            return;
+        }
+        kernelEntries = (SendBatchEntry*)convertedAddrBlock.second;
 
-        // First create a page directory which is exactly the same as the kernel page directory
-        // Allocated at the begin of the 8MB region
-        pTaskPageDirectory = new((unsigned char*)currentPage) PageDirectory();
-        for(int i=0; i<1023; i++){
-            PDE pde = pCpuCore->currentPagingStructure.getPDE(i);
+        for(unsigned int i = 0; i < numEntries; i++){
+            Pair<bool, unsigned int> convertedAddrBlock2 = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(
+                (unsigned int)entries[i].buffer, entries[i].bufferSize);
+            buffers[i] = convertedAddrBlock2.first ? (unsigned char*)convertedAddrBlock2.second : nullptr;
+        }
+    }
+
+    pSendBatchSyscallArgs->numAccepted = pSocketManager->sendBatch(taskId, entries, kernelEntries, buffers, numEntries);
+
+    // The network management task has a higher priority than user tasks
+    pCpuCore->rescheduleIfRequested();
+}
+
+void receiveBatchSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
+
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(ReceiveBatchSyscallArgs))){
+            return;
+        }
+    }
+
+    ReceiveBatchSyscallArgs* pReceiveBatchSyscallArgs = (ReceiveBatchSyscallArgs*)eax;
+    SocketManager* pSocketManager = pCpuCore->pSocketManager;
+
+    // It is impossible that taskID should be -1 here since the task is running
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
+
+    unsigned int numEntries = pReceiveBatchSyscallArgs->numEntries;
+    if(numEntries > MAX_BATCH_SIZE){
+        pReceiveBatchSyscallArgs->numAccepted = -1;
+        return;
+    }
+    if(numEntries==0){
+        pReceiveBatchSyscallArgs->numAccepted = 0;
+        return;
+    }
+
+    // Same as for sendBatch, the network management task writes to the entries and buffers through their kernel addresses
+    ReceiveBatchEntry* entries = pReceiveBatchSyscallArgs->entries;
+    ReceiveBatchEntry* kernelEntries = entries;
+    unsigned char* buffers[MAX_BATCH_SIZE];
+    if(pTask->isKernelTask()){
+        for(unsigned int i = 0; i < numEntries; i++){
+            buffers[i] = entries[i].buffer;
+        }
+    }
+    else{
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+
+        Pair<bool, unsigned int> convertedAddrBlock = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(
+            (unsigned int)entries, numEntries*sizeof(ReceiveBatchEntry));
+        if(!convertedAddrBlock.first){
+            pReceiveBatchSyscallArgs->numAccepted = -1;
+            return;
+        }
+        kernelEntries = (ReceiveBatchEntry*)convertedAddrBlock.second;
+
+        for(unsigned int i = 0; i < numEntries; i++){
+            Pair<bool, unsigned int> convertedAddrBlock2 = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(
+                (unsigned int)entries[i].buffer, entries[i].bufferSize);
+            buffers[i] = convertedAddrBlock2.first ? (unsigned char*)convertedAddrBlock2.second : nullptr;
+        }
+    }
+
+    pReceiveBatchSyscallArgs->numAccepted = pSocketManager->receiveBatch(taskId, entries, kernelEntries, buffers, numEntries);
+}
+
+void futexWaitSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
+
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(FutexWaitSyscallArgs))){
+            return;
+        }
+    }
+
+    FutexWaitSyscallArgs* pFutexWaitSyscallArgs = (FutexWaitSyscallArgs*)eax;
+
+    // A word which isn't aligned could be split over two pages
+    unsigned int wordAddr = (unsigned int)pFutexWaitSyscallArgs->addr;
+    if(wordAddr==0 || (wordAddr & 3)!=0){
+        pFutexWaitSyscallArgs->result = -1;
+        return;
+    }
+
+    // Futexes are identified by the kernel address of their word, which is also the address the socket manager uses 
+    // when it writes the buffers and indicators of the task, the word itself is read through the address of the task 
+    // since its page directory is loaded here
+    unsigned int futexAddr = wordAddr;
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+
+        Pair<bool, unsigned int> convertedAddrBlock = pUserTask->convertContigUserAddrBlockToContigKernelAddrBlock(wordAddr, sizeof(int));
+        if(!convertedAddrBlock.first){
+            pFutexWaitSyscallArgs->result = -1;
+            return;
+        }
+        futexAddr = convertedAddrBlock.second;
+    }
+
+    pCpuCore->stopTicklessMode();
+
+    bool hasTimeout = (pFutexWaitSyscallArgs->timeout!=WAIT_FOREVER);
+    // Deadlines are compared with wrap around, so longer timeouts would be seen as deadlines in the past
+    unsigned int numTicks = pFutexWaitSyscallArgs->timeout;
+    if(numTicks > 0x7FFFFFFF){
+        numTicks = 0x7FFFFFFF;
+    }
+
+    pFutexWaitSyscallArgs->result = pCpuCore->futexWait((volatile int*)wordAddr, futexAddr, pFutexWaitSyscallArgs->expected, 
+        hasTimeout, pCpuCore->timerTicks+numTicks);
+}
+
+void waitSocketsSyscallHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+    Task* pTask = pCpuCore->getCurrentTask();
+
+    // First, make sure that eax points to some space accessible by the task
+    if(!pTask->isKernelTask()){
+        CpuCore::UserTask* pUserTask = (CpuCore::UserTask*)pTask;
+        if(!pUserTask->addrSpaceIsUserAccessible(eax, sizeof(WaitSocketsSyscallArgs))){
+            return;
+        }
+    }
+
+    WaitSocketsSyscallArgs* pWaitSocketsSyscallArgs = (WaitSocketsSyscallArgs*)eax;
+    SocketManager* pSocketManager = pCpuCore->pSocketManager;
+
+    // It is impossible that taskID should be -1 here since the task is running
+    unsigned short taskId = (unsigned short)pTask->getTaskID();
+    unsigned int socketMask = pWaitSocketsSyscallArgs->socketMask;
+
+    volatile int* pEventSequence = pSocketManager->getSocketEventSequence(taskId);
+    if(pEventSequence==nullptr || socketMask==0 || socketMask >= (1u << MAX_NUM_SOCKETS_PER_TASK)){
+        pWaitSocketsSyscallArgs->result = -1;
+        return;
+    }
+
+    pCpuCore->stopTicklessMode();
+
+    bool hasTimeout = (pWaitSocketsSyscallArgs->timeout!=WAIT_FOREVER);
+    // Deadlines are compared with wrap around, so longer timeouts would be seen as deadlines in the past
+    unsigned int numTicks = pWaitSocketsSyscallArgs->timeout;
+    if(numTicks > 0x7FFFFFFF){
+        numTicks = 0x7FFFFFFF;
+    }
+    unsigned int wakeUpTick = pCpuCore->timerTicks+numTicks;
+
+    // Every socket event advances the event sequence after it is made pending, thus if no event is found after reading 
+    // the event sequence, futexWait returns as soon as a new event comes in
+    unsigned int readySockets = 0;
+    while(true){
+        int eventSequence = *pEventSequence;
+        readySockets = pSocketManager->consumeSocketEvents(taskId, socketMask);
+        if(readySockets!=0){
+            break;
+        }
+
+        if(pCpuCore->futexWait(pEventSequence, (unsigned int)pEventSequence, eventSequence, hasTimeout, wakeUpTick)==FUTEX_TIMED_OUT){
+            break;
+        }
+    }
+
+    pWaitSocketsSyscallArgs->result = (int)readySockets;
+}
+
+void rescheduleIpiHandler(unsigned int interruptParam, unsigned int eax){
+    CpuCore* pCpuCore = (CpuCore*)interruptParam;
+
+    // Another cpu core added tasks to the run queues of this cpu core, or has tasks waiting which this cpu core could 
+    // steal if it is idle
+    pCpuCore->stopTicklessMode();
+    if(pCpuCore->currentTask==&pCpuCore->idleTask){
+        pCpuCore->rescheduleRequested = true;
+    }
+    pCpuCore->rescheduleIfRequested();
+}
+
+#if E2E_TESTING
+void debugLogInterruptHandler(unsigned int interruptParam, unsigned int eax){
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    pSerialLog->log((char*)"LogInt: ");
+    pSerialLog->log(eax);
+    pSerialLog->log((char*)"\n");
+}
+#endif
+
+CpuCore* CpuCore::cpuCorePointers[NUM_CPU_CORES];
+unsigned int CpuCore::numCpuCores = 1;
+bool CpuCore::useLapicIds = false;
+unsigned char CpuCore::lapicIdToCpuCoreId[256];
+MemoryManager* CpuCore::pApplicationProcessorMemoryManager = nullptr;
+unsigned int CpuCore::applicationProcessorStarted = 0;
+SpinLock CpuCore::waitQueueLock;
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::futexBuckets[NUM_FUTEX_BUCKETS];
+WaitQueue CpuCore::futexWaitQueue;
+
+unsigned int CpuCore::getThisCpuCoreId(){
+    if(!useLapicIds){
+        return 0;
+    }
+
+    return lapicIdToCpuCoreId[Lapic::getLapicId()];
+}
+
+unsigned int CpuCore::getNumCpuCores(){
+    return numCpuCores;
+}
+
+CpuCore::CpuCore(SocketManager* pSocketManager, unsigned int kernelPageDirectoryPhysicalAddr, PageAllocator* pKernelPageAlloctor, 
+    MemoryManager* pMemoryManager)
+    :
+    tss((unsigned int)MAIN_KERNEL_STACK),
+    lapic(),
+    interruptHandlerManager(),
+    currentPagingStructure(kernelPageDirectoryPhysicalAddr),
+    isRunning(false),
+    cpuCoreId(0),
+    lapicId(0),
+    reservedForKernelTasks(false),
+    timerCounter(0),
+    timerTicksSinceCounterIncrement(0),
+    remainingQuantumTicks(0),
+    timerTicks(0),
+    timerTicksTimestamp(0),
+    taskDescriptorAllocator(pMemoryManager),
+    currentTask(nullptr),
+    runQueueBitmap(0),
+    numRunnableTasks(0),
+    numMigratableTasks(0),
+    lastTaskSwitchTimestamp(0),
+    preemptionRequested(false),
+    rescheduleRequested(false),
+    taskSwitchingPaused(false),
+    fpuOwner(nullptr),
+    taskSwitchedFlagSet(false),
+    timerWheelTicks(1),
+    pSocketManager(pSocketManager),
+    kernelPageDirectoryPhysicalAddr(kernelPageDirectoryPhysicalAddr),
+    pKernelPageAlloctor(pKernelPageAlloctor),
+    timer(TIMER_TICK_FREQUENCY, &lapic),
+    timerCallback(this)
+{
+    #if E2E_TESTING
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    pSerialLog->log((char*)"CpuCore: constructor\n");
+    #endif
+
+    if((unsigned int)this != (unsigned int)taskSwitchStack){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"It is assumed the compiler should place CpuCore and CpuCore::taskSwitchStack at the same address but this isn't the case! OS won't start...\n");
+        while(true);
+    }
+
+    for(unsigned int i=0; i<NUM_POSSIBLE_TASKS; i++){
+        taskDescriptors[i] = nullptr;
+    }
+
+    for(unsigned int i=0; i<NUM_TASK_PRIORITIES; i++){
+        runQueueRoots[i] = nullptr;
+        runQueueMinVruntimes[i] = 0;
+    }
+    
+    // Setup some interrupt handlers specific for this cpu core meaning:
+    // - Exceptions
+    // - Default PIC interrupt handlers
+    // - Syscalls
+    for(unsigned int intType=(unsigned int)InterruptType::DivideByZero; 
+        intType<=(unsigned int)InterruptType::ReservedException8;
+        intType++)
+    {
+        if(intType!=(unsigned int)InterruptType::GeneralProtectionFault && 
+            intType!=(unsigned int)InterruptType::PageFault &&
+            intType!=(unsigned int)InterruptType::CoprocessorNotAvailable)
+        {
+            interruptHandlerManager.setInterruptHandlerParam((InterruptType)intType, (unsigned int)this);
+            interruptHandlerManager.setInterruptHandler((InterruptType)intType, genericExceptionHandler);
+        }
+    }
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::GeneralProtectionFault, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::GeneralProtectionFault, generalProtectionFaultExceptionHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::PageFault, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::PageFault, pageFaultExceptionHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::CoprocessorNotAvailable, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::CoprocessorNotAvailable, coprocessorNotAvailableExceptionHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int49, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int49, yieldTaskSwitchIntHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int50, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int50, openSocketSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int51, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int51, setReceiveBufferSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int52, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int52, setSendBufferSyscallHandler);
+    
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int53, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int53, closeSocketSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int54, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int54, printToScreenSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int55, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int55, getTimerCounterSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int56, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int56, waitForSocketEventSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int57, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int57, sleepSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int58, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int58, setupSocketRingsSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int59, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int59, wakeUpSocketRingsSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int60, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int60, sendBatchSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int61, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int61, receiveBatchSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int62, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int62, futexWaitSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int63, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int63, waitSocketsSyscallHandler);
+
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::RescheduleIpi, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::RescheduleIpi, rescheduleIpiHandler);
+
+    #if E2E_TESTING
+    interruptHandlerManager.setInterruptHandlerParam(InterruptType::Int48, (unsigned int)this);
+    interruptHandlerManager.setInterruptHandler(InterruptType::Int48, debugLogInterruptHandler);
+    #endif
+}
+
+void CpuCore::bind(){
+    // Indicate that the CpuCore object responsible for handling this actual cpu core is "this"
+    unsigned int thisCpuCoreId = getThisCpuCoreId();
+    if(thisCpuCoreId>=NUM_CPU_CORES){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"In CpuCore::bind(), getThisCpuCoreId() returned ");
+        pScreen->printk(thisCpuCoreId);
+        pScreen->printk((char*)" which is unexpected!\n");
+        while(1);
+    }
+    CpuCore::cpuCorePointers[thisCpuCoreId] = this;
+    cpuCoreId = thisCpuCoreId;
+    lapicId = Lapic::getLapicId();
+
+    // The TSS and INTERRUPT_HANDLERS gdt entries are different for every cpu core
+    loadGdtCopy(gdtEntries);
+
+    // The idle task must exist before the first task switch can occur
+    setupIdleTask();
+
+    setupFpu();
+
+    // Bind cpu core private resources to this cpu core
+    // The legacy PIC only interrupts the bootstrap core, every core gets its own timer interrupts from its local APIC
+    bool isBootstrapCore = (thisCpuCoreId==0);
+    lapic.bind(isBootstrapCore);
+    timer.bind();
+    tss.bind();
+    currentPagingStructure.bind();
+    interruptHandlerManager.bind(isBootstrapCore);
+
+    // User tasks can enter syscalls with sysenter if the cpu supports it (SEP, bit 11), otherwise they keep using the 
+    // syscall interrupts (cpp_lib/syscalls.cpp checks the same flag)
+    unsigned int cpuidFeatureFlags = 0;
+    getCpuidFeatureFlags(&cpuidFeatureFlags);
+    if(cpuidFeatureFlags & (1 << 11)){
+        interruptHandlerManager.enableSysenter(tss.setupSysenterStack((unsigned int)this));
+    }
+
+    // Indicate that the core is running
+    isRunning = true;
+    
+    // Only now bind task switching to the timer interrupt handler
+    timer.setTimerCallback(&timerCallback);
+}
+
+void CpuCore::setupIdleTask(){
+    unsigned int idleTaskStackSpaceBegin = pKernelPageAlloctor->allocateContiguousPages(KERNEL_STACK_SIZE/0x1000);
+    if(idleTaskStackSpaceBegin==0){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"Failed to allocate a stack for the idle task\n");
+        while(1);
+    }
+
+    unsigned int idleTaskEsp = idleTaskStackSpaceBegin+KERNEL_STACK_SIZE-4;
+    *((unsigned int*)idleTaskEsp) = 0;
+
+    idleTask.next = nullptr;
+    idleTask.prev = nullptr;
+    idleTask.value.pTask = nullptr;
+    idleTask.value.taskEsp = interruptHandlerManager.buildIntHandlerStackForKernelPriv(InterruptType::PITTimer, idleTaskEsp, (unsigned int)idleTaskCode);
+    idleTask.value.kernelEspStackBegin = idleTaskStackSpaceBegin+KERNEL_STACK_SIZE-4;
+    idleTask.value.pageDirectoryPhysicalAddr = kernelPageDirectoryPhysicalAddr;
+    idleTask.value.priority = 0;
+    idleTask.value.state = TaskState::Runnable;
+}
+
+void CpuCore::setupFpu(){
+    unsigned int cpuidFeatureFlags = 0;
+    getCpuidFeatureFlags(&cpuidFeatureFlags);
+    // FXSR (bit 24) and SSE (bit 25) are required
+    if((cpuidFeatureFlags & (1 << 24))==0 || (cpuidFeatureFlags & (1 << 25))==0){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"The cpu doesn't support FXSAVE/FXRSTOR or SSE, OS won't start...\n");
+        while(1);
+    }
+
+    enableFpu();
+    initFpuState();
+    saveFpuState(initialFpuState);
+
+    // No task owns the FPU yet
+    fpuOwner = nullptr;
+    setTaskSwitchedFlag();
+    taskSwitchedFlagSet = true;
+}
+
+CpuCore* CpuCore::getCpuCore(unsigned int cpuCoreId){
+    if(cpuCoreId<NUM_CPU_CORES){
+        return CpuCore::cpuCorePointers[cpuCoreId];
+    }
+
+    return nullptr;
+}
+
+void CpuCore::waitTimerTicks(unsigned int numTicks){
+    unsigned int beginTick = getTimerTicks();
+    while(getTimerTicks()-beginTick < numTicks){
+        __asm__ __volatile__("hlt" ::: "memory");
+    }
+}
+
+void CpuCore::startApplicationProcessors(MemoryManager* pMemoryManager){
+    ACPITables* pACPITables = ACPITables::getACPITables();
+    Screen* pScreen = Screen::getScreen();
+    #if E2E_TESTING
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    pACPITables->logProcessors();
+    #endif
+
+    unsigned int thisLapicId = Lapic::getLapicId();
+    for(unsigned int i=0; i<256; i++){
+        lapicIdToCpuCoreId[i] = 0;
+    }
+    useLapicIds = true;
+
+    memCopy(&ap_trampoline_start, (unsigned char*)AP_TRAMPOLINE_ADDR, &ap_trampoline_end-&ap_trampoline_start);
+    ApTrampolineParams* pParams = (ApTrampolineParams*)(AP_TRAMPOLINE_ADDR+(&ap_trampoline_params-&ap_trampoline_start));
+    __asm__ __volatile__("sgdt %0" : "=m"(pParams->gdtDescr));
+    pParams->entry = (unsigned int)applicationProcessorMain;
+
+    pApplicationProcessorMemoryManager = pMemoryManager;
+
+    for(unsigned int i=0; i<pACPITables->getNumProcessors() && numCpuCores<NUM_CPU_CORES; i++){
+        unsigned int lapicId = pACPITables->getProcessorLapicId(i);
+        if(lapicId==thisLapicId){
+            continue;
+        }
+
+        unsigned int stackSpaceBegin = pKernelPageAlloctor->allocateContiguousPages(KERNEL_STACK_SIZE/0x1000);
+        if(stackSpaceBegin==0){
+            pScreen->printk((char*)"Failed to allocate a stack for an application processor\n");
+            break;
+        }
+        pParams->stack = stackSpaceBegin+KERNEL_STACK_SIZE-4;
+
+        // The new core needs to know its id before it binds its CpuCore
+        unsigned int cpuCoreId = numCpuCores;
+        lapicIdToCpuCoreId[lapicId] = cpuCoreId;
+        atomicStore(&applicationProcessorStarted, 0);
+
+        // https://wiki.osdev.org/Symmetric_Multiprocessing#Startup_Sequence
+        lapic.sendInitIpi(lapicId);
+        waitTimerTicks(10);
+        lapic.sendStartupIpi(lapicId, AP_TRAMPOLINE_ADDR);
+        waitTimerTicks(1);
+        if(*((volatile unsigned int*)&applicationProcessorStarted)==0){
+            lapic.sendStartupIpi(lapicId, AP_TRAMPOLINE_ADDR);
+        }
+
+        for(unsigned int j=0; j<1000 && *((volatile unsigned int*)&applicationProcessorStarted)==0; j++){
+            waitTimerTicks(1);
+        }
+
+        if(*((volatile unsigned int*)&applicationProcessorStarted)==0){
+            // The stack is not freed since the processor might still start using it
+            pScreen->printk((char*)"Application processor with local APIC id ");
+            pScreen->printk(lapicId);
+            pScreen->printk((char*)" didn't start\n");
+            continue;
+        }
+
+        numCpuCores++;
+    }
+
+    #if E2E_TESTING
+    pSerialLog->log((char*)"SMP: number of cpu cores: ");
+    pSerialLog->log(numCpuCores);
+    pSerialLog->log((char*)"\n");
+    #endif
+}
+
+void CpuCore::applicationProcessorMain(){
+    CpuCore* pBootstrapCpuCore = CpuCore::cpuCorePointers[0];
+
+    unsigned char* cpuCoreAddr = pApplicationProcessorMemoryManager->allocate(alignof(CpuCore), sizeof(CpuCore));
+    if(cpuCoreAddr == nullptr){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"Failed to allocate memory for CpuCore of an application processor\n");
+        while(1);
+    }
+    CpuCore* pCpuCore = new(cpuCoreAddr) CpuCore(pBootstrapCpuCore->pSocketManager, 
+        pBootstrapCpuCore->kernelPageDirectoryPhysicalAddr,
+        pBootstrapCpuCore->pKernelPageAlloctor,
+        pApplicationProcessorMemoryManager);
+
+    // The first timer interrupt switches to the idle task, this function is never returned to after that, so it should 
+    // signal that the core started before that can happen
+    class StartCpuCore : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+
+        public:
+            StartCpuCore(CpuCore* pCpuCore)
+                :
+                pCpuCore(pCpuCore)
+            {}
+
+            void run() override{
+                pCpuCore->copyTimerTicks(CpuCore::cpuCorePointers[0]);
+                pCpuCore->bind();
+                atomicStore(&applicationProcessorStarted, 1);
+            }
+    };
+
+    StartCpuCore startCpuCore(pCpuCore);
+    pCpuCore->withTaskSwitchingPaused(startCpuCore);
+
+    // Like main this is never returned to once the first task switch happens
+    while(1){
+        __asm__ __volatile__("hlt" ::: "memory");
+    }
+}
+
+InterruptHandlerManager* CpuCore::getInterruptHandlerManager(){
+    return &interruptHandlerManager;
+}
+
+unsigned int CpuCore::getLapicId(){
+    return lapicId;
+}
+
+void CpuCore::sendIpi(CpuCore* pCpuCore, InterruptType intType){
+    // The local APIC registers are at the same address for every cpu core, so this sends the IPI from this cpu core
+    lapic.sendFixedIpi(pCpuCore->lapicId, (unsigned int)intType);
+}
+
+void CpuCore::reserveForKernelTasks(){
+    reservedForKernelTasks = true;
+}
+
+Tss* CpuCore::getCurrentTss(){
+    return &tss;
+}
+
+CurrentPagingStructure* CpuCore::getCurrentPagingStructure(){
+    return &currentPagingStructure;
+}
+
+void CpuCore::withTaskSwitchingPaused(Runnable& runnable){
+    bool wasPaused = taskSwitchingPaused;
+    taskSwitchingPaused = true;
+    runnable.run();
+    taskSwitchingPaused = wasPaused;
+}
+
+Task* CpuCore::getCurrentTask(){
+    return currentTask->value.pTask;
+}
+
+TaskSwitchStatistics CpuCore::getTaskSwitchStatistics(){
+    return taskSwitchStatistics;
+}
+
+void CpuCore::addToRunQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    unsigned int priority = pTaskElement->value.priority;
+
+    if(pTaskElement->value.vruntime<runQueueMinVruntimes[priority]){
+        pTaskElement->value.vruntime = runQueueMinVruntimes[priority];
+    }
+
+    pTaskElement->next = nullptr;
+    pTaskElement->prev = nullptr;
+    pTaskElement->value.heapChild = nullptr;
+    runQueueRoots[priority] = mergeHeaps(runQueueRoots[priority], pTaskElement);
+
+    runQueueBitmap |= (1 << priority);
+
+    numRunnableTasks++;
+    if(pTaskElement->value.canMigrate){
+        numMigratableTasks++;
+    }
+}
+
+void CpuCore::removeFromRunQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    unsigned int priority = pTaskElement->value.priority;
+
+    DoublyLinkedListElement<TaskDescriptor>* pChildren = mergeHeapSiblings(pTaskElement->value.heapChild);
+    pTaskElement->value.heapChild = nullptr;
+
+    if(runQueueRoots[priority]==pTaskElement){
+        runQueueRoots[priority] = pChildren;
+    }
+    else{
+        // prev is the parent if this task is its first child, otherwise prev is the previous sibling
+        if(pTaskElement->prev->value.heapChild==pTaskElement){
+            pTaskElement->prev->value.heapChild = pTaskElement->next;
+        }
+        else{
+            pTaskElement->prev->next = pTaskElement->next;
+        }
+        if(pTaskElement->next!=nullptr){
+            pTaskElement->next->prev = pTaskElement->prev;
+        }
+        runQueueRoots[priority] = mergeHeaps(runQueueRoots[priority], pChildren);
+    }
+    pTaskElement->next = nullptr;
+    pTaskElement->prev = nullptr;
+
+    if(runQueueRoots[priority]==nullptr){
+        runQueueBitmap &= ~(1 << priority);
+    }
+
+    numRunnableTasks--;
+    if(pTaskElement->value.canMigrate){
+        numMigratableTasks--;
+    }
+}
+
+// Both roots should not have any siblings, returns the root of the merged heap
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::mergeHeaps(DoublyLinkedListElement<TaskDescriptor>* pFirstRoot, DoublyLinkedListElement<TaskDescriptor>* pSecondRoot){
+    if(pFirstRoot==nullptr) return pSecondRoot;
+    if(pSecondRoot==nullptr) return pFirstRoot;
+
+    // On equal vruntimes the task which was in the heap first stays in front
+    if(pSecondRoot->value.vruntime<pFirstRoot->value.vruntime){
+        DoublyLinkedListElement<TaskDescriptor>* temp = pFirstRoot;
+        pFirstRoot = pSecondRoot;
+        pSecondRoot = temp;
+    }
+
+    pSecondRoot->prev = pFirstRoot;
+    pSecondRoot->next = pFirstRoot->value.heapChild;
+    if(pFirstRoot->value.heapChild!=nullptr){
+        pFirstRoot->value.heapChild->prev = pSecondRoot;
+    }
+    pFirstRoot->value.heapChild = pSecondRoot;
+
+    return pFirstRoot;
+}
+
+// Standard two-pass merge of a list of siblings into one heap, returns the root of this heap
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::mergeHeapSiblings(DoublyLinkedListElement<TaskDescriptor>* pFirstSibling){
+    // First pass: merge the siblings in pairs from left to right, the merged pairs are linked in reverse order
+    DoublyLinkedListElement<TaskDescriptor>* pMergedPairs = nullptr;
+    while(pFirstSibling!=nullptr){
+        DoublyLinkedListElement<TaskDescriptor>* pFirst = pFirstSibling;
+        DoublyLinkedListElement<TaskDescriptor>* pSecond = pFirst->next;
+        if(pSecond!=nullptr){
+            pFirstSibling = pSecond->next;
+            pSecond->next = nullptr;
+            pSecond->prev = nullptr;
+        }
+        else{
+            pFirstSibling = nullptr;
+        }
+        pFirst->next = nullptr;
+        pFirst->prev = nullptr;
+
+        DoublyLinkedListElement<TaskDescriptor>* pMerged = mergeHeaps(pFirst, pSecond);
+        pMerged->next = pMergedPairs;
+        pMergedPairs = pMerged;
+    }
+
+    // Second pass: merge the pairs from right to left into one heap
+    DoublyLinkedListElement<TaskDescriptor>* pRoot = nullptr;
+    while(pMergedPairs!=nullptr){
+        DoublyLinkedListElement<TaskDescriptor>* pMerged = pMergedPairs;
+        pMergedPairs = pMerged->next;
+        pMerged->next = nullptr;
+        pRoot = mergeHeaps(pRoot, pMerged);
+    }
+
+    return pRoot;
+}
+
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::pickNextTask(bool currentTaskWasPreempted){
+    unsigned long long now = readTimestampCounter();
+    unsigned long long elapsed = now-lastTaskSwitchTimestamp;
+    lastTaskSwitchTimestamp = now;
+
+    DoublyLinkedListElement<TaskDescriptor>* pickedTask = nullptr;
+
+    if(currentTask!=nullptr && currentTask!=&idleTask){
+        currentTask->value.statistics.runtimeCycles += elapsed;
+
+        // Charge the current task for the time it has been running, weighted by its weight
+        // (clamped to 32 bits to make sure the multiplication can't overflow)
+        if(elapsed>0xFFFFFFFF){
+            elapsed = 0xFFFFFFFF;
+        }
+        unsigned long long weightedElapsed = (elapsed*currentTask->value.inverseWeight) >> 16;
+
+        // A blocked current task is not in any run queue, otherwise the task needs to be removed and added again 
+        // because its position in the pairing heap changes
+        if(currentTask->value.state==TaskState::Runnable){
+            removeFromRunQueue(currentTask);
+            currentTask->value.vruntime += weightedElapsed;
+            addToRunQueue(currentTask);
+
+            // A task which gives up the cpu voluntarily (e.g. because it has nothing to do) lets lower priority tasks
+            // run until the next timer interrupt, otherwise higher priority tasks which are polling would starve 
+            // all lower priority tasks
+            if(!currentTaskWasPreempted){
+                unsigned int lowerPrioritiesBitmap = runQueueBitmap & ((1 << currentTask->value.priority)-1);
+                if(lowerPrioritiesBitmap!=0){
+                    pickedTask = runQueueRoots[31-__builtin_clz(lowerPrioritiesBitmap)];
+                }
+                else{
+                    // Otherwise let any other task with the same priority run, even if the current task still has the 
+                    // smallest vruntime
+                    removeFromRunQueue(currentTask);
+                    if(runQueueBitmap!=0){
+                        pickedTask = runQueueRoots[31-__builtin_clz(runQueueBitmap)];
+                    }
+                    addToRunQueue(currentTask);
+                }
+            }
+        }
+        else{
+            currentTask->value.vruntime += weightedElapsed;
+        }
+    }
+
+    if(pickedTask==nullptr){
+        if(runQueueBitmap==0){
+            // Rather than idling, run a task which is waiting on another cpu core
+            if(!reservedForKernelTasks){
+                pickedTask = stealTask();
+            }
+            if(pickedTask==nullptr){
+                return &idleTask;
+            }
+        }
+        else{
+            pickedTask = runQueueRoots[31-__builtin_clz(runQueueBitmap)];
+        }
+    }
+
+    unsigned int priority = pickedTask->value.priority;
+    if(pickedTask->value.vruntime>runQueueMinVruntimes[priority]){
+        runQueueMinVruntimes[priority] = pickedTask->value.vruntime;
+    }
+
+    return pickedTask;
+}
+
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::stealTask(){
+    // The busiest cpu core is chosen without holding any lock, it might have changed by the time its lock is taken
+    CpuCore* pBusiestCpuCore = nullptr;
+    unsigned int busiestNumRunnableTasks = 1;
+    for(unsigned int i=0; i<NUM_CPU_CORES; i++){
+        CpuCore* pCpuCore = cpuCorePointers[i];
+        if(pCpuCore==nullptr || pCpuCore==this || !pCpuCore->isRunning){
+            continue;
+        }
+
+        // A cpu core with a single runnable task is running it
+        unsigned int numRunnableTasks = *((volatile unsigned int*)&pCpuCore->numRunnableTasks);
+        unsigned int numMigratableTasks = *((volatile unsigned int*)&pCpuCore->numMigratableTasks);
+        if(numRunnableTasks>busiestNumRunnableTasks && numMigratableTasks>0){
+            pBusiestCpuCore = pCpuCore;
+            busiestNumRunnableTasks = numRunnableTasks;
+        }
+    }
+
+    if(pBusiestCpuCore==nullptr){
+        return nullptr;
+    }
+
+    // This cpu core already holds its own runQueueLock, waiting for the lock of the other cpu core could deadlock if that 
+    // cpu core is trying to steal from this one, simply try again at the next task switch
+    if(!pBusiestCpuCore->runQueueLock.tryLock()){
+        return nullptr;
+    }
+
+    DoublyLinkedListElement<TaskDescriptor>* pStolenTask = pBusiestCpuCore->findTaskToSteal();
+    if(pStolenTask!=nullptr){
+        pBusiestCpuCore->removeFromRunQueue(pStolenTask);
+
+        // vruntimes of different cpu cores can't be compared, the task keeps how far it is ahead of the other tasks
+        unsigned int priority = pStolenTask->value.priority;
+        unsigned long long vruntimeAheadOfQueue = 0;
+        if(pStolenTask->value.vruntime>pBusiestCpuCore->runQueueMinVruntimes[priority]){
+            vruntimeAheadOfQueue = pStolenTask->value.vruntime-pBusiestCpuCore->runQueueMinVruntimes[priority];
+        }
+        pStolenTask->value.vruntime = runQueueMinVruntimes[priority]+vruntimeAheadOfQueue;
+
+        pStolenTask->value.pCpuCore = this;
+        addToRunQueue(pStolenTask);
+    }
+
+    pBusiestCpuCore->runQueueLock.unlock();
+
+    return pStolenTask;
+}
+
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::findTaskToSteal(){
+    unsigned int remainingRunQueues = runQueueBitmap;
+    while(remainingRunQueues!=0){
+        unsigned int priority = 31-__builtin_clz(remainingRunQueues);
+        remainingRunQueues &= ~(1 << priority);
+
+        // Only the root and its children are considered, the task which should run first on this cpu core (the root) is
+        // usually the current task
+        DoublyLinkedListElement<TaskDescriptor>* pCandidate = runQueueRoots[priority];
+        DoublyLinkedListElement<TaskDescriptor>* pNextCandidate = pCandidate->value.heapChild;
+        while(pCandidate!=nullptr){
+            // The FPU registers of this cpu core still contain the FPU state of fpuOwner
+            if(pCandidate->value.canMigrate && pCandidate!=currentTask && pCandidate!=fpuOwner){
+                return pCandidate;
+            }
+
+            pCandidate = pNextCandidate;
+            if(pNextCandidate!=nullptr){
+                pNextCandidate = pNextCandidate->next;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+CpuCore* CpuCore::getLeastLoadedCpuCore(){
+    CpuCore* pLeastLoadedCpuCore = nullptr;
+    for(unsigned int i=0; i<NUM_CPU_CORES; i++){
+        CpuCore* pCpuCore = cpuCorePointers[i];
+        if(pCpuCore==nullptr || !pCpuCore->isRunning){
+            continue;
+        }
+
+        if(pLeastLoadedCpuCore==nullptr || 
+            (pLeastLoadedCpuCore->reservedForKernelTasks && !pCpuCore->reservedForKernelTasks) ||
+            (pLeastLoadedCpuCore->reservedForKernelTasks==pCpuCore->reservedForKernelTasks && 
+            *((volatile unsigned int*)&pCpuCore->numRunnableTasks) < *((volatile unsigned int*)&pLeastLoadedCpuCore->numRunnableTasks)))
+        {
+            pLeastLoadedCpuCore = pCpuCore;
+        }
+    }
+
+    return pLeastLoadedCpuCore;
+}
+
+void CpuCore::notifyCpuCores(unsigned int cpuCoreMask){
+    bool tasksAreWaiting = false;
+    for(unsigned int i=0; i<NUM_CPU_CORES; i++){
+        if((cpuCoreMask & (1 << i))==0){
+            continue;
+        }
+
+        CpuCore* pCpuCore = cpuCorePointers[i];
+        if(pCpuCore==this){
+            stopTicklessMode();
+        }
+        else{
+            sendRescheduleIpi(pCpuCore);
+        }
+
+        if(*((volatile unsigned int*)&pCpuCore->numRunnableTasks)>1 && *((volatile unsigned int*)&pCpuCore->numMigratableTasks)>0){
+            tasksAreWaiting = true;
+        }
+    }
+
+    if(tasksAreWaiting){
+        wakeUpIdleCpuCore();
+    }
+}
+
+void CpuCore::sendRescheduleIpi(CpuCore* pCpuCore){
+    // The local APIC registers are at the same address for every cpu core, so this sends the IPI from this cpu core
+    lapic.sendFixedIpi(pCpuCore->lapicId, LAPIC_RESCHEDULE_VECTOR);
+}
+
+void CpuCore::wakeUpIdleCpuCore(){
+    for(unsigned int i=0; i<NUM_CPU_CORES; i++){
+        CpuCore* pCpuCore = cpuCorePointers[i];
+        if(pCpuCore==nullptr || pCpuCore==this || !pCpuCore->isRunning || pCpuCore->reservedForKernelTasks){
+            continue;
+        }
+
+        // The reschedule IPI makes an idle cpu core try to steal a task
+        if(*((DoublyLinkedListElement<TaskDescriptor>* volatile*)&pCpuCore->currentTask)==&pCpuCore->idleTask){
+            sendRescheduleIpi(pCpuCore);
+            return;
+        }
+    }
+}
+
+CpuCore* CpuCore::lockTaskCpuCore(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    while(true){
+        CpuCore* pCpuCore = *((CpuCore* volatile*)&pTaskElement->value.pCpuCore);
+        pCpuCore->runQueueLock.lock();
+
+        // The task was stolen by another cpu core while waiting for the lock
+        if(pTaskElement->value.pCpuCore==pCpuCore){
+            return pCpuCore;
+        }
+
+        pCpuCore->runQueueLock.unlock();
+    }
+}
+
+void CpuCore::waitUntilNotCurrentTask(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    class CheckCurrentTask : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+
+        public:
+            bool isCurrentTask;
+
+            CheckCurrentTask(CpuCore* pCpuCore, DoublyLinkedListElement<TaskDescriptor>* pTaskElement)
+                :
+                pCpuCore(pCpuCore),
+                pTaskElement(pTaskElement),
+                isCurrentTask(true)
+            {}
+
+            void run() override{
+                // yieldTaskSwitch only releases the lock once it is done with the task it switched away from
+                pCpuCore->runQueueLock.lock();
+                isCurrentTask = (pCpuCore->currentTask==pTaskElement);
+                pCpuCore->runQueueLock.unlock();
+            }
+    };
+
+    CheckCurrentTask checkCurrentTask(this, pTaskElement);
+    while(true){
+        interruptHandlerManager.withInterruptsDisabled(checkCurrentTask);
+        if(!checkCurrentTask.isCurrentTask){
+            return;
+        }
+        __asm__ __volatile__("pause" ::: "memory");
+    }
+}
+
+void CpuCore::removeFromWaitQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    WaitQueue* pWaitQueue = pTaskElement->value.pWaitQueue;
+
+    if(pTaskElement->prev!=nullptr){
+        pTaskElement->prev->next = pTaskElement->next;
+    }
+    else{
+        pWaitQueue->head = pTaskElement->next;
+    }
+    if(pTaskElement->next!=nullptr){
+        pTaskElement->next->prev = pTaskElement->prev;
+    }
+    else{
+        pWaitQueue->tail = pTaskElement->prev;
+    }
+    pTaskElement->next = nullptr;
+    pTaskElement->prev = nullptr;
+    pTaskElement->value.pWaitQueue = nullptr;
+}
+
+void CpuCore::addToWaitQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement, WaitQueue* pWaitQueue){
+    pTaskElement->value.pWaitQueue = pWaitQueue;
+
+    pTaskElement->next = nullptr;
+    pTaskElement->prev = pWaitQueue->tail;
+    if(pWaitQueue->tail!=nullptr){
+        pWaitQueue->tail->next = pTaskElement;
+    }
+    else{
+        pWaitQueue->head = pTaskElement;
+    }
+    pWaitQueue->tail = pTaskElement;
+}
+
+void CpuCore::waitOn(WaitQueue* pWaitQueue, TicketLock* pLock){
+    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = currentTask;
+
+    waitQueueLock.lock();
+    runQueueLock.lock();
+    // A task which is being stopped by another cpu core is already removed from its run queue
+    if(pTaskElement->value.state==TaskState::Runnable){
+        removeFromRunQueue(pTaskElement);
+        pTaskElement->value.state = TaskState::Blocked;
+        addToWaitQueue(pTaskElement, pWaitQueue);
+    }
+    runQueueLock.unlock();
+    waitQueueLock.unlock();
+
+    if(pLock!=nullptr){
+        pLock->unlock();
+    }
+
+    yieldUntilRunnable(pTaskElement);
+
+    if(pLock!=nullptr){
+        pLock->lock();
+    }
+}
+
+void CpuCore::sleepUntil(unsigned int wakeUpTick){
+    // The wake up tick might come before the timer interrupt which was planned by tickless mode
+    stopTicklessMode();
+
+    if((int)(wakeUpTick-timerTicks) <= 0){
+        return;
+    }
+
+    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = currentTask;
+
+    waitQueueLock.lock();
+    runQueueLock.lock();
+    if(pTaskElement->value.state==TaskState::Runnable){
+        removeFromRunQueue(pTaskElement);
+        pTaskElement->value.state = TaskState::Blocked;
+        pTaskElement->value.wakeUpTick = wakeUpTick;
+        addToTimerWheel(pTaskElement);
+    }
+    runQueueLock.unlock();
+    waitQueueLock.unlock();
+
+    yieldUntilRunnable(pTaskElement);
+}
+
+void CpuCore::yieldUntilRunnable(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    // The task can be woken up by another cpu core, a stopped task is never switched back to
+    volatile TaskState* pState = &pTaskElement->value.state;
+    while(*pState!=TaskState::Runnable){
+        yield();
+
+        // yield only returns immediately if task switching is paused, in that case just wait for an 
+        // interrupt which might wake this task up
+        if(*pState!=TaskState::Runnable){
+            __asm__ __volatile__("sti; hlt; cli" ::: "memory");
+        }
+    }
+}
+
+void CpuCore::wakeUpAll(WaitQueue* pWaitQueue){
+    class WakeUpTasks : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+            WaitQueue* pWaitQueue;
+
+        public:
+            WakeUpTasks(CpuCore* pCpuCore, WaitQueue* pWaitQueue)
+                :
+                pCpuCore(pCpuCore),
+                pWaitQueue(pWaitQueue)
+            {}
+
+            void run() override{
+                unsigned int cpuCoresToNotify = 0;
+
+                CpuCore::waitQueueLock.lock();
+                while(pWaitQueue->head!=nullptr){
+                    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = pWaitQueue->head;
+                    pCpuCore->removeFromWaitQueue(pTaskElement);
+                    cpuCoresToNotify |= pCpuCore->makeRunnable(pTaskElement);
+                }
+                CpuCore::waitQueueLock.unlock();
+
+                // Another task becoming runnable means there might be something to preempt again
+                pCpuCore->notifyCpuCores(cpuCoresToNotify);
+            }
+    };
+
+    WakeUpTasks wakeUpTasks(this, pWaitQueue);
+    interruptHandlerManager.withInterruptsDisabled(wakeUpTasks);
+}
+
+unsigned int CpuCore::makeRunnable(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    // Blocked tasks are never stolen, so the task goes back to the cpu core it was blocked on
+    CpuCore* pTaskCpuCore = pTaskElement->value.pCpuCore;
+    pTaskCpuCore->runQueueLock.lock();
+    pTaskElement->value.state = TaskState::Runnable;
+    pTaskCpuCore->addToRunQueue(pTaskElement);
+    if(pTaskCpuCore->shouldPreemptCurrentTask(pTaskElement)){
+        pTaskCpuCore->rescheduleRequested = true;
+    }
+    pTaskCpuCore->runQueueLock.unlock();
+
+    return 1 << pTaskCpuCore->cpuCoreId;
+}
+
+DoublyLinkedListElement<TaskDescriptor>** CpuCore::getFutexBucket(unsigned int futexAddr){
+    return &futexBuckets[(futexAddr >> 2) & (NUM_FUTEX_BUCKETS-1)];
+}
+
+void CpuCore::removeFromFutexBucket(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    DoublyLinkedListElement<TaskDescriptor>** ppFutexWaiter = getFutexBucket(pTaskElement->value.futexAddr);
+    while(*ppFutexWaiter!=pTaskElement){
+        ppFutexWaiter = &(*ppFutexWaiter)->value.pNextFutexWaiter;
+    }
+    *ppFutexWaiter = pTaskElement->value.pNextFutexWaiter;
+
+    pTaskElement->value.pNextFutexWaiter = nullptr;
+    pTaskElement->value.futexAddr = 0;
+}
+
+int CpuCore::futexWait(volatile int* pWord, unsigned int futexAddr, int expected, bool hasTimeout, unsigned int wakeUpTick){
+    // The wake up tick might come before the timer interrupt which was planned by tickless mode
+    if(hasTimeout){
+        stopTicklessMode();
+    }
+
+    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = currentTask;
+
+    // The task is linked in its futex bucket before the word is checked and futexWake checks the bucket after the word 
+    // was written (both with a full memory barrier in between), thus either the new value is seen here or the task is 
+    // seen by futexWake, even though futexWake doesn't take waitQueueLock for an empty bucket
+    waitQueueLock.lock();
+    DoublyLinkedListElement<TaskDescriptor>** ppFutexBucket = getFutexBucket(futexAddr);
+    pTaskElement->value.futexAddr = futexAddr;
+    pTaskElement->value.pNextFutexWaiter = *ppFutexBucket;
+    *ppFutexBucket = pTaskElement;
+    memoryBarrier();
+
+    if(*pWord!=expected){
+        removeFromFutexBucket(pTaskElement);
+        waitQueueLock.unlock();
+        return FUTEX_VALUE_CHANGED;
+    }
+    if(hasTimeout && (int)(wakeUpTick-timerTicks) <= 0){
+        removeFromFutexBucket(pTaskElement);
+        waitQueueLock.unlock();
+        return FUTEX_TIMED_OUT;
+    }
+
+    runQueueLock.lock();
+    if(pTaskElement->value.state==TaskState::Runnable){
+        removeFromRunQueue(pTaskElement);
+        pTaskElement->value.state = TaskState::Blocked;
+        if(hasTimeout){
+            pTaskElement->value.wakeUpTick = wakeUpTick;
+            addToTimerWheel(pTaskElement);
+        }
+        else{
+            addToWaitQueue(pTaskElement, &futexWaitQueue);
+        }
+    }
+    else{
+        removeFromFutexBucket(pTaskElement);
+    }
+    runQueueLock.unlock();
+    waitQueueLock.unlock();
+
+    yieldUntilRunnable(pTaskElement);
+
+    // futexWake removes the task from its futex bucket, so a task which is still in there was woken up by the timer wheel
+    waitQueueLock.lock();
+    bool timedOut = (pTaskElement->value.futexAddr!=0);
+    if(timedOut){
+        removeFromFutexBucket(pTaskElement);
+    }
+    waitQueueLock.unlock();
+
+    return timedOut ? FUTEX_TIMED_OUT : FUTEX_WOKEN_UP;
+}
+
+void CpuCore::futexWake(volatile void* pWord){
+    class WakeUpFutexWaiters : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+            unsigned int futexAddr;
+
+        public:
+            WakeUpFutexWaiters(CpuCore* pCpuCore, unsigned int futexAddr)
+                :
+                pCpuCore(pCpuCore),
+                futexAddr(futexAddr)
+            {}
+
+            void run() override{
+                unsigned int cpuCoresToNotify = 0;
+
+                CpuCore::waitQueueLock.lock();
+                DoublyLinkedListElement<TaskDescriptor>** ppFutexWaiter = CpuCore::getFutexBucket(futexAddr);
+                while(*ppFutexWaiter!=nullptr){
+                    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = *ppFutexWaiter;
+                    if(pTaskElement->value.futexAddr!=futexAddr){
+                        ppFutexWaiter = &pTaskElement->value.pNextFutexWaiter;
+                        continue;
+                    }
+
+                    *ppFutexWaiter = pTaskElement->value.pNextFutexWaiter;
+                    pTaskElement->value.pNextFutexWaiter = nullptr;
+                    pTaskElement->value.futexAddr = 0;
+
+                    // A task which timed out is already runnable, it still counts as woken up since it left the bucket here
+                    if(pTaskElement->value.state==TaskState::Blocked){
+                        pCpuCore->removeFromWaitQueue(pTaskElement);
+                        cpuCoresToNotify |= pCpuCore->makeRunnable(pTaskElement);
+                    }
+                }
+                CpuCore::waitQueueLock.unlock();
+
+                pCpuCore->notifyCpuCores(cpuCoresToNotify);
+            }
+    };
+
+    unsigned int futexAddr = ((unsigned int)pWord) & ~3u;
+
+    // Most words are written without anyone waiting on them, waitQueueLock is only taken if the bucket has waiters
+    memoryBarrier();
+    if(*(DoublyLinkedListElement<TaskDescriptor>* volatile*)getFutexBucket(futexAddr)==nullptr){
+        return;
+    }
+
+    WakeUpFutexWaiters wakeUpFutexWaiters(this, futexAddr);
+    interruptHandlerManager.withInterruptsDisabled(wakeUpFutexWaiters);
+}
+
+bool CpuCore::shouldPreemptCurrentTask(DoublyLinkedListElement<TaskDescriptor>* pWokenUpTask){
+    if(currentTask==nullptr || currentTask==&idleTask){
+        return true;
+    }
+
+    // A current task which isn't runnable anymore is about to give up the cpu anyway
+    if(currentTask==pWokenUpTask || currentTask->value.state!=TaskState::Runnable){
+        return false;
+    }
+
+    if(pWokenUpTask->value.priority!=currentTask->value.priority){
+        return pWokenUpTask->value.priority>currentTask->value.priority;
+    }
+
+    // The vruntime of the current task is only updated in pickNextTask, thus add the time it has been running since then
+    unsigned long long elapsed = readTimestampCounter()-lastTaskSwitchTimestamp;
+    if(elapsed>0xFFFFFFFF){
+        elapsed = 0xFFFFFFFF;
+    }
+    unsigned long long currentVruntime = currentTask->value.vruntime + ((elapsed*currentTask->value.inverseWeight) >> 16);
+
+    return pWokenUpTask->value.vruntime+WAKE_UP_PREEMPTION_GRANULARITY < currentVruntime;
+}
+
+void CpuCore::rescheduleIfRequested(){
+    if(rescheduleRequested){
+        preemptionRequested = true;
+        yield();
+    }
+}
+
+WaitQueue* CpuCore::getTimerTickWaitQueue(){
+    return &timerTickWaitQueue;
+}
+
+void CpuCore::addToTimerWheel(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    unsigned int wakeUpTick = pTaskElement->value.wakeUpTick;
+    unsigned int ticksLeft = wakeUpTick-timerWheelTicks;
+
+    WaitQueue* pSlot;
+    if((int)ticksLeft < 0){
+        // Deadline already passed, wake the task up at the next processed tick
+        pSlot = &timerWheelLevel0[timerWheelTicks & ((1 << TIMER_WHEEL_LEVEL0_BITS)-1)];
+    }
+    else if(ticksLeft < (1 << TIMER_WHEEL_LEVEL0_BITS)){
+        pSlot = &timerWheelLevel0[wakeUpTick & ((1 << TIMER_WHEEL_LEVEL0_BITS)-1)];
+    }
+    else{
+        for(unsigned int level=0; level<TIMER_WHEEL_NUM_LEVELS-1; level++){
+            unsigned int levelShift = TIMER_WHEEL_LEVEL0_BITS+level*TIMER_WHEEL_LEVEL_BITS;
+            unsigned int levelRange = 1 << (levelShift+TIMER_WHEEL_LEVEL_BITS);
+            if(ticksLeft < levelRange || level==TIMER_WHEEL_NUM_LEVELS-2){
+                // Tasks sleeping longer than the timer wheel can cover are put in the furthest slot, once this slot is
+                // cascaded they are added to the timer wheel again
+                if(ticksLeft >= levelRange){
+                    wakeUpTick = timerWheelTicks+levelRange-1;
+                }
+                pSlot = &timerWheelUpperLevels[level][(wakeUpTick >> levelShift) & ((1 << TIMER_WHEEL_LEVEL_BITS)-1)];
+                break;
+            }
+        }
+    }
+
+    addToWaitQueue(pTaskElement, pSlot);
+}
+
+void CpuCore::cascadeTimerWheelSlot(WaitQueue* pSlot){
+    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = pSlot->head;
+    pSlot->head = nullptr;
+    pSlot->tail = nullptr;
+
+    while(pTaskElement!=nullptr){
+        DoublyLinkedListElement<TaskDescriptor>* pNextTaskElement = pTaskElement->next;
+        addToTimerWheel(pTaskElement);
+        pTaskElement = pNextTaskElement;
+    }
+}
+
+void CpuCore::runTimerWheel(){
+    unsigned int level0Index = timerWheelTicks & ((1 << TIMER_WHEEL_LEVEL0_BITS)-1);
+
+    // Every time the first level wraps around, the tasks in the next slot of the second level are spread over the first 
+    // level, every time the second level wraps around the same happens for the third level, and so on
+    if(level0Index==0){
+        waitQueueLock.lock();
+        for(unsigned int level=0; level<TIMER_WHEEL_NUM_LEVELS-1; level++){
+            unsigned int levelIndex = (timerWheelTicks >> (TIMER_WHEEL_LEVEL0_BITS+level*TIMER_WHEEL_LEVEL_BITS)) & ((1 << TIMER_WHEEL_LEVEL_BITS)-1);
+            cascadeTimerWheelSlot(&timerWheelUpperLevels[level][levelIndex]);
+            if(levelIndex!=0){
+                break;
+            }
+        }
+        waitQueueLock.unlock();
+    }
+
+    timerWheelTicks++;
+
+    // Only this cpu core adds tasks to its timer wheel, so an empty slot can be skipped without taking waitQueueLock
+    if(!timerWheelLevel0[level0Index].isEmpty()){
+        wakeUpAll(&timerWheelLevel0[level0Index]);
+    }
+}
+
+unsigned int CpuCore::getTimerTicks(){
+    stopTicklessMode();
+    return timerTicks;
+}
+
+void CpuCore::processTimerTicks(unsigned int numTicks){
+    for(unsigned int i=0; i<numTicks; i++){
+        timerTicks++;
+        runTimerWheel();
+
+        timerTicksSinceCounterIncrement++;
+        if(timerTicksSinceCounterIncrement>=TIMER_TICK_FREQUENCY/TIMER_COUNTER_FREQUENCY){
+            timerTicksSinceCounterIncrement = 0;
+            timerCounter++;
+
+            wakeUpAll(&timerTickWaitQueue);
+        }
+    }
+
+    // remainingQuantumTicks is not reset if task switching was paused when the quantum ended, therefore don't let it wrap around
+    remainingQuantumTicks = (remainingQuantumTicks>numTicks) ? (remainingQuantumTicks-numTicks) : 0;
+
+    timerTicksTimestamp = readTimestampCounter();
+    if(currentTask!=nullptr){
+        updateKernelInfoPage(currentTask);
+    }
+}
+
+void CpuCore::updateKernelInfoPage(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    KernelInfoPage* pKernelInfoPage = pTaskElement->value.pKernelInfoPage;
+    if(pKernelInfoPage==nullptr){
+        return;
+    }
+
+    // Only the cpu core running the task writes its page, the task itself reads it with readKernelInfoPage which reads 
+    // again if the sequence was odd or changed in the meantime (x86 doesn't reorder stores, so only the compiler has 
+    // to be stopped from doing so)
+    // The page is read-only in the page directory of the task, CR0.WP is not set so the kernel can still write it there
+    unsigned int sequence = pKernelInfoPage->sequence;
+    pKernelInfoPage->sequence = sequence+1;
+    __asm__ __volatile__("" ::: "memory");
+    pKernelInfoPage->timerTicks = timerTicks;
+    pKernelInfoPage->timerCounter = timerCounter;
+    pKernelInfoPage->timestampCounter = timerTicksTimestamp;
+    __asm__ __volatile__("" ::: "memory");
+    pKernelInfoPage->sequence = sequence+2;
+}
+
+void CpuCore::startTicklessModeIfPossible(DoublyLinkedListElement<TaskDescriptor>* pRunningTask){
+    if(timer.isOneShotActive() || rescheduleRequested){
+        return;
+    }
+
+    if(pRunningTask==&idleTask){
+        if(runQueueBitmap!=0){
+            return;
+        }
+    }
+    else{
+        unsigned int priority = pRunningTask->value.priority;
+        if(runQueueBitmap!=(1u << priority) || runQueueRoots[priority]!=pRunningTask || pRunningTask->value.heapChild!=nullptr){
+            return;
+        }
+    }
+
+    unsigned int numTicks = timer.getMaxOneShotTicks();
+
+    if(!timerTickWaitQueue.isEmpty()){
+        unsigned int ticksUntilCounterIncrement = TIMER_TICK_FREQUENCY/TIMER_COUNTER_FREQUENCY-timerTicksSinceCounterIncrement;
+        if(ticksUntilCounterIncrement<numTicks){
+            numTicks = ticksUntilCounterIncrement;
+        }
+    }
+
+    // The timer interrupt should fire at the first tick which wakes up a sleeping task, or which cascades the upper levels 
+    // of the timer wheel since that might add tasks to the first level which need to be woken up sooner
+    for(unsigned int i=0; i<numTicks; i++){
+        unsigned int level0Index = (timerWheelTicks+i) & ((1 << TIMER_WHEEL_LEVEL0_BITS)-1);
+        if(!timerWheelLevel0[level0Index].isEmpty() || level0Index==0){
+            numTicks = i+1;
+            break;
+        }
+    }
+
+    // A single tick is what the periodic timer interrupt does anyway
+    if(numTicks<=1){
+        return;
+    }
+
+    timer.startOneShot(numTicks);
+}
+
+void CpuCore::stopTicklessMode(){
+    class StopTicklessMode : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+
+        public:
+            StopTicklessMode(CpuCore* pCpuCore)
+                :
+                pCpuCore(pCpuCore)
+            {}
+
+            void run() override{
+                if(pCpuCore->timer.isOneShotActive()){
+                    pCpuCore->processTimerTicks(pCpuCore->timer.cancelOneShot());
+                }
+            }
+    };
+
+    StopTicklessMode stopTicklessMode(this);
+    interruptHandlerManager.withInterruptsDisabled(stopTicklessMode);
+}
+
+void CpuCore::copyTimerTicks(CpuCore* pOtherCpuCore){
+    volatile unsigned int* pOtherTimerTicks = &pOtherCpuCore->timerTicks;
+
+    // Read again if the other cpu core processed a timer tick in the meantime
+    unsigned int otherTimerTicks;
+    do{
+        otherTimerTicks = *pOtherTimerTicks;
+        timerCounter = *((volatile unsigned int*)&pOtherCpuCore->timerCounter);
+        timerTicksSinceCounterIncrement = *((volatile unsigned int*)&pOtherCpuCore->timerTicksSinceCounterIncrement);
+    }while(otherTimerTicks!=*pOtherTimerTicks);
+
+    timerTicks = otherTimerTicks;
+    timerWheelTicks = otherTimerTicks+1;
+}
+
+WaitQueue::WaitQueue()
+    :
+    head(nullptr),
+    tail(nullptr)
+{}
+
+bool WaitQueue::isEmpty(){
+    return head==nullptr;
+}
+
+void CpuCore::startRunningTask(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    class AddToRunQueue : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+
+        public:
+            AddToRunQueue(CpuCore* pCpuCore, DoublyLinkedListElement<TaskDescriptor>* pTaskElement)
+                :
+                pCpuCore(pCpuCore),
+                pTaskElement(pTaskElement)
+            {}
+
+            void run() override{
+                // Kernel tasks (like the network management task) stay on the cpu core chosen for them
+                CpuCore* pTaskCpuCore = pTaskElement->value.canMigrate ? CpuCore::getLeastLoadedCpuCore() : pTaskElement->value.pCpuCore;
+
+                pTaskCpuCore->runQueueLock.lock();
+                pTaskElement->value.pCpuCore = pTaskCpuCore;
+                pTaskCpuCore->addToRunQueue(pTaskElement);
+                pTaskCpuCore->runQueueLock.unlock();
+
+                pCpuCore->notifyCpuCores(1 << pTaskCpuCore->cpuCoreId);
+            }
+    };
+
+    // Need to be carefull the run queues don't get ruined while a task switch occurs!
+    AddToRunQueue addToRunQueue(this, pTaskElement);
+    interruptHandlerManager.withInterruptsDisabled(addToRunQueue);
+}
+
+void CpuCore::stopRunningTask(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    class RemoveFromQueue : public Runnable{
+        private:
+            CpuCore* pCpuCore;
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+
+        public:
+            // Cpu core which was still running the task
+            CpuCore* pRunningCpuCore;
+
+            RemoveFromQueue(CpuCore* pCpuCore, DoublyLinkedListElement<TaskDescriptor>* pTaskElement)
+                :
+                pCpuCore(pCpuCore),
+                pTaskElement(pTaskElement),
+                pRunningCpuCore(nullptr)
+            {}
+
+            void run() override{
+                CpuCore::waitQueueLock.lock();
+                CpuCore* pTaskCpuCore = CpuCore::lockTaskCpuCore(pTaskElement);
+
+                // A blocked task is in a wait queue instead of a run queue, a crashed task is in neither
+                if(pTaskElement->value.state==TaskState::Blocked){
+                    pCpuCore->removeFromWaitQueue(pTaskElement);
+                }
+                else if(pTaskElement->value.state==TaskState::Runnable){
+                    pTaskCpuCore->removeFromRunQueue(pTaskElement);
+                }
+
+                // A task in futexWait is also in a futex bucket, even if it already timed out and is runnable again
+                if(pTaskElement->value.futexAddr!=0){
+                    CpuCore::removeFromFutexBucket(pTaskElement);
+                }
+                pTaskElement->value.state = TaskState::Stopped;
+
+                // The FPU state of a stopped task doesn't need to be saved anymore
+                if(pTaskCpuCore->fpuOwner==pTaskElement){
+                    pTaskCpuCore->fpuOwner = nullptr;
+                }
+
+                // A task can't stop itself, thus the task is only still running if it runs on another cpu core
+                pRunningCpuCore = nullptr;
+                if(pTaskCpuCore->currentTask==pTaskElement){
+                    pTaskCpuCore->rescheduleRequested = true;
+                    pRunningCpuCore = pTaskCpuCore;
+                }
+
+                pTaskCpuCore->runQueueLock.unlock();
+                CpuCore::waitQueueLock.unlock();
+
+                if(pRunningCpuCore!=nullptr){
+                    pCpuCore->sendRescheduleIpi(pRunningCpuCore);
+                }
+            }
+    };
+
+    // Need to be carefull the run queues don't get ruined while a task switch occurs!
+    RemoveFromQueue removeFromQueue(this, pTaskElement);
+    interruptHandlerManager.withInterruptsDisabled(removeFromQueue);
+
+    // The other cpu core might still be saving the state of the task
+    if(removeFromQueue.pRunningCpuCore!=nullptr){
+        removeFromQueue.pRunningCpuCore->waitUntilNotCurrentTask(pTaskElement);
+    }
+
+    freeTaskDescriptor(pTaskElement);
+}
+
+DoublyLinkedListElement<TaskDescriptor>* CpuCore::allocateTaskDescriptor(){
+    for(unsigned int i=0; i<NUM_POSSIBLE_TASKS; i++){
+        if(taskDescriptors[i]==nullptr){
+            unsigned char* pMemory = taskDescriptorAllocator.allocate();
+            if(pMemory==nullptr) return nullptr;
+
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement = new(pMemory) DoublyLinkedListElement<TaskDescriptor>();
+            pTaskElement->value.taskID = (unsigned short)i;
+            taskDescriptors[i] = pTaskElement;
+            return pTaskElement;
+        }
+    }
+    return nullptr;
+}
+
+void CpuCore::crashCurrentTask(unsigned int exceptionNumber, unsigned int faultAddress, unsigned int eip){
+    DoublyLinkedListElement<TaskDescriptor>* pTaskElement = currentTask;
+
+    // There is nothing better to do for kernel tasks than to keep running them
+    if(pTaskElement==nullptr || pTaskElement==&idleTask || pTaskElement->value.pTask->isKernelTask()){
+        return;
+    }
+
+    #if E2E_TESTING
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    pSerialLog->log((char*)"Task crashed: ");
+    pSerialLog->log(pTaskElement->value.taskID);
+    pSerialLog->log((char*)"\n");
+    #endif
+
+    // Interrupts are disabled in exception handlers, the task might be stopped by another cpu core at the same time
+    runQueueLock.lock();
+    bool isStopped = (pTaskElement->value.state==TaskState::Stopped);
+    if(!isStopped){
+        removeFromRunQueue(pTaskElement);
+        pTaskElement->value.state = TaskState::Crashed;
+        pTaskElement->value.crashInfo.hasCrashed = true;
+        pTaskElement->value.crashInfo.exceptionNumber = exceptionNumber;
+        pTaskElement->value.crashInfo.faultAddress = faultAddress;
+        pTaskElement->value.crashInfo.eip = eip;
+    }
+
+    if(fpuOwner==pTaskElement){
+        fpuOwner = nullptr;
+    }
+    runQueueLock.unlock();
+
+    // A stopped task gets its sockets closed by the task stopping it
+    if(!isStopped){
+        pSocketManager->closeAllSocketsForTask(pTaskElement->value.taskID);
+    }
+
+    while(true){
+        yield();
+
+        // yield only returns immediately if task switching is paused, in that case just wait for an interrupt
+        __asm__ __volatile__("sti; hlt; cli" ::: "memory");
+    }
+}
+
+void CpuCore::freeTaskDescriptor(DoublyLinkedListElement<TaskDescriptor>* pTaskElement){
+    taskDescriptors[pTaskElement->value.taskID] = nullptr;
+    taskDescriptorAllocator.free(pTaskElement);
+}
+
+bool CpuCore::createSocketTable(unsigned short taskID){
+    class CreateSocketTable : public Runnable{
+        private:
+            SocketManager* pSocketManager;
+            unsigned short taskID;
+
+        public:
+            bool success;
+
+            CreateSocketTable(SocketManager* pSocketManager, unsigned short taskID)
+                :
+                pSocketManager(pSocketManager),
+                taskID(taskID),
+                success(false)
+            {}
+
+            void run() override{
+                success = pSocketManager->createSocketTable(taskID);
+            }
+    };
+
+    CreateSocketTable createSocketTable(pSocketManager, taskID);
+    interruptHandlerManager.withInterruptsDisabled(createSocketTable);
+
+    return createSocketTable.success;
+}
+
+void CpuCore::closeAllSocketsForTask(unsigned short taskID){
+    class CloseAllSockets : public Runnable{
+        private:
+            SocketManager* pSocketManager;
+            unsigned short taskID;
+
+        public:
+            CloseAllSockets(SocketManager* pSocketManager, unsigned short taskID)
+                :
+                pSocketManager(pSocketManager),
+                taskID(taskID)
+            {}
+
+            void run() override{
+                pSocketManager->closeAllSocketsForTask(taskID);
+            }
+    };
+
+    CloseAllSockets closeAllSockets(pSocketManager, taskID);
+    interruptHandlerManager.withInterruptsDisabled(closeAllSockets);
+}
+
+Task::Task(CpuCore* pCpuCore, unsigned int priority)
+    :
+    pCpuCore(pCpuCore),
+    taskID(-1),
+    isRunning(false),
+    priority(priority),
+    weight(DEFAULT_TASK_WEIGHT),
+    quantum(DEFAULT_TASK_QUANTUM)
+{}
+
+int Task::getTaskID(){
+    return taskID;
+}
+
+bool Task::getRunningState(){
+    return isRunning;
+}
+
+unsigned int Task::getPriority(){
+    return priority;
+}
+
+bool Task::setPriority(unsigned int newPriority){
+    if(newPriority>=NUM_TASK_PRIORITIES) return false;
+
+    if(!isRunning){
+        priority = newPriority;
+        return true;
+    }
+
+    class ChangeRunQueue : public Runnable{
+        private:
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+            unsigned int newPriority;
+
+        public:
+            ChangeRunQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement, unsigned int newPriority)
+                :
+                pTaskElement(pTaskElement),
+                newPriority(newPriority)
+            {}
+
+            void run() override{
+                // The task might be running on another cpu core
+                CpuCore* pTaskCpuCore = CpuCore::lockTaskCpuCore(pTaskElement);
+
+                // A blocked task will be added to the correct run queue once it is woken up, a crashed task is never 
+                // added to a run queue again
+                // The vruntime of the task is reset, addToRunQueue will make sure it starts with the minimum vruntime 
+                // of the new run queue
+                if(pTaskElement->value.state!=TaskState::Runnable){
+                    pTaskElement->value.priority = newPriority;
+                    pTaskElement->value.vruntime = 0;
+                }
+                else{
+                    pTaskCpuCore->removeFromRunQueue(pTaskElement);
+                    pTaskElement->value.priority = newPriority;
+                    pTaskElement->value.vruntime = 0;
+                    pTaskCpuCore->addToRunQueue(pTaskElement);
+                }
+
+                pTaskCpuCore->runQueueLock.unlock();
+            }
+    };
+
+    // Need to be carefull the run queues don't get ruined while a task switch occurs!
+    ChangeRunQueue changeRunQueue(pCpuCore->taskDescriptors[taskID], newPriority);
+    pCpuCore->interruptHandlerManager.withInterruptsDisabled(changeRunQueue);
+    priority = newPriority;
+
+    return true;
+}
+
+unsigned int Task::getWeight(){
+    return weight;
+}
+
+bool Task::setWeight(unsigned int newWeight){
+    if(newWeight==0 || newWeight>MAX_TASK_WEIGHT) return false;
+
+    if(!isRunning){
+        weight = newWeight;
+        return true;
+    }
+
+    class ChangeWeight : public Runnable{
+        private:
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+            unsigned int newWeight;
+
+        public:
+            ChangeWeight(DoublyLinkedListElement<TaskDescriptor>* pTaskElement, unsigned int newWeight)
+                :
+                pTaskElement(pTaskElement),
+                newWeight(newWeight)
+            {}
+
+            void run() override{
+                // The weight only influences how fast vruntime grows, so the task can stay in its run queue
+                CpuCore* pTaskCpuCore = CpuCore::lockTaskCpuCore(pTaskElement);
+                pTaskElement->value.weight = newWeight;
+                pTaskElement->value.inverseWeight = (1 << 26)/newWeight;
+                pTaskCpuCore->runQueueLock.unlock();
+            }
+    };
+
+    // Need to be carefull the weight isn't changed halfway through a task switch!
+    ChangeWeight changeWeight(pCpuCore->taskDescriptors[taskID], newWeight);
+    pCpuCore->interruptHandlerManager.withInterruptsDisabled(changeWeight);
+    weight = newWeight;
+
+    return true;
+}
+
+unsigned int Task::getQuantum(){
+    return quantum;
+}
+
+bool Task::setQuantum(unsigned int newQuantum){
+    if(newQuantum==0 || newQuantum>MAX_TASK_QUANTUM) return false;
+
+    if(isRunning){
+        // Writing a single unsigned int is atomic, no need to disable interrupts
+        atomicStore(&pCpuCore->taskDescriptors[taskID]->value.quantum, newQuantum);
+    }
+    quantum = newQuantum;
+
+    return true;
+}
+
+TaskStatistics Task::getStatistics(){
+    if(!isRunning){
+        return TaskStatistics();
+    }
+
+    class ReadStatistics : public Runnable{
+        private:
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+            TaskStatistics* pStatistics;
+
+        public:
+            ReadStatistics(DoublyLinkedListElement<TaskDescriptor>* pTaskElement, TaskStatistics* pStatistics)
+                :
+                pTaskElement(pTaskElement),
+                pStatistics(pStatistics)
+            {}
+
+            void run() override{
+                CpuCore* pTaskCpuCore = CpuCore::lockTaskCpuCore(pTaskElement);
+                *pStatistics = pTaskElement->value.statistics;
+                pTaskCpuCore->runQueueLock.unlock();
+            }
+    };
+
+    // runtimeCycles is 64-bit and can't be read atomically, the task might be running on another cpu core
+    TaskStatistics statistics;
+    ReadStatistics readStatistics(pCpuCore->taskDescriptors[taskID], &statistics);
+    pCpuCore->interruptHandlerManager.withInterruptsDisabled(readStatistics);
+
+    return statistics;
+}
+
+TaskCrashInfo Task::getCrashInfo(){
+    if(!isRunning){
+        return TaskCrashInfo();
+    }
+
+    class ReadCrashInfo : public Runnable{
+        private:
+            DoublyLinkedListElement<TaskDescriptor>* pTaskElement;
+            TaskCrashInfo* pCrashInfo;
+
+        public:
+            ReadCrashInfo(DoublyLinkedListElement<TaskDescriptor>* pTaskElement, TaskCrashInfo* pCrashInfo)
+                :
+                pTaskElement(pTaskElement),
+                pCrashInfo(pCrashInfo)
+            {}
+
+            void run() override{
+                CpuCore* pTaskCpuCore = CpuCore::lockTaskCpuCore(pTaskElement);
+                *pCrashInfo = pTaskElement->value.crashInfo;
+                pTaskCpuCore->runQueueLock.unlock();
+            }
+    };
+
+    // Make sure the crash info isn't read while the task is crashing
+    TaskCrashInfo crashInfo;
+    ReadCrashInfo readCrashInfo(pCpuCore->taskDescriptors[taskID], &crashInfo);
+    pCpuCore->interruptHandlerManager.withInterruptsDisabled(readCrashInfo);
+
+    return crashInfo;
+}
+
+CpuCore::UserTask::UserTask(CpuCore* pCpuCore, unsigned int taskSpaceBeginVirtualAddr)
+    :
+    Task(pCpuCore, DEFAULT_USER_TASK_PRIORITY),
+    taskSpaceBeginVirtualAddr(taskSpaceBeginVirtualAddr)
+{
+    pTask8MBRegion = 0;
+
+    if(pCpuCore->isRunning 
+        && pCpuCore->currentPagingStructure.getPageDirectoryPhysicalAddr()==pCpuCore->kernelPageDirectoryPhysicalAddr
+        && (taskSpaceBeginVirtualAddr % (4096*1024))==0){
+        pTask8MBRegion = pCpuCore->pKernelPageAlloctor->allocateContiguousPages(1024*2);
+    }
+
+    if(pTask8MBRegion!=0){
+        // taskSpaceBeginVirtualAddr should be 4MB alligned, a.k.a a multiple of 1024*4096
+        unsigned int taskFirstPdeIndex = taskSpaceBeginVirtualAddr/(1024*4096);
+        unsigned int taskSecondPdeIndex = taskFirstPdeIndex+1;
+        // pTaskRegion should be page alligned, a.k.a a multiple of 4096
+        unsigned int taskRegionPageIndex = (pTask8MBRegion)/4096;
+
+        unsigned int currentPage = pTask8MBRegion;
+
+        // First create a page directory which is exactly the same as the kernel page directory
+        // Allocated at the begin of the 8MB region
+        pTaskPageDirectory = new((unsigned char*)currentPage) PageDirectory();
+        for(int i=0; i<1023; i++){
+            PDE pde = pCpuCore->currentPagingStructure.getPDE(i);
             if(pde.pdeIsValid){
                 PDE taskPde = {pde.pageTablePhysicalAddr, pde.kernelPrivilegeOnly, true};
                 pTaskPageDirectory->changePDE(i, taskPde);
@@ -507,10 +2549,11 @@ CpuCore::UserTask::UserTask(CpuCore* pCpuCore, unsigned int taskSpaceBeginVirtua
         // Create a page table for the second 4MB of the 8MB region
         currentPage += sizeof(PageTable);
         PageTable* taskPageTable2 = new((unsigned char*)currentPage) PageTable();
-        // All of the pages are for the user space
+        // All of the pages are for the user space, the last page is the kernel info page which the task can only read
         for(int i=0; i<1024; i++){
             PTE pte = pCpuCore->currentPagingStructure.getPTE((taskRegionPageIndex+(i+1024))/1024, (taskRegionPageIndex+(i+1024)) % 1024);
             PTE taskPTE = {pte.pagePhysicalAddr, false, true};
+            taskPTE.isReadOnly = (i==1023);
             taskPageTable2->changePTE(i, taskPTE);
         }
         taskPde = {taskPageTable2->getPhysicalAddr(), false, true};
@@ -519,31 +2562,23 @@ CpuCore::UserTask::UserTask(CpuCore* pCpuCore, unsigned int taskSpaceBeginVirtua
         currentPage += sizeof(PageTable);
         currentPage += KERNEL_STACK_SIZE;
         currentPage += USER_STACK_SIZE;
+
+        KernelInfoPage* pKernelInfoPage = new((unsigned char*)(pTask8MBRegion+USER_TASK_KERNEL_INFO_PAGE_OFFSET)) KernelInfoPage();
+        pKernelInfoPage->timestampCounterToNsMultiplier = Timer::getTimestampCounterToNsMultiplier();
+        pKernelInfoPage->timestampCounterToNsShift = TIMESTAMP_COUNTER_TO_NS_SHIFT;
     }
 }
 
 CpuCore::UserTask::~UserTask(){
     if(isRunning){
-        // Remove the task from the active task list
-        DoublyLinkedListElement<TaskDescriptor>* thisTask = &pCpuCore->taskDescriptorListElements[taskID];
-
-        if(thisTask->prev!=nullptr){
-            atomicStore((unsigned int*)&thisTask->prev->next, (unsigned int)thisTask->next);
-        }
-        else{
-            atomicStore((unsigned int*)&pCpuCore->activeTasksListHead, (unsigned int)thisTask->next);
-        }
-        if(thisTask->next!=nullptr){
-            thisTask->next->prev = thisTask->prev;
-        }
-
-        thisTask->next = pCpuCore->unusedtaskDescriptorElementsListHead;
-        pCpuCore->unusedtaskDescriptorElementsListHead = thisTask;
+        // Remove the task from its run queue
+        DoublyLinkedListElement<TaskDescriptor>* thisTask = pCpuCore->taskDescriptors[taskID];
+        pCpuCore->stopRunningTask(thisTask);
     }
 
     if(taskID != -1){
         // Close all sockets that are open for this task
-        pCpuCore->pSocketManager->closeAllSocketsForTask((unsigned char)taskID);
+        pCpuCore->closeAllSocketsForTask((unsigned short)taskID);
     }
 
     if(pTask8MBRegion!=0){
@@ -557,28 +2592,42 @@ SetToRunningStateResponse CpuCore::UserTask::setToRunningState(){
 
     if(pTask8MBRegion==0) return SetToRunningStateResponse::TASK_NOT_PROPERLY_INITIALIZED;
 
-    DoublyLinkedListElement<TaskDescriptor>* newTask = pCpuCore->unusedtaskDescriptorElementsListHead;
+    DoublyLinkedListElement<TaskDescriptor>* newTask = pCpuCore->allocateTaskDescriptor();
 
     if(newTask==nullptr) return SetToRunningStateResponse::TOO_MANY_TASKS;
-    pCpuCore->unusedtaskDescriptorElementsListHead = newTask->next;
+
+    // Sockets of the task are stored in a socket table which is allocated the first time its task ID is used
+    if(!pCpuCore->createSocketTable(newTask->value.taskID)){
+        pCpuCore->freeTaskDescriptor(newTask);
+        return SetToRunningStateResponse::TOO_MANY_TASKS;
+    }
 
     newTask->value.pTask = this;
+    // The kernel page directory is loaded here, which maps the 8MB region at its physical address
+    ((KernelInfoPage*)(pTask8MBRegion+USER_TASK_KERNEL_INFO_PAGE_OFFSET))->taskID = newTask->value.taskID;
+    newTask->value.pKernelInfoPage = (KernelInfoPage*)(taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_INFO_PAGE_OFFSET);
     // taskList[newTaskId].taskEsp must be the virtual address
     newTask->value.taskEsp = (updatedKernelStack-pTask8MBRegion)+taskSpaceBeginVirtualAddr;
     // taskList[newTaskId].kernelEspStackBegin must be the virtual address
     newTask->value.kernelEspStackBegin = taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_STACK_OFFSET;
     newTask->value.pageDirectoryPhysicalAddr = pTaskPageDirectory->getPhysicalAddr();
 
-    taskID = (newTask-pCpuCore->taskDescriptorListElements);
+    newTask->value.priority = priority;
+    newTask->value.state = TaskState::Runnable;
+    newTask->value.pWaitQueue = nullptr;
+    newTask->value.vruntime = 0;
+    newTask->value.weight = weight;
+    newTask->value.inverseWeight = (1 << 26)/weight;
+    newTask->value.quantum = quantum;
+    newTask->value.fpuStateValid = false;
+    newTask->value.statistics = TaskStatistics();
+    // The page directory and kernel stack of a user task are the same on every cpu core
+    newTask->value.canMigrate = true;
+
+    taskID = newTask->value.taskID;
     isRunning = true;
 
-    newTask->next = pCpuCore->activeTasksListHead;
-    newTask->prev = nullptr;
-    if(pCpuCore->activeTasksListHead!=nullptr){
-        pCpuCore->activeTasksListHead->prev = newTask;
-    }
-    // Need to be carefull the task list doesn't get ruined while a task switch occurs!
-    atomicStore((unsigned int*)&pCpuCore->activeTasksListHead, (unsigned int)newTask);
+    pCpuCore->startRunningTask(newTask);
 
     return SetToRunningStateResponse::SUCCESS;
 }
@@ -588,7 +2637,7 @@ bool CpuCore::UserTask::isKernelTask(){
 }
 
 Pair<bool, unsigned int> CpuCore::UserTask::convertContigUserAddrBlockToContigKernelAddrBlock(unsigned int userAddr, unsigned int numBytes){
-    if(userAddr<taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_STACK_OFFSET+4 || userAddr+numBytes>taskSpaceBeginVirtualAddr+0x800000){
+    if(userAddr<taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_STACK_OFFSET+4 || userAddr+numBytes>taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_INFO_PAGE_OFFSET){
         return {false, 0};
     }
 
@@ -596,7 +2645,7 @@ Pair<bool, unsigned int> CpuCore::UserTask::convertContigUserAddrBlockToContigKe
 }
 
 bool CpuCore::UserTask::addrSpaceIsUserAccessible(unsigned int userAddr, unsigned int numBytes){
-    if(userAddr<taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_STACK_OFFSET+4 || userAddr+numBytes>taskSpaceBeginVirtualAddr+0x800000){
+    if(userAddr<taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_STACK_OFFSET+4 || userAddr+numBytes>taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_INFO_PAGE_OFFSET){
         return false;
     }
 
@@ -621,7 +2670,7 @@ void CpuCore::UserTask::setTaskArguments(TaskArguments& taskArgs){
 }
 
 bool CpuCore::UserTask::setData(unsigned int userAddr, unsigned char* data, unsigned int numBytes){
-    if(userAddr<taskSpaceBeginVirtualAddr+USER_TASK_PROCESS_ENTRY_OFFSET || userAddr+numBytes>taskSpaceBeginVirtualAddr+0x800000){
+    if(userAddr<taskSpaceBeginVirtualAddr+USER_TASK_PROCESS_ENTRY_OFFSET || userAddr+numBytes>taskSpaceBeginVirtualAddr+USER_TASK_KERNEL_INFO_PAGE_OFFSET){
         return false;
     }
 
@@ -633,7 +2682,8 @@ bool CpuCore::UserTask::setData(unsigned int userAddr, unsigned char* data, unsi
 
 CpuCore::KernelTask::KernelTask(CpuCore* pCpuCore)
     :
-    Task(pCpuCore)
+    Task(pCpuCore, DEFAULT_KERNEL_TASK_PRIORITY),
+    pRunningCpuCore(pCpuCore)
 {
     kernelStackSpaceBegin = 0;
     if(!pCpuCore->isRunning || pCpuCore->currentPagingStructure.getPageDirectoryPhysicalAddr()==pCpuCore->kernelPageDirectoryPhysicalAddr){
@@ -643,26 +2693,14 @@ CpuCore::KernelTask::KernelTask(CpuCore* pCpuCore)
 
 CpuCore::KernelTask::~KernelTask(){
     if(isRunning){
-        // Remove the task from the active task list
-        DoublyLinkedListElement<TaskDescriptor>* thisTask = &pCpuCore->taskDescriptorListElements[taskID];
-
-        if(thisTask->prev!=nullptr){
-            atomicStore((unsigned int*)&thisTask->prev->next, (unsigned int)thisTask->next);
-        }
-        else{
-            atomicStore((unsigned int*)&pCpuCore->activeTasksListHead, (unsigned int)thisTask->next);
-        }
-        if(thisTask->next!=nullptr){
-            thisTask->next->prev = thisTask->prev;
-        }
-
-        thisTask->next = pCpuCore->unusedtaskDescriptorElementsListHead;
-        pCpuCore->unusedtaskDescriptorElementsListHead = thisTask;
+        // Remove the task from its run queue
+        DoublyLinkedListElement<TaskDescriptor>* thisTask = pCpuCore->taskDescriptors[taskID];
+        pCpuCore->stopRunningTask(thisTask);
     }
 
     if(taskID != -1){
         // Close all sockets that are open for this task
-        pCpuCore->pSocketManager->closeAllSocketsForTask((unsigned char)taskID);
+        pCpuCore->closeAllSocketsForTask((unsigned short)taskID);
     }
 
     if(kernelStackSpaceBegin!=0){
@@ -676,10 +2714,15 @@ SetToRunningStateResponse CpuCore::KernelTask::setToRunningState(){
 
     if(kernelStackSpaceBegin==0) return SetToRunningStateResponse::TASK_NOT_PROPERLY_INITIALIZED;
 
-    DoublyLinkedListElement<TaskDescriptor>* newTask = pCpuCore->unusedtaskDescriptorElementsListHead;
+    DoublyLinkedListElement<TaskDescriptor>* newTask = pCpuCore->allocateTaskDescriptor();
 
     if(newTask==nullptr) return SetToRunningStateResponse::TOO_MANY_TASKS;
-    pCpuCore->unusedtaskDescriptorElementsListHead = newTask->next;
+
+    // Sockets of the task are stored in a socket table which is allocated the first time its task ID is used
+    if(!pCpuCore->createSocketTable(newTask->value.taskID)){
+        pCpuCore->freeTaskDescriptor(newTask);
+        return SetToRunningStateResponse::TOO_MANY_TASKS;
+    }
 
     newTask->value.pTask = this;
     // For kernel tasks, taskEsp virtual addr is the same as the kernel virtual addr
@@ -688,16 +2731,24 @@ SetToRunningStateResponse CpuCore::KernelTask::setToRunningState(){
     newTask->value.kernelEspStackBegin = kernelStackSpaceBegin+KERNEL_STACK_SIZE-4;
     newTask->value.pageDirectoryPhysicalAddr = pCpuCore->currentPagingStructure.getPageDirectoryPhysicalAddr();
 
-    taskID = (newTask-pCpuCore->taskDescriptorListElements);
+    newTask->value.priority = priority;
+    newTask->value.state = TaskState::Runnable;
+    newTask->value.pWaitQueue = nullptr;
+    newTask->value.vruntime = 0;
+    newTask->value.weight = weight;
+    newTask->value.inverseWeight = (1 << 26)/weight;
+    newTask->value.quantum = quantum;
+    newTask->value.fpuStateValid = false;
+    newTask->value.statistics = TaskStatistics();
+    // Kernel tasks might depend on running on a specific cpu core (e.g. the network management task handles the network
+    // card interrupts which are only sent to its cpu core)
+    newTask->value.pCpuCore = pRunningCpuCore;
+    newTask->value.canMigrate = false;
+
+    taskID = newTask->value.taskID;
     isRunning = true;
-    
-    newTask->next = pCpuCore->activeTasksListHead;
-    newTask->prev = nullptr;
-    if(pCpuCore->activeTasksListHead!=nullptr){
-        pCpuCore->activeTasksListHead->prev = newTask;
-    }
-    // Need to be carefull the task list doesn't get ruined while a task switch occurs!
-    atomicStore((unsigned int*)&pCpuCore->activeTasksListHead, (unsigned int)newTask);
+
+    pCpuCore->startRunningTask(newTask);
 
     return SetToRunningStateResponse::SUCCESS;
 }
@@ -706,6 +2757,12 @@ bool CpuCore::KernelTask::isKernelTask(){
     return true;
 }
 
+void CpuCore::KernelTask::setRunningCpuCore(CpuCore* pNewRunningCpuCore){
+    if(isRunning || pNewRunningCpuCore==nullptr || !pNewRunningCpuCore->isRunning) return;
+
+    pRunningCpuCore = pNewRunningCpuCore;
+}
+
 void CpuCore::KernelTask::setProcessCode(unsigned int* processCode, TaskArguments& taskArgs){
     if(taskArgs.numArgs > MAX_TASK_ARGS) return;
 
@@ -726,7 +2783,40 @@ CpuCore::TimerCallback::TimerCallback(CpuCore* pCpuCore)
 {}
 
 void CpuCore::TimerCallback::run(){
-    pCpuCore->timerCounter++;
+    pCpuCore->taskSwitchStatistics.numTimerInterrupts++;
 
-    yield();
+    // More than one timer tick has passed if the interrupt ended tickless mode
+    pCpuCore->processTimerTicks(pCpuCore->timer.getElapsedTicks());
+
+    // Other cpu cores can add tasks to the run queues of this cpu core
+    pCpuCore->runQueueLock.lock();
+
+    // Besides when the quantum of the current task has ended, also switch when a task became runnable which should 
+    // run instead of the current task (e.g. a higher priority task was woken up)
+    DoublyLinkedListElement<TaskDescriptor>* currentTask = pCpuCore->currentTask;
+    bool higherPriorityTaskRunnable;
+    if(currentTask==nullptr || currentTask==&pCpuCore->idleTask){
+        higherPriorityTaskRunnable = (pCpuCore->runQueueBitmap!=0);
+    }
+    else{
+        higherPriorityTaskRunnable = ((pCpuCore->runQueueBitmap >> currentTask->value.priority) > 1);
+    }
+
+    bool preempt = (pCpuCore->remainingQuantumTicks==0 || higherPriorityTaskRunnable || pCpuCore->rescheduleRequested);
+    // Once a quantum ends, tasks are waiting on this cpu core which an idle cpu core could run instead
+    bool tasksAreWaiting = (pCpuCore->remainingQuantumTicks==0 && pCpuCore->numRunnableTasks>1 && pCpuCore->numMigratableTasks>0);
+    if(!preempt && currentTask!=nullptr){
+        pCpuCore->startTicklessModeIfPossible(currentTask);
+    }
+
+    pCpuCore->runQueueLock.unlock();
+
+    if(tasksAreWaiting){
+        pCpuCore->wakeUpIdleCpuCore();
+    }
+
+    if(preempt){
+        pCpuCore->preemptionRequested = true;
+        yield();
+    }
 }
\ No newline at end of file
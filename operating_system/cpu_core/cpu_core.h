@@ -3,21 +3,37 @@
 #include "interrupt_handler_manager.h"
 #include "current_paging_structure.h"
 #include "tss.h"
+#include "gdt.h"
+#include "lapic.h"
 
 #include "../paging/page_allocator.h"
+#include "../paging/slab_allocator.h"
 
 #include "../../cpp_lib/pair.h"
 #include "../../cpp_lib/list.h"
 #include "timer.h"
 #include "../../cpp_lib/syscalls.h"
+#include "../../cpp_lib/memory_manager.h"
+#include "../../cpp_lib/atomic.h"
 
+// Maximum number of tasks which can be running at the same time, task IDs go from 0 to NUM_POSSIBLE_TASKS-1 and
+// should fit in an unsigned short
+// Task descriptors are allocated in slabs of TASK_DESCRIPTOR_SLAB_NUM_PAGES pages when needed
 #if E2E_TESTING
 #define NUM_POSSIBLE_TASKS (5+2)
 #else
-#define NUM_POSSIBLE_TASKS 50
+#define NUM_POSSIBLE_TASKS 1024
 #endif
+#define TASK_DESCRIPTOR_SLAB_NUM_PAGES 16
 #define MAX_TASK_ARGS 5
-#define NUM_CPU_CORES 1
+// Cores listed in the ACPI tables beyond NUM_CPU_CORES are not started
+// Every cpu core has its own run queues, new user tasks are started on the cpu core with the least runnable tasks and a
+// cpu core which has nothing to run steals a waiting task from the busiest cpu core
+#define NUM_CPU_CORES 4
+
+// Application processors start executing ap_trampoline_assembly.asm after it is copied to this address (should be page
+// aligned, below 1MB and the same as in ap_trampoline_assembly.asm)
+#define AP_TRAMPOLINE_ADDR 0x20000
 
 #define TASK_SWITCH_STACK_SIZE 1000
 
@@ -28,8 +44,51 @@
 #define USER_TASK_KERNEL_STACK_OFFSET (sizeof(PageDirectory)+2*sizeof(PageTable)+KERNEL_STACK_SIZE-4)
 #define USER_TASK_USER_STACK_OFFSET (sizeof(PageDirectory)+2*sizeof(PageTable)+KERNEL_STACK_SIZE+USER_STACK_SIZE-4)
 #define USER_TASK_PROCESS_ENTRY_OFFSET (sizeof(PageDirectory)+2*sizeof(PageTable)+KERNEL_STACK_SIZE+USER_STACK_SIZE)
-
-#define TASK_SWITCHING_FREQUENCY 20
+// The last page of the 8MB region of a user task is its kernel info page, the task can read it but not write it
+#define USER_TASK_KERNEL_INFO_PAGE_OFFSET (0x800000-0x1000)
+
+// User tasks created by the TaskManager start at this virtual address (tasks are linked for it)
+#define VIRTUAL_TASK_SPACE_BEGIN_ADDR 0x2000000
+
+// The timer interrupt fires TIMER_TICK_FREQUENCY times per second, a task is preempted once it has been running for
+// its quantum (in timer ticks), the timer counter returned by getTimerCounter is still incremented TIMER_COUNTER_FREQUENCY
+// times per second
+// When at most one task is runnable there is nothing to preempt, the timer interrupts are then stopped until the next
+// timer tick at which something has to happen (tickless mode)
+#define TIMER_TICK_FREQUENCY 1000
+#define TIMER_COUNTER_FREQUENCY 20
+#define DEFAULT_TASK_QUANTUM 50
+#define MAX_TASK_QUANTUM 1000
+
+// Sleeping tasks are kept in a hierarchical timer wheel, the first level has a slot per timer tick for the next 
+// 2^TIMER_WHEEL_LEVEL0_BITS ticks and every next level has 2^TIMER_WHEEL_LEVEL_BITS slots which each cover all slots of
+// the previous level, thus tasks can sleep up to 2^(TIMER_WHEEL_LEVEL0_BITS+(TIMER_WHEEL_NUM_LEVELS-1)*TIMER_WHEEL_LEVEL_BITS)
+// ticks before they have to be moved to the last level again
+#define TIMER_WHEEL_LEVEL0_BITS 8
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_NUM_LEVELS 4
+
+// Tasks waiting in futexWait are kept in NUM_FUTEX_BUCKETS lists (should be a power of 2), the bucket of a task is chosen 
+// by the kernel address of the word it waits on
+#define NUM_FUTEX_BUCKETS 64
+
+// Size of the FPU/SSE state saved by the FXSAVE instruction
+#define FPU_STATE_SIZE 512
+
+// Priorities go from 0 (lowest) to NUM_TASK_PRIORITIES-1 (highest), there is one run queue per priority
+// NUM_TASK_PRIORITIES can't be bigger than 32 because the non-empty run queues are tracked in a 32-bit bitmap
+#define NUM_TASK_PRIORITIES 8
+#define DEFAULT_USER_TASK_PRIORITY 2
+#define DEFAULT_KERNEL_TASK_PRIORITY 6
+
+// Tasks with the same priority share the cpu proportional to their weight, a task with weight 2048 will get
+// twice as much cpu time as a task with weight 1024
+#define DEFAULT_TASK_WEIGHT 1024
+#define MAX_TASK_WEIGHT 65536
+
+// A woken up task with the same priority as the current task only preempts the current task if its vruntime is at least
+// this much smaller, otherwise tasks which keep waking each other up would be switching constantly
+#define WAKE_UP_PREEMPTION_GRANULARITY 500000
 
 typedef struct OpenSocketSyscallArgs{
     unsigned short udpPort;
@@ -62,13 +121,155 @@ typedef struct PrintToScreenSyscallArgs{
 
 typedef struct GetTimerCounterSyscallArgs{
     unsigned int timerCounter;
+    unsigned int timerTicks;
 }GetTimerSyscallArgs;
 
+typedef struct SleepSyscallArgs{
+    // The timer tick at which the task should be woken up if isDeadline is 1, otherwise the number of timer ticks to sleep
+    unsigned int timerTicks;
+    unsigned int isDeadline;
+} SleepSyscallArgs;
+
+typedef struct WaitForSocketEventSyscallArgs{
+    unsigned char socketID;
+    int success;
+} WaitForSocketEventSyscallArgs;
+
+typedef struct SetupSocketRingsSyscallArgs{
+    struct SocketRings* rings;
+    unsigned char* bufferArea;
+    unsigned int bufferAreaSize;
+    int success;
+} SetupSocketRingsSyscallArgs;
+
+typedef struct SendBatchSyscallArgs{
+    struct SendBatchEntry* entries;
+    unsigned int numEntries;
+    int numAccepted;
+} SendBatchSyscallArgs;
+
+typedef struct ReceiveBatchSyscallArgs{
+    struct ReceiveBatchEntry* entries;
+    unsigned int numEntries;
+    int numAccepted;
+} ReceiveBatchSyscallArgs;
+
+typedef struct FutexWaitSyscallArgs{
+    volatile int* addr;
+    int expected;
+    // In timer ticks, WAIT_FOREVER means no timeout
+    unsigned int timeout;
+    int result;
+} FutexWaitSyscallArgs;
+
+typedef struct WaitSocketsSyscallArgs{
+    unsigned int socketMask;
+    // In timer ticks, WAIT_FOREVER means no timeout
+    unsigned int timeout;
+    int result;
+} WaitSocketsSyscallArgs;
+
+// Layout of ap_trampoline_params in ap_trampoline_assembly.asm
+struct ApTrampolineParams{
+    GdtDescr gdtDescr;
+    unsigned short padding;
+    unsigned int stack;
+    unsigned int entry;
+} __attribute__((packed));
+
+struct TaskSwitchStatistics{
+    unsigned int numTaskSwitches = 0;
+    // Task switches which needed to load another page directory (and thus flushed the TLB)
+    unsigned int numPageDirectoryReloads = 0;
+    // Exponential moving average of the number of cpu cycles spent in yieldTaskSwitch for a task switch
+    unsigned int averageTaskSwitchCycles = 0;
+    // Task switches which happened immediately because a task was woken up which should run instead of the current task
+    unsigned int numWakeUpPreemptions = 0;
+    // Timer interrupts which actually happened, less than the number of timer ticks when tickless mode was used
+    unsigned int numTimerInterrupts = 0;
+};
+
+struct TaskStatistics{
+    // Cpu cycles (measured with RDTSC) the task has been running
+    unsigned long long runtimeCycles = 0;
+    unsigned int numTimesScheduled = 0;
+    // Number of times the task gave up the cpu itself (yield, blocking syscall) or was preempted
+    unsigned int numVoluntarySwitches = 0;
+    unsigned int numInvoluntarySwitches = 0;
+};
+
+enum class TaskState{
+    Runnable,
+    Blocked,
+    // The task caused an exception, it is not part of any run queue or wait queue and will never run again
+    Crashed,
+    // The task is being stopped, it is not part of any run queue or wait queue and will never run again
+    Stopped
+};
+
+struct TaskCrashInfo{
+    bool hasCrashed = false;
+    unsigned int exceptionNumber = 0;
+    // Value of CR2 for page faults, 0 for other exceptions
+    unsigned int faultAddress = 0;
+    // Address of the instruction which caused the exception
+    unsigned int eip = 0;
+};
+
 struct TaskDescriptor{
     class Task* pTask = nullptr;
+    // Cpu core whose run queues or timer wheel the task is in, only changed (by work stealing) while holding the run 
+    // queue locks of both cpu cores
+    class CpuCore* pCpuCore = nullptr;
+    // Kernel tasks stay on the cpu core which started them, user tasks can be moved to other cpu cores
+    bool canMigrate = false;
+    unsigned short taskID = 0;
     unsigned int taskEsp = 0;
     unsigned int kernelEspStackBegin = 0;
     unsigned int pageDirectoryPhysicalAddr = 0;
+    unsigned int priority = 0;
+    TaskState state = TaskState::Runnable;
+    // Cpu cycles the task has run, scaled by DEFAULT_TASK_WEIGHT/weight
+    unsigned long long vruntime = 0;
+    unsigned int weight = DEFAULT_TASK_WEIGHT;
+    // (1<<26)/weight, avoids a division at every task switch
+    unsigned int inverseWeight = (1 << 26)/DEFAULT_TASK_WEIGHT;
+    // Number of timer ticks the task can run before it is preempted
+    unsigned int quantum = DEFAULT_TASK_QUANTUM;
+    // First child of this task in the pairing heap of its run queue
+    DoublyLinkedListElement<TaskDescriptor>* heapChild = nullptr;
+    TaskStatistics statistics;
+    // fpuState is only saved once another task uses the FPU, fpuStateValid is false if the task never used the FPU
+    bool fpuStateValid = false;
+    alignas(16) unsigned char fpuState[FPU_STATE_SIZE];
+    // Only valid if state is TaskState::Blocked
+    class WaitQueue* pWaitQueue = nullptr;
+    // Only valid if the task is sleeping (blocked in a slot of the timer wheel)
+    unsigned int wakeUpTick = 0;
+    // Only valid if state is TaskState::Crashed
+    TaskCrashInfo crashInfo;
+    // Virtual address of the kernel info page of a user task (nullptr for kernel tasks), it is only written while the page
+    // directory of the task is loaded since its physical address can be remapped by the page directories of other tasks
+    KernelInfoPage* pKernelInfoPage = nullptr;
+    // Kernel address of the word the task waits on in futexWait, 0 if the task isn't in a futex bucket
+    unsigned int futexAddr = 0;
+    // Next task in the same futex bucket
+    DoublyLinkedListElement<TaskDescriptor>* pNextFutexWaiter = nullptr;
+};
+
+// Tasks which are blocked are removed from the run queues and are kept in a WaitQueue instead, 
+// they become runnable again once CpuCore::wakeUpAll is called for this WaitQueue
+class WaitQueue{
+        friend class CpuCore;
+
+    private:
+        DoublyLinkedListElement<TaskDescriptor>* head;
+        DoublyLinkedListElement<TaskDescriptor>* tail;
+
+    public:
+        WaitQueue();
+
+        bool isEmpty();
 };
 
 struct TaskArguments{
@@ -88,13 +289,38 @@ class Task{
         class CpuCore* pCpuCore;
         int taskID;
         bool isRunning;
+        unsigned int priority;
+        unsigned int weight;
+        unsigned int quantum;
 
     public:
-        Task(class CpuCore* pCpuCore);
+        Task(class CpuCore* pCpuCore, unsigned int priority);
 
         int getTaskID();
         bool getRunningState();
 
+        unsigned int getPriority();
+        // Returns false if newPriority is not smaller than NUM_TASK_PRIORITIES
+        // Can be called while the task is running, the task will then be moved to the run queue of the new priority
+        bool setPriority(unsigned int newPriority);
+
+        unsigned int getWeight();
+        // Returns false if newWeight is 0 or bigger than MAX_TASK_WEIGHT
+        // Can be called while the task is running
+        bool setWeight(unsigned int newWeight);
+
+        unsigned int getQuantum();
+        // Returns false if newQuantum is 0 or bigger than MAX_TASK_QUANTUM
+        // Can be called while the task is running, the new quantum is used from the next time the task is scheduled
+        bool setQuantum(unsigned int newQuantum);
+
+        // Statistics of the current run of the task, all zero if the task isn't running
+        TaskStatistics getStatistics();
+
+        // hasCrashed is true if the task caused an exception while running, such a task doesn't run anymore but it
+        // still counts as running until it is destroyed
+        TaskCrashInfo getCrashInfo();
+
         virtual SetToRunningStateResponse setToRunningState() = 0;
         virtual bool isKernelTask() = 0;
 };
@@ -102,9 +328,11 @@ class Task{
 // Make it clear that these function are declared using C linkage
 extern "C" void yieldTaskSwitch(unsigned int interruptParam, unsigned int* pEsp);
 class CpuCore{
+        friend class Task;
         friend void genericExceptionHandler(unsigned int interruptParam, unsigned int eax);
         friend void generalProtectionFaultExceptionHandler(unsigned int interruptParam, unsigned int eax);
         friend void pageFaultExceptionHandler(unsigned int interruptParam, unsigned int eax);
+        friend void coprocessorNotAvailableExceptionHandler(unsigned int interruptParam, unsigned int eax);
         friend void yieldTaskSwitch(unsigned int interruptParam, unsigned int* pEsp);
         friend void openSocketSyscallHandler(unsigned int interruptParam, unsigned int eax);
         friend void setReceiveBufferSyscallHandler(unsigned int interruptParam, unsigned int eax);
@@ -112,6 +340,15 @@ class CpuCore{
         friend void closeSocketSyscallHandler(unsigned int interruptParam, unsigned int eax);
         friend void printToScreenSyscallHandler(unsigned int interruptParam, unsigned int eax);
         friend void getTimerCounterSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void waitForSocketEventSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void sleepSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void setupSocketRingsSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void wakeUpSocketRingsSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void sendBatchSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void receiveBatchSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void futexWaitSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void waitSocketsSyscallHandler(unsigned int interruptParam, unsigned int eax);
+        friend void rescheduleIpiHandler(unsigned int interruptParam, unsigned int eax);
         #if E2E_TESTING
         friend void debugLogInterruptHandler(unsigned int interruptParam, unsigned int eax);
         #endif
@@ -119,21 +356,183 @@ class CpuCore{
     private:
         unsigned int taskSwitchStack[TASK_SWITCH_STACK_SIZE];
 
+        GdtEntry gdtEntries[NUM_GDT_ENTRIES];
         Tss tss;
+        Lapic lapic;
         InterruptHandlerManager interruptHandlerManager;
         CurrentPagingStructure currentPagingStructure;
 
         bool isRunning;
+        unsigned int cpuCoreId;
+        unsigned int lapicId;
+        // A cpu core reserved for kernel tasks doesn't get user tasks and doesn't steal them
+        bool reservedForKernelTasks;
 
         unsigned int timerCounter;
-
-        DoublyLinkedListElement<TaskDescriptor> taskDescriptorListElements[NUM_POSSIBLE_TASKS];
-        DoublyLinkedListElement<TaskDescriptor>* unusedtaskDescriptorElementsListHead;
-        DoublyLinkedListElement<TaskDescriptor>* activeTasksListHead;
+        // Timer ticks since timerCounter was last incremented
+        unsigned int timerTicksSinceCounterIncrement;
+        // Timer ticks the current task can still run before it is preempted
+        unsigned int remainingQuantumTicks;
+        // Incremented every timer tick, wraps around
+        // Important: in tickless mode this is only updated when the timer interrupt fires, call stopTicklessMode first
+        // to bring it up to date
+        unsigned int timerTicks;
+        // Timestamp counter when timerTicks was last updated
+        unsigned long long timerTicksTimestamp;
+        // Handles everything that happens at a timer tick except preemption, for numTicks timer ticks
+        void processTimerTicks(unsigned int numTicks);
+        // Writes the timer ticks and timer counter of this cpu core to the kernel info page of the task (if it is a 
+        // user task), should be called for the current task whenever they change and whenever the current task changes
+        void updateKernelInfoPage(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        // Stops the periodic timer interrupts if pRunningTask is the only runnable task (or if nothing is runnable and 
+        // pRunningTask is the idle task) until the next timer tick which wakes up a task or increments timerCounter
+        // while tasks are waiting for it
+        void startTicklessModeIfPossible(DoublyLinkedListElement<TaskDescriptor>* pRunningTask);
+        // Catches up with the timer ticks which already passed and restarts the periodic timer interrupts, needs to be
+        // called once another task becomes runnable or before timerTicks is used
+        // Important: should not be called while holding waitQueueLock or a runQueueLock
+        void stopTicklessMode();
+        // Tasks can move between cpu cores, thus application processors start counting timer ticks from the timer ticks
+        // of the bootstrap core (this can be off by the one timer tick the bootstrap core might be processing)
+        void copyTimerTicks(CpuCore* pOtherCpuCore);
+
+        // taskDescriptors[i] is the descriptor of the running task with task ID i, or nullptr if no running task has this ID
+        // Tasks are always created and destroyed by tasks on the bootstrap core (the os management task), these tables
+        // are only used there, also for tasks which run on other cpu cores
+        SlabAllocator<DoublyLinkedListElement<TaskDescriptor>, TASK_DESCRIPTOR_SLAB_NUM_PAGES> taskDescriptorAllocator;
+        DoublyLinkedListElement<TaskDescriptor>* taskDescriptors[NUM_POSSIBLE_TASKS];
+        // Returns nullptr if NUM_POSSIBLE_TASKS tasks are already running or if no memory is left
+        DoublyLinkedListElement<TaskDescriptor>* allocateTaskDescriptor();
+        void freeTaskDescriptor(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
         DoublyLinkedListElement<TaskDescriptor>* currentTask;
 
+        // Running tasks are kept in a run queue per priority, bit i of runQueueBitmap is set if runQueueRoots[i] is 
+        // not empty, this way the highest priority run queue can be found in O(1)
+        // Each run queue is a pairing heap ordered on vruntime (next is the next sibling, prev is the previous sibling
+        // or the parent), the root is the task which has received the least cpu time relative to its weight
+        DoublyLinkedListElement<TaskDescriptor>* runQueueRoots[NUM_TASK_PRIORITIES];
+        unsigned int runQueueBitmap;
+        // Tasks in the run queues (including the current task if it is runnable) and how many of them can migrate, read 
+        // without holding runQueueLock by other cpu cores to decide where to place or steal tasks
+        unsigned int numRunnableTasks;
+        unsigned int numMigratableTasks;
+        // Tasks which are added to a run queue get at least this vruntime, otherwise a new task or a task which was 
+        // blocked for a long time would monopolize the cpu
+        unsigned long long runQueueMinVruntimes[NUM_TASK_PRIORITIES];
+
+        // Timestamp counter value at the last call to pickNextTask, used to charge the current task for its runtime
+        unsigned long long lastTaskSwitchTimestamp;
+
+        TaskSwitchStatistics taskSwitchStatistics;
+
+        // The idle task is never part of a run queue, it only runs when no other task is runnable
+        DoublyLinkedListElement<TaskDescriptor> idleTask;
+        void setupIdleTask();
+
+        // Set by the timer callback so that yieldTaskSwitch knows the current task did not give up the cpu voluntarily
+        bool preemptionRequested;
+
+        // Set by wakeUpAll when a woken up task should run instead of the current task (e.g. it has a higher priority or 
+        // it has been blocked while the current task was using the cpu), the switch happens in rescheduleIfRequested or 
+        // at the latest at the next timer tick
+        bool rescheduleRequested;
+        bool shouldPreemptCurrentTask(DoublyLinkedListElement<TaskDescriptor>* pWokenUpTask);
+
         bool taskSwitchingPaused;
 
+        // The FPU/SSE registers are switched lazily: CR0.TS is set when switching to a task which isn't fpuOwner, the 
+        // first FPU/SSE instruction of that task then causes a CoprocessorNotAvailable exception which saves the state of
+        // fpuOwner and loads the state of the current task, tasks which never use the FPU don't pay anything
+        DoublyLinkedListElement<TaskDescriptor>* fpuOwner;
+        bool taskSwitchedFlagSet;
+        // State loaded for tasks which use the FPU for the first time
+        alignas(16) unsigned char initialFpuState[FPU_STATE_SIZE];
+        void setupFpu();
+
+        // Protects the run queues, currentTask, fpuOwner and rescheduleRequested of this cpu core, which other cpu cores
+        // change when they wake up tasks of this cpu core or steal tasks from it
+        // waitQueueLock protects every WaitQueue (including the timer wheels), it is always taken before a runQueueLock
+        // and a cpu core holding its own runQueueLock only takes the runQueueLock of another cpu core with tryLock
+        // Important: these are only taken with interrupts disabled
+        SpinLock runQueueLock;
+        static SpinLock waitQueueLock;
+        // Takes the runQueueLock of the cpu core pTaskElement belongs to (which could change while waiting for the lock)
+        // and returns that cpu core
+        static CpuCore* lockTaskCpuCore(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        // Returns once this cpu core switched away from pTaskElement
+        void waitUntilNotCurrentTask(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+
+        // These should only be called while holding runQueueLock
+        void addToRunQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        void removeFromRunQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        DoublyLinkedListElement<TaskDescriptor>* pickNextTask(bool currentTaskWasPreempted);
+        DoublyLinkedListElement<TaskDescriptor>* mergeHeaps(DoublyLinkedListElement<TaskDescriptor>* pFirstRoot, DoublyLinkedListElement<TaskDescriptor>* pSecondRoot);
+        DoublyLinkedListElement<TaskDescriptor>* mergeHeapSiblings(DoublyLinkedListElement<TaskDescriptor>* pFirstSibling);
+        // Moves a waiting task of the busiest other cpu core to the run queues of this cpu core, returns nullptr if no 
+        // task could be stolen
+        DoublyLinkedListElement<TaskDescriptor>* stealTask();
+        // Returns the waiting task with the highest priority which is allowed to move to another cpu core, a task which
+        // still owns the FPU registers of this cpu core is not, nullptr if there is no such task
+        DoublyLinkedListElement<TaskDescriptor>* findTaskToSteal();
+
+        // Cpu core with the least runnable tasks which isn't reserved for kernel tasks (unless every cpu core is), new user 
+        // tasks are started there
+        static CpuCore* getLeastLoadedCpuCore();
+        // Should be called without holding any lock after tasks were added to the run queues of the cpu cores in 
+        // cpuCoreMask (bit i for cpu core i): this cpu core leaves tickless mode and other cpu cores get a reschedule IPI
+        // (which also makes them switch if wakeUpAll requested this), an idle cpu core is woken up to steal a task from 
+        // a cpu core which now has tasks waiting
+        // Important: should only be called with interrupts disabled
+        void notifyCpuCores(unsigned int cpuCoreMask);
+        // Should be called on the CpuCore of the cpu core executing this, sends a reschedule IPI to another cpu core
+        void sendRescheduleIpi(CpuCore* pCpuCore);
+        void wakeUpIdleCpuCore();
+
+        void addToWaitQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement, WaitQueue* pWaitQueue);
+        void removeFromWaitQueue(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        // Adds a task which was removed from its WaitQueue to the run queue of its cpu core, returns the cpu core mask 
+        // for notifyCpuCores
+        // Important: should only be called while holding waitQueueLock
+        unsigned int makeRunnable(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        // Yields until pTaskElement (the current task) is no longer blocked
+        void yieldUntilRunnable(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+
+        // Each slot of the timer wheel is a WaitQueue, this way a sleeping task is removed from the timer wheel in the same 
+        // way as a task blocked on any other WaitQueue when it is stopped
+        // timerWheelTicks is the next timer tick which the timer wheel will process
+        WaitQueue timerWheelLevel0[1 << TIMER_WHEEL_LEVEL0_BITS];
+        WaitQueue timerWheelUpperLevels[TIMER_WHEEL_NUM_LEVELS-1][1 << TIMER_WHEEL_LEVEL_BITS];
+        unsigned int timerWheelTicks;
+        // These should only be called with interrupts disabled while holding waitQueueLock (except runTimerWheel)
+        void addToTimerWheel(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        void cascadeTimerWheelSlot(WaitQueue* pSlot);
+        void runTimerWheel();
+
+        // A task in futexWait is blocked in the timer wheel (if it has a timeout) or in futexWaitQueue, and is also linked 
+        // in the futex bucket of its word through pNextFutexWaiter so that futexWake can find it, all of this is 
+        // protected by waitQueueLock (futexWake only reads whether a bucket is empty without it)
+        static DoublyLinkedListElement<TaskDescriptor>* futexBuckets[NUM_FUTEX_BUCKETS];
+        static WaitQueue futexWaitQueue;
+        static DoublyLinkedListElement<TaskDescriptor>** getFutexBucket(unsigned int futexAddr);
+        // Should only be called while holding waitQueueLock
+        static void removeFromFutexBucket(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+
+        // Called by exception handlers, a user task causing an exception is removed from its run queue, its sockets are 
+        // closed and it is never scheduled again (this call doesn't return in that case)
+        // Returns if the current task is a kernel task or the idle task
+        void crashCurrentTask(unsigned int exceptionNumber, unsigned int faultAddress, unsigned int eip);
+
+        // Used by tasks to add/remove themselves to/from the run queues, these disable interrupts themselves
+        // A migratable task is started on the least loaded cpu core, a task which is still running on another cpu core
+        // is only freed once that cpu core switched away from it
+        // Important: should be called on the CpuCore of the cpu core executing this
+        void startRunningTask(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+        void stopRunningTask(DoublyLinkedListElement<TaskDescriptor>* pTaskElement);
+
+        // These disable interrupts themselves, the socket manager takes its locks with interrupts disabled
+        bool createSocketTable(unsigned short taskID);
+        void closeAllSocketsForTask(unsigned short taskID);
+
         class SocketManager* pSocketManager;
         unsigned int kernelPageDirectoryPhysicalAddr;
         PageAllocator* pKernelPageAlloctor;
@@ -151,7 +550,24 @@ class CpuCore{
         TimerCallback timerCallback;
         Timer timer;
 
+        // Woken up every time timerCounter is incremented
+        WaitQueue timerTickWaitQueue;
+
         static CpuCore* cpuCorePointers[NUM_CPU_CORES];
+        static unsigned int numCpuCores;
+
+        // Only used once application processors are started, before that getThisCpuCoreId always returns 0
+        static bool useLapicIds;
+        static unsigned char lapicIdToCpuCoreId[256];
+
+        // Used by application processors to construct their own CpuCore while they are started one at a time
+        static MemoryManager* pApplicationProcessorMemoryManager;
+        static unsigned int applicationProcessorStarted;
+        // Entry point of application processors (called by ap_trampoline_assembly.asm)
+        static void applicationProcessorMain();
+
+        // Important: should be called with interrupts enabled
+        void waitTimerTicks(unsigned int numTicks);
     
     public:
         class UserTask : public Task{
@@ -183,6 +599,7 @@ class CpuCore{
             private:
                 unsigned int kernelStackSpaceBegin;
                 unsigned int updatedKernelStack;
+                CpuCore* pRunningCpuCore;
 
             public:
                 KernelTask(CpuCore* pCpuCore);
@@ -193,20 +610,77 @@ class CpuCore{
                 bool isKernelTask() override;
 
                 void setProcessCode(unsigned int* processCode, TaskArguments& taskArgs);
+                // Kernel tasks run on the cpu core they were created for unless another (running) cpu core is set here 
+                // before setToRunningState is called
+                void setRunningCpuCore(CpuCore* pNewRunningCpuCore);
         };
 
-        CpuCore(class SocketManager* pSocketManager, unsigned int kernelPageDirectoryPhysicalAddr, PageAllocator* pKernelPageAlloctor);
+        CpuCore(class SocketManager* pSocketManager, unsigned int kernelPageDirectoryPhysicalAddr, PageAllocator* pKernelPageAlloctor, 
+            MemoryManager* pMemoryManager);
         void bind();
 
         Tss* getCurrentTss();
         InterruptHandlerManager* getInterruptHandlerManager();
+        // Interrupts from the I/O APIC or from devices (MSI) are sent to a cpu core using its local APIC ID
+        unsigned int getLapicId();
+
+        // Raises interrupt intType (one of the local APIC interrupts) on pCpuCore
+        // Important: should be called on the CpuCore of the cpu core executing this with interrupts disabled
+        void sendIpi(CpuCore* pCpuCore, InterruptType intType);
+
+        // User tasks are no longer started on this cpu core and it doesn't steal them from other cpu cores, e.g. for a cpu
+        // core which handles the network card interrupts, should be called before user tasks are started
+        void reserveForKernelTasks();
         CurrentPagingStructure* getCurrentPagingStructure();
 
-        // Returns 0 if successfull, 1 if not
+        // Can be nested, task switching is only resumed once the outermost call returns
         void withTaskSwitchingPaused(Runnable& runnable);
+
+        // Blocks the current task until wakeUpAll is called for pWaitQueue
+        // Important: should only be called with interrupts disabled (e.g. inside withInterruptsDisabled or inside a syscall 
+        // handler) after checking whatever condition the task is waiting for, otherwise a wake up might be missed
+        // If that condition can be changed by other cpu cores, they should only do so while holding pLock which is 
+        // then released once the task is in pWaitQueue and taken again before this returns
+        void waitOn(WaitQueue* pWaitQueue, TicketLock* pLock = nullptr);
+        // Makes every task blocked on pWaitQueue runnable again (on the cpu core it was blocked on), can also be called
+        // from interrupt handlers
+        // Important: should be called on the CpuCore of the cpu core executing this
+        void wakeUpAll(WaitQueue* pWaitQueue);
+        // Switches to another task if wakeUpAll woke up a task which should run instead of the current task, interrupt 
+        // handlers which can wake up tasks call this before returning so that the woken up task doesn't have to wait 
+        // for the next timer tick
+        // Important: should only be called with interrupts disabled
+        void rescheduleIfRequested();
+        WaitQueue* getTimerTickWaitQueue();
+        // Blocks the current task until timerTicks reaches wakeUpTick (compared with wrap around, thus wakeUpTick should not 
+        // be more than 2^31 ticks away), returns immediately if wakeUpTick already passed
+        // Important: should only be called with interrupts disabled
+        void sleepUntil(unsigned int wakeUpTick);
+        // Blocks the current task until futexWake is called for futexAddr (the 4 byte aligned kernel address of the word), 
+        // or until timerTicks reaches wakeUpTick if hasTimeout (compared with wrap around just like sleepUntil), pWord is 
+        // the address of the same word in the page directory which is currently loaded
+        // Returns immediately with FUTEX_VALUE_CHANGED if *pWord isn't expected, otherwise FUTEX_WOKEN_UP or FUTEX_TIMED_OUT
+        // Important: should only be called with interrupts disabled
+        int futexWait(volatile int* pWord, unsigned int futexAddr, int expected, bool hasTimeout, unsigned int wakeUpTick);
+        // Makes every task waiting in futexWait on the 4 byte aligned word containing kernel address pWord runnable again, 
+        // the word should be written before this is called, can also be called from interrupt handlers
+        // Important: should be called on the CpuCore of the cpu core executing this
+        void futexWake(volatile void* pWord);
+        unsigned int getTimerTicks();
         
+        // Returns nullptr if the idle task is running
         Task* getCurrentTask();
 
+        TaskSwitchStatistics getTaskSwitchStatistics();
+
+        // Starts the other cpu cores listed in the ACPI tables one at a time, each of them constructs and binds its own 
+        // CpuCore, should be called by the bootstrap core after bind()
+        // Important: should be called with interrupts enabled and task switching paused
+        void startApplicationProcessors(MemoryManager* pMemoryManager);
+
+        // Returns nullptr if the cpu core with this id isn't running
         static CpuCore* getCpuCore(unsigned int cpuCoreId);
+        // Derived from the local APIC ID of the core executing this
         static unsigned int getThisCpuCoreId();
+        static unsigned int getNumCpuCores();
 };
\ No newline at end of file
@@ -2,6 +2,14 @@
 [extern yieldTaskSwitch]
 
 global yieldTaskSwitchIntHandler
+global getCpuidFeatureFlags
+global enableFpu
+global setTaskSwitchedFlag
+global clearTaskSwitchedFlag
+global initFpuState
+global saveFpuState
+global restoreFpuState
+global getCr2
 
 ;void yieldTaskSwitchIntHandler(unsigned int interruptParam, unsigned int eax)
 yieldTaskSwitchIntHandler:
@@ -24,4 +32,64 @@ yieldTaskSwitchIntHandler:
 
     mov esp, eax
     
+    ret
+
+;void getCpuidFeatureFlags(unsigned int* returnValue), returns edx of cpuid leaf 1
+getCpuidFeatureFlags:
+    push ebx
+    mov eax, 1
+    cpuid
+    mov eax, [esp+8]
+    mov [eax], edx
+    pop ebx
+    ret
+
+;void enableFpu()
+enableFpu:
+    mov eax, cr0
+    and eax, 0xFFFFFFFB     ;clear CR0.EM, the FPU is not emulated
+    or eax, 0x22            ;set CR0.MP and CR0.NE, FPU errors are reported through exceptions
+    mov cr0, eax
+    mov eax, cr4
+    or eax, 0x600           ;set CR4.OSFXSR and CR4.OSXMMEXCPT so that SSE instructions can be used
+    mov cr4, eax
+    ret
+
+;void setTaskSwitchedFlag(), the next FPU/SSE instruction will cause a CoprocessorNotAvailable exception
+setTaskSwitchedFlag:
+    mov eax, cr0
+    or eax, 0x8             ;set CR0.TS
+    mov cr0, eax
+    ret
+
+;void clearTaskSwitchedFlag()
+clearTaskSwitchedFlag:
+    clts
+    ret
+
+;void initFpuState()
+initFpuState:
+    fninit
+    push dword 0x1F80       ;default MXCSR value, all SSE exceptions are masked
+    ldmxcsr [esp]
+    add esp, 4
+    ret
+
+;void saveFpuState(unsigned char* pFpuState), pFpuState must be 16-byte aligned
+saveFpuState:
+    mov eax, [esp+4]
+    fxsave [eax]
+    ret
+
+;void restoreFpuState(unsigned char* pFpuState), pFpuState must be 16-byte aligned
+restoreFpuState:
+    mov eax, [esp+4]
+    fxrstor [eax]
+    ret
+
+;void getCr2(unsigned int* returnValue), returns the address which caused the last page fault
+getCr2:
+    mov eax, cr2
+    mov edx, [esp+4]
+    mov [edx], eax
     ret
\ No newline at end of file
@@ -3,24 +3,24 @@
 
 extern "C" void loadPageDirectory(unsigned int physicalPageDirectoryAddress);
 extern "C" void enablePaging();
+extern "C" void enableGlobalPages();
 extern "C" void invalidateTLB();
+extern "C" void invalidateTLBIncludingGlobalPages();
 extern "C" void invalidatePage(unsigned int virtualPageTableAddress);
-extern "C" void getPageDirectory(unsigned int* returnValue);
 
 unsigned int CurrentPagingStructure::swapPageDirectory(unsigned int newPageDirectoryPhysicalAddr){
-    unsigned int oldPhysicalPageDirectoryAddr = 0;
-    getPageDirectory(&oldPhysicalPageDirectoryAddr);
+    unsigned int oldPhysicalPageDirectoryAddr = activePageDirectoryAddr;
 
-    loadPageDirectory(newPageDirectoryPhysicalAddr);
+    if(newPageDirectoryPhysicalAddr!=oldPhysicalPageDirectoryAddr){
+        loadPageDirectory(newPageDirectoryPhysicalAddr);
+        activePageDirectoryAddr = newPageDirectoryPhysicalAddr;
+    }
 
     return oldPhysicalPageDirectoryAddr;
 }
 
 unsigned int CurrentPagingStructure::getPageDirectoryPhysicalAddr(){
-    unsigned int oldPhysicalPageDirectoryAddr = 0;
-    getPageDirectory(&oldPhysicalPageDirectoryAddr);
-
-    return oldPhysicalPageDirectoryAddr;
+    return activePageDirectoryAddr;
 }
 
 PDE CurrentPagingStructure::getPDE(unsigned int pdeIndex){
@@ -51,18 +51,25 @@ PTE CurrentPagingStructure::getPTE(unsigned int pdeIndex, unsigned int pteIndex)
 
 CurrentPagingStructure::CurrentPagingStructure(unsigned int firstPageDirectoryAddr)
     :
-    firstPageDirectoryAddr(firstPageDirectoryAddr)
+    firstPageDirectoryAddr(firstPageDirectoryAddr),
+    activePageDirectoryAddr(firstPageDirectoryAddr)
 {}
 
 void CurrentPagingStructure::tlbInvalidatePage(Page* pPage){
     invalidatePage((unsigned int)pPage);
 }
 
-void CurrentPagingStructure::tlbInvalidateAll(){
+void CurrentPagingStructure::tlbInvalidateNonGlobal(){
     invalidateTLB();
 }
 
+void CurrentPagingStructure::tlbInvalidateAll(){
+    invalidateTLBIncludingGlobalPages();
+}
+
 void CurrentPagingStructure::bind(){
     loadPageDirectory(firstPageDirectoryAddr);
+    activePageDirectoryAddr = firstPageDirectoryAddr;
     enablePaging();
+    enableGlobalPages();
 }
\ No newline at end of file
@@ -9,16 +9,22 @@ class CurrentPagingStructure{
         CurrentPagingStructure(unsigned int firstPageDirectoryAddr);
 
         unsigned int firstPageDirectoryAddr;
+        // Physical address currently loaded in CR3, avoids reloading CR3 (and flushing the TLB) when it wouldn't change
+        unsigned int activePageDirectoryAddr;
 
     public:
         void bind();
         
+        // CR3 is only reloaded if newPageDirectoryPhysicalAddr differs from the active page directory
         unsigned int swapPageDirectory(unsigned int newPageDirectoryPhysicalAddr);
 
         unsigned int getPageDirectoryPhysicalAddr();
         PDE getPDE(unsigned int pdeIndex);
         PTE getPTE(unsigned int pdeIndex, unsigned int pteIndex);
 
+        // Also invalidates the page if it is global, should be used when a kernel mapping is changed
         void tlbInvalidatePage(Page* pPage);
+        // Global pages stay in the TLB
+        void tlbInvalidateNonGlobal();
         void tlbInvalidateAll();
 };
\ No newline at end of file
@@ -1,7 +1,9 @@
 global loadPageDirectory
 global enablePaging
+global enableGlobalPages
 
 global invalidateTLB
+global invalidateTLBIncludingGlobalPages
 global invalidatePage
 global getPageDirectory
 
@@ -24,6 +26,14 @@ enablePaging:
     pop ebp
     ret
 
+enableGlobalPages:
+    push eax
+    mov eax, cr4
+    or eax, 0x80            ;set CR4.PGE
+    mov cr4, eax
+    pop eax
+    ret
+
 invalidateTLB:
     push eax
     mov eax, cr3
@@ -31,6 +41,17 @@ invalidateTLB:
     pop eax
     ret
 
+;toggling CR4.PGE flushes the entire TLB, including global pages
+invalidateTLBIncludingGlobalPages:
+    push eax
+    mov eax, cr4
+    xor eax, 0x80
+    mov cr4, eax
+    xor eax, 0x80
+    mov cr4, eax
+    pop eax
+    ret
+
 invalidatePage:
     push eax
     mov eax, [esp+8]
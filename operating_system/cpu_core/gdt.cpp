@@ -1,4 +1,5 @@
 #include "gdt.h"
+#include "../../cpp_lib/mem.h"
 
 GdtEntry* getGdtEntries(){
     GdtDescr gdtDescr;
@@ -6,4 +7,15 @@ GdtEntry* getGdtEntries(){
     __asm__ __volatile__("sgdt %0" :"=m"(gdtDescr));
 
     return (GdtEntry*)gdtDescr.base;
-}
\ No newline at end of file
+}
+
+void loadGdtCopy(GdtEntry* pGdtEntries){
+    memCopy((unsigned char*)getGdtEntries(), (unsigned char*)pGdtEntries, NUM_GDT_ENTRIES*sizeof(GdtEntry));
+
+    GdtDescr gdtDescr;
+    gdtDescr.limit = NUM_GDT_ENTRIES*sizeof(GdtEntry)-1;
+    gdtDescr.base = (unsigned int)pGdtEntries;
+
+    // The segment registers don't need to be reloaded since the selectors stay the same
+    __asm__ __volatile__("lgdt %0" : : "m"(gdtDescr) : "memory");
+}
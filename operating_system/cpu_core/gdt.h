@@ -14,4 +14,11 @@ typedef struct GdtEntry{
     unsigned char  base_high;
 } __attribute__((packed)) GdtEntry;
 
-GdtEntry* getGdtEntries();
\ No newline at end of file
+// Null, kernel code, kernel data, user code, user data, TSS and INTERRUPT_HANDLERS (see boot/gdt_table.asm)
+#define NUM_GDT_ENTRIES 7
+
+GdtEntry* getGdtEntries();
+
+// Copies the gdt which is currently loaded to pGdtEntries (NUM_GDT_ENTRIES entries) and loads the copy instead, every 
+// cpu core needs its own gdt since the TSS and INTERRUPT_HANDLERS entries point to structures of that cpu core
+void loadGdtCopy(GdtEntry* pGdtEntries);
\ No newline at end of file
@@ -68,9 +68,35 @@
 #define CUSTOM5 53
 #define CUSTOM6 54
 #define CUSTOM7 55
+#define CUSTOM8 56
+#define CUSTOM9 57
+#define CUSTOM10 58
+#define CUSTOM11 59
+#define CUSTOM12 60
+#define CUSTOM13 61
+#define CUSTOM14 62
+#define CUSTOM15 63
 
 #define CUSTOM32 80
 
+// Model specific registers used by sysenter
+#define IA32_SYSENTER_CS 0x174
+#define IA32_SYSENTER_ESP 0x175
+#define IA32_SYSENTER_EIP 0x176
+
+// Local APIC interrupts
+#define LAPIC0 64
+#define LAPIC1 65
+#define LAPIC2 66
+#define LAPIC3 67
+#define LAPIC4 68
+
+// Used by sysenterEntry, shared by every cpu core (a syscall without handler is ignored)
+extern "C" IsrHandler syscallHandlers[NUM_SYSCALLS];
+IsrHandler syscallHandlers[NUM_SYSCALLS];
+
+extern "C" void sysenterEntry();
+
 extern "C" void exc0();
 extern "C" void exc1();
 extern "C" void exc2();
@@ -129,9 +155,23 @@ extern "C" void custom4();
 extern "C" void custom5();
 extern "C" void custom6();
 extern "C" void custom7();
+extern "C" void custom8();
+extern "C" void custom9();
+extern "C" void custom10();
+extern "C" void custom11();
+extern "C" void custom12();
+extern "C" void custom13();
+extern "C" void custom14();
+extern "C" void custom15();
 
 extern "C" void custom32();
 
+extern "C" void lapic0();
+extern "C" void lapic1();
+extern "C" void lapic2();
+extern "C" void lapic3();
+extern "C" void lapic4();
+
 extern "C" void createIntStackForUserPriv(unsigned int* pTopKernelStack, unsigned int kernelStack, unsigned int userStack, unsigned int processEntry, unsigned int intNumber);
 extern "C" void createIntStackForKernelPriv(unsigned int* pTopKernelStack, unsigned int kernelStack, unsigned int processEntry, unsigned int intNumber);
 
@@ -230,24 +270,42 @@ InterruptHandlerManager::InterruptHandlerManager(){
 	setIdtGate(53, (unsigned int)custom5, true);
     setIdtGate(54, (unsigned int)custom6, true);
     setIdtGate(55, (unsigned int)custom7, true);
+    setIdtGate(56, (unsigned int)custom8, true);
+    setIdtGate(57, (unsigned int)custom9, true);
+    setIdtGate(58, (unsigned int)custom10, true);
+    setIdtGate(59, (unsigned int)custom11, true);
+    setIdtGate(60, (unsigned int)custom12, true);
+    setIdtGate(61, (unsigned int)custom13, true);
+    setIdtGate(62, (unsigned int)custom14, true);
+    setIdtGate(63, (unsigned int)custom15, true);
 
     setIdtGate(80, (unsigned int)custom32, false);
+
+    setIdtGate(64, (unsigned int)lapic0, false);
+    setIdtGate(65, (unsigned int)lapic1, false);
+    setIdtGate(66, (unsigned int)lapic2, false);
+    setIdtGate(67, (unsigned int)lapic3, false);
+    setIdtGate(68, (unsigned int)lapic4, false);
 }
 
 void InterruptHandlerManager::setInterruptHandler(InterruptType intType, const IsrHandler& newHandler){
     unsigned int intTypeToInteger = (unsigned int)intType;
     
-    if(intTypeToInteger > CUSTOM7 && intTypeToInteger != CUSTOM32){
+    if(intTypeToInteger > CUSTOM15 && intTypeToInteger != CUSTOM32 && (intTypeToInteger < LAPIC0 || intTypeToInteger > LAPIC4)){
         return;
     }
 
     atomicStore((unsigned int*)(&interruptHandlers[intTypeToInteger].second), (unsigned int)newHandler);
+
+    if(intTypeToInteger>=CUSTOM0 && intTypeToInteger<CUSTOM0+NUM_SYSCALLS){
+        atomicStore((unsigned int*)(&syscallHandlers[intTypeToInteger-CUSTOM0]), (unsigned int)newHandler);
+    }
 }
 
 void InterruptHandlerManager::setInterruptHandlerParam(InterruptType intType, unsigned int handlerParam){
     unsigned int intTypeToInteger = (unsigned int)intType;
     
-    if(intTypeToInteger > CUSTOM7 && intTypeToInteger != CUSTOM32){
+    if(intTypeToInteger > CUSTOM15 && intTypeToInteger != CUSTOM32 && (intTypeToInteger < LAPIC0 || intTypeToInteger > LAPIC4)){
         return;
     }
 
@@ -258,7 +316,7 @@ unsigned int InterruptHandlerManager::buildIntHandlerStackForUserPriv(InterruptT
     unsigned int intTypeToInteger = (unsigned int)intType;
     unsigned int topKernelStack = 0;
     
-    if(intTypeToInteger > CUSTOM7 && intTypeToInteger != CUSTOM32){
+    if(intTypeToInteger > CUSTOM15 && intTypeToInteger != CUSTOM32){
         return topKernelStack;
     }
 
@@ -271,7 +329,7 @@ unsigned int InterruptHandlerManager::buildIntHandlerStackForKernelPriv(Interrup
     unsigned int intTypeToInteger = (unsigned int)intType;
     unsigned int topKernelStack = 0;
     
-    if(intTypeToInteger > CUSTOM7 && intTypeToInteger != CUSTOM32){
+    if(intTypeToInteger > CUSTOM15 && intTypeToInteger != CUSTOM32){
         return topKernelStack;
     }
 
@@ -280,7 +338,7 @@ unsigned int InterruptHandlerManager::buildIntHandlerStackForKernelPriv(Interrup
     return topKernelStack;
 }
 
-void InterruptHandlerManager::bind(){
+void InterruptHandlerManager::bind(bool remapPic){
     // Set the INTERRUPT_HANDLERS gdt entry to point to the interrupt handlers
     // The fs segment register points to this gdt entry
     unsigned int limit = sizeof(Pair<unsigned int, IsrHandler>)*IDT_ENTRIES;
@@ -292,27 +350,41 @@ void InterruptHandlerManager::bind(){
     gdtEntries[6].limit_low = limit & 0xFFFF;
     gdtEntries[6].granularity = gdtEntries[6].granularity | ((limit >> 16) & 0x0F);
 
-    // Remap the PIC
-	//The Master PIC has command 0x20 and data 0x21, while the slave has command 0xA0 and data 0xA1
-	//https://wiki.osdev.org/PIC
-    portByteOut(0x20, 0x11);
-    portByteOut(0xA0, 0x11);
-    portByteOut(0x21, 0x20);
-    portByteOut(0xA1, 0x28);
-    portByteOut(0x21, 0x04);
-    portByteOut(0xA1, 0x02);
-    portByteOut(0x21, 0x01);
-    portByteOut(0xA1, 0x01);
-    portByteOut(0x21, 0x0);
-    portByteOut(0xA1, 0x0);
+    if(remapPic){
+        // Remap the PIC
+        //The Master PIC has command 0x20 and data 0x21, while the slave has command 0xA0 and data 0xA1
+        //https://wiki.osdev.org/PIC
+        portByteOut(0x20, 0x11);
+        portByteOut(0xA0, 0x11);
+        portByteOut(0x21, 0x20);
+        portByteOut(0xA1, 0x28);
+        portByteOut(0x21, 0x04);
+        portByteOut(0xA1, 0x02);
+        portByteOut(0x21, 0x01);
+        portByteOut(0xA1, 0x01);
+        portByteOut(0x21, 0x0);
+        portByteOut(0xA1, 0x0);
+    }
 	
 	setIdt();
 
     __asm__ __volatile__("sti" ::: "memory");
 }
 
+void InterruptHandlerManager::enableSysenter(unsigned int sysenterEsp){
+    // sysenter loads KERNEL_CS and KERNEL_CS+8 (kernel data), sysexit loads KERNEL_CS+16 (user code) and KERNEL_CS+24 
+    // (user data) with RPL 3, which is exactly the order of the gdt
+    __asm__ __volatile__("wrmsr" : : "c"(IA32_SYSENTER_CS), "a"(KERNEL_CS), "d"(0));
+    __asm__ __volatile__("wrmsr" : : "c"(IA32_SYSENTER_ESP), "a"(sysenterEsp), "d"(0));
+    __asm__ __volatile__("wrmsr" : : "c"(IA32_SYSENTER_EIP), "a"((unsigned int)sysenterEntry), "d"(0));
+}
+
 void InterruptHandlerManager::withInterruptsDisabled(Runnable& runnable){
-    __asm__ __volatile__("cli" ::: "memory");
+    // Remember whether interrupts were enabled so that this can be nested or called from an interrupt handler
+    unsigned int eflags;
+    __asm__ __volatile__("pushf; pop %0; cli" : "=r"(eflags) :: "memory");
     runnable.run();
-    __asm__ __volatile__("sti" ::: "memory");
+    if(eflags & (1 << 9)){
+        __asm__ __volatile__("sti" ::: "memory");
+    }
 }
\ No newline at end of file
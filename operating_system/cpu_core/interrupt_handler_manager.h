@@ -8,6 +8,51 @@
 // Interrupt service routine (ISR) handler
 typedef void (*IsrHandler)(unsigned int interruptParam, unsigned int eax);
 
+// Syscalls are interrupts 48 up to 48+NUM_SYSCALLS-1, user tasks can also do syscall n with the sysenter instruction 
+// (which avoids the generic interrupt path), NUM_SYSCALLS should be the same as in interrupt_handler_manager_assembly.asm
+#define NUM_SYSCALLS 16
+#define SYSCALL_E2E_TESTING_LOG 0
+#define SYSCALL_YIELD 1
+#define SYSCALL_OPEN_SOCKET 2
+#define SYSCALL_SET_RECEIVE_BUFFER 3
+#define SYSCALL_SET_SEND_BUFFER 4
+#define SYSCALL_CLOSE_SOCKET 5
+#define SYSCALL_PRINT 6
+#define SYSCALL_GET_TIMER 7
+#define SYSCALL_WAIT_FOR_SOCKET_EVENT 8
+#define SYSCALL_SLEEP 9
+#define SYSCALL_SETUP_SOCKET_RINGS 10
+#define SYSCALL_WAKE_UP_SOCKET_RINGS 11
+#define SYSCALL_SEND_BATCH 12
+#define SYSCALL_RECEIVE_BATCH 13
+#define SYSCALL_FUTEX_WAIT 14
+#define SYSCALL_WAIT_SOCKETS 15
+
+// Stack built by call_handler (and the cpu) starting at the eax argument of the interrupt handler, an interrupt handler 
+// can use GET_INTERRUPT_FRAME() to find out which interrupt occurred and where the interrupted code was
+struct InterruptFrame{
+    unsigned int eax;
+    unsigned int ds;
+    unsigned int edi;
+    unsigned int esi;
+    unsigned int ebp;
+    unsigned int esp;
+    unsigned int ebx;
+    unsigned int edx;
+    unsigned int ecx;
+    unsigned int pushaEax;
+    unsigned int interruptNumber;
+    unsigned int errorCode;
+    unsigned int eip;
+    unsigned int cs;
+    unsigned int eflags;
+};
+
+// Should only be used in the interrupt handler itself, the InterruptFrame begins right after the saved ebp, the return
+// address and the interruptParam argument of the interrupt handler
+// (the address of the eax argument can't be used for this since the compiler is allowed to copy arguments)
+#define GET_INTERRUPT_FRAME() ((InterruptFrame*)((unsigned int*)__builtin_frame_address(0)+3))
+
 enum class InterruptType{
     DivideByZero = 0,
     Debug = 1,
@@ -54,6 +99,20 @@ enum class InterruptType{
     Int53 = 53,
     Int54 = 54,
     Int55 = 55,
+    Int56 = 56,
+    Int57 = 57,
+    Int58 = 58,
+    Int59 = 59,
+    Int60 = 60,
+    Int61 = 61,
+    Int62 = 62,
+    Int63 = 63,
+    LapicTimer = 64,
+    RescheduleIpi = 65,
+    // Network card and RTC interrupts which are sent through the I/O APIC or as MSI instead of through the legacy PIC
+    NetworkCardApic = 66,
+    RTCTimerApic = 67,
+    LoopbackIpi = 68,
     Int80 = 80,
     UnknownType = 256
 };
@@ -86,12 +145,20 @@ class InterruptHandlerManager{
         Pair<unsigned int, IsrHandler> interruptHandlers[IDT_ENTRIES];
     
     public:
-        void bind();
+        // The legacy PIC only interrupts the bootstrap core, thus only that core should remap it
+        void bind(bool remapPic);
 
+        // Can be nested, interrupts are only re-enabled if they were enabled before the call
         void withInterruptsDisabled(Runnable& runnable);
 
+        // The handlers of the syscall interrupts are also used for sysenter, they should be the same on every cpu core
         void setInterruptHandler(InterruptType intType, const IsrHandler& newHandler);
         void setInterruptHandlerParam(InterruptType intType, unsigned int handlerParam);
         unsigned int buildIntHandlerStackForUserPriv(InterruptType intType, unsigned int kernelStack, unsigned int userStack, unsigned int processEntry);
         unsigned int buildIntHandlerStackForKernelPriv(InterruptType intType, unsigned int kernelStack, unsigned int processEntry);
+
+        // Lets user tasks on this cpu core enter syscalls with sysenter, sysenterEsp should point to esp0 of the TSS of this
+        // cpu core followed by the interrupt handler param for syscalls in esp1 (see Tss::setupSysenterStack)
+        // Important: the cpu should support sysenter (CPUID SEP flag)
+        void enableSysenter(unsigned int sysenterEsp);
 };
\ No newline at end of file
@@ -1,4 +1,10 @@
+[extern syscallHandlers]
+
 global interruptHandlerReturn
+global sysenterEntry
+
+; Should be the same as in interrupt_handler_manager.h
+%define NUM_SYSCALLS 16
 
 call_handler:
     pusha
@@ -12,24 +18,25 @@ call_handler:
     mov fs, bx
 
     push eax
-    
-    mov eax, [esp+40]
-    mov ecx, 8
-    mul ecx
-
-    push dword [fs:eax] ; interrupt handler param
-    add eax, 4
-    call dword [fs:eax] ; interrupt handler
-interruptHandlerReturn:
-    add esp, 4
 
+    ; Send the EOI's before calling the interrupt handler, the interrupt handler might switch to another task
+    ; (e.g. the timer interrupt handler) which could take a very long time to return here, while the PIC
+    ; would keep blocking interrupts
     mov eax, [esp+40]
     cmp eax, 32
     jl l_32_or_ge_48_jump
 
 ge_32_jump:
     cmp eax, 48
+    jl ge_32_and_l_48_jump
+
+    ; Interrupts 64-79 come from the local APIC, which expects the EOI in its own EOI register
+    cmp eax, 64
+    jl l_32_or_ge_48_jump
+    cmp eax, 80
     jge l_32_or_ge_48_jump
+    mov dword [0xFEE000B0], 0
+    jmp l_32_or_ge_48_jump
 
 ge_32_and_l_48_jump:    
     cmp eax, 40
@@ -48,6 +55,7 @@ ge_40_and_l_47_jump:
     out dx, al
 
 ge_32_and_l_40_jump:
+    mov eax, [esp+40]
     cmp eax, 39
     jne ge_32_and_l_39_jump
 
@@ -62,6 +70,16 @@ ge_32_and_l_39_jump:
     out dx, al
 
 l_32_or_ge_48_jump:
+    mov eax, [esp+40]
+    mov ecx, 8
+    mul ecx
+
+    push dword [fs:eax] ; interrupt handler param
+    add eax, 4
+    call dword [fs:eax] ; interrupt handler
+interruptHandlerReturn:
+    add esp, 4
+
     pop eax
 
     pop ebx
@@ -73,6 +91,39 @@ l_32_or_ge_48_jump:
     add esp, 8
     iret
 
+;sysenterEntry, user tasks enter here with sysenter: eax is the argument of the syscall, ebx the syscall number, ecx 
+;the esp and edx the eip to return to (ebx, ecx, edx and esi are not preserved)
+;Unlike call_handler there is no EOI to send and the segment registers don't need to be reloaded (the user data 
+;segment covers the same flat address space and is reloaded by any interrupt handler that runs in between anyway)
+;sysenter disables interrupts and loads esp with the SYSENTER_ESP msr, which points to esp0 in the TSS of this cpu core
+;followed by the interrupt handler param in esp1 (an NMI before the kernel stack is loaded would use the TSS as stack, 
+;but NMIs aren't used)
+sysenterEntry:
+    mov esi, [esp+8]        ; esi = interrupt handler param (esp1 of the TSS)
+    mov esp, [esp]          ; esp = esp0 of the TSS, the kernel stack of the current task
+
+    push ecx                ; user esp
+    push edx                ; user eip
+    cld
+
+    cmp ebx, NUM_SYSCALLS
+    jae sysenter_return
+    mov ebx, [syscallHandlers+ebx*4]
+    test ebx, ebx
+    jz sysenter_return
+
+    push eax                ; eax
+    push esi                ; interrupt handler param
+    call ebx                ; the handler might switch to another task (see yieldTaskSwitchIntHandler), this task then
+                            ; continues here once it is switched back to (possibly on another cpu core)
+    add esp, 8
+
+sysenter_return:
+    pop edx
+    pop ecx
+    sti                     ; interrupts are only enabled after the next instruction, thus not before sysexit
+    sysexit
+
 global exc0
 global exc1
 global exc2
@@ -131,9 +182,23 @@ global custom4
 global custom5
 global custom6
 global custom7
+global custom8
+global custom9
+global custom10
+global custom11
+global custom12
+global custom13
+global custom14
+global custom15
 
 global custom32
 
+global lapic0
+global lapic1
+global lapic2
+global lapic3
+global lapic4
+
 ; 0: Divide By Zero Exception
 exc0:
     cli
@@ -497,12 +562,90 @@ custom7:
     push byte 55
     jmp call_handler
 
+custom8:
+    cli
+    push byte 0
+    push byte 56
+    jmp call_handler
+
+custom9:
+    cli
+    push byte 0
+    push byte 57
+    jmp call_handler
+
+custom10:
+    cli
+    push byte 0
+    push byte 58
+    jmp call_handler
+
+custom11:
+    cli
+    push byte 0
+    push byte 59
+    jmp call_handler
+
+custom12:
+    cli
+    push byte 0
+    push byte 60
+    jmp call_handler
+
+custom13:
+    cli
+    push byte 0
+    push byte 61
+    jmp call_handler
+
+custom14:
+    cli
+    push byte 0
+    push byte 62
+    jmp call_handler
+
+custom15:
+    cli
+    push byte 0
+    push byte 63
+    jmp call_handler
+
 custom32:
     cli
     push byte 0
     push byte 80
     jmp call_handler
 
+lapic0:
+    cli
+    push byte 0
+    push byte 64
+    jmp call_handler
+
+lapic1:
+    cli
+    push byte 0
+    push byte 65
+    jmp call_handler
+
+lapic2:
+    cli
+    push byte 0
+    push byte 66
+    jmp call_handler
+
+lapic3:
+    cli
+    push byte 0
+    push byte 67
+    jmp call_handler
+
+lapic4:
+    cli
+    push byte 0
+    push byte 68
+    jmp call_handler
+
 global createIntStackForUserPriv
 global createIntStackForKernelPriv
 
@@ -0,0 +1,78 @@
+#include "lapic.h"
+
+Lapic::Lapic(){}
+
+unsigned int Lapic::readRegister(unsigned int reg){
+    return *((volatile unsigned int*)(LAPIC_BASE_ADDR+reg));
+}
+
+void Lapic::writeRegister(unsigned int reg, unsigned int value){
+    *((volatile unsigned int*)(LAPIC_BASE_ADDR+reg)) = value;
+}
+
+void Lapic::bind(bool isBootstrapCore){
+    if(isBootstrapCore){
+        // LINT0 receives the interrupts of the legacy PIC (ExtINT delivery mode), LINT1 receives NMIs
+        writeRegister(LAPIC_LVT_LINT0_REGISTER, 0x700);
+        writeRegister(LAPIC_LVT_LINT1_REGISTER, 0x400);
+    }
+    else{
+        writeRegister(LAPIC_LVT_LINT0_REGISTER, 0x10000);
+        writeRegister(LAPIC_LVT_LINT1_REGISTER, 0x10000);
+    }
+
+    // Software enable the local APIC (bit 8)
+    writeRegister(LAPIC_SPURIOUS_INTERRUPT_VECTOR_REGISTER, 0x100 | LAPIC_SPURIOUS_INTERRUPT_VECTOR);
+}
+
+unsigned int Lapic::getLapicId(){
+    return readRegister(LAPIC_ID_REGISTER) >> 24;
+}
+
+void Lapic::sendIpi(unsigned int lapicId, unsigned int command){
+    writeRegister(LAPIC_INTERRUPT_COMMAND_REGISTER_HIGH, lapicId << 24);
+    // Writing the low part of the interrupt command register sends the IPI
+    writeRegister(LAPIC_INTERRUPT_COMMAND_REGISTER_LOW, command);
+
+    // Wait until the delivery status bit is cleared
+    while(readRegister(LAPIC_INTERRUPT_COMMAND_REGISTER_LOW) & (1 << 12)){
+        __asm__ __volatile__("pause");
+    }
+}
+
+void Lapic::sendInitIpi(unsigned int lapicId){
+    // Delivery mode INIT (0x500), level assert (0x4000)
+    sendIpi(lapicId, 0x4500);
+}
+
+void Lapic::sendStartupIpi(unsigned int lapicId, unsigned int startupAddr){
+    // Delivery mode startup (0x600), the vector is the page number of startupAddr
+    sendIpi(lapicId, 0x4600 | ((startupAddr >> 12) & 0xFF));
+}
+
+void Lapic::sendFixedIpi(unsigned int lapicId, unsigned int vector){
+    // Delivery mode fixed (0x000), level assert (0x4000)
+    sendIpi(lapicId, 0x4000 | (vector & 0xFF));
+}
+
+void Lapic::startTimer(unsigned int initialCount, bool periodic){
+    // Divide by 16
+    writeRegister(LAPIC_TIMER_DIVIDE_CONFIGURATION_REGISTER, 0x3);
+    // Timer mode in bits 17-18: 0 is one shot, 1 is periodic
+    writeRegister(LAPIC_LVT_TIMER_REGISTER, (periodic ? (1 << 17) : 0) | LAPIC_TIMER_VECTOR);
+    writeRegister(LAPIC_TIMER_INITIAL_COUNT_REGISTER, initialCount);
+}
+
+void Lapic::stopTimer(){
+    writeRegister(LAPIC_TIMER_INITIAL_COUNT_REGISTER, 0);
+    // Mask the timer interrupt
+    writeRegister(LAPIC_LVT_TIMER_REGISTER, 0x10000 | LAPIC_TIMER_VECTOR);
+}
+
+unsigned int Lapic::getTimerInitialCount(){
+    return readRegister(LAPIC_TIMER_INITIAL_COUNT_REGISTER);
+}
+
+unsigned int Lapic::getTimerCurrentCount(){
+    return readRegister(LAPIC_TIMER_CURRENT_COUNT_REGISTER);
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+// Every cpu core sees its own local APIC at the same (identity mapped) physical address
+#define LAPIC_BASE_ADDR 0xFEE00000
+
+#define LAPIC_ID_REGISTER 0x20
+#define LAPIC_EOI_REGISTER 0xB0
+#define LAPIC_SPURIOUS_INTERRUPT_VECTOR_REGISTER 0xF0
+#define LAPIC_INTERRUPT_COMMAND_REGISTER_LOW 0x300
+#define LAPIC_INTERRUPT_COMMAND_REGISTER_HIGH 0x310
+#define LAPIC_LVT_LINT0_REGISTER 0x350
+#define LAPIC_LVT_LINT1_REGISTER 0x360
+#define LAPIC_LVT_TIMER_REGISTER 0x320
+#define LAPIC_TIMER_INITIAL_COUNT_REGISTER 0x380
+#define LAPIC_TIMER_CURRENT_COUNT_REGISTER 0x390
+#define LAPIC_TIMER_DIVIDE_CONFIGURATION_REGISTER 0x3E0
+
+// Spurious interrupts of the local APIC shouldn't get an EOI, vector 47 (IRQ15) is already checked for being spurious
+#define LAPIC_SPURIOUS_INTERRUPT_VECTOR 47
+
+// Interrupts 64-79 are reserved for the local APIC, the interrupt handler sends the EOI to the local APIC instead of the 
+// legacy PIC for these
+#define LAPIC_TIMER_VECTOR 64
+// Sent by other cpu cores after they added tasks to the run queues of this cpu core
+#define LAPIC_RESCHEDULE_VECTOR 65
+// Vectors 66-68 are used by the network card and RTC interrupts from the I/O APIC (or MSI) and by loopback IPIs, see 
+// InterruptType
+
+class Lapic{
+        friend class CpuCore;
+        friend class Timer;
+
+    private:
+        Lapic();
+
+        static unsigned int readRegister(unsigned int reg);
+        static void writeRegister(unsigned int reg, unsigned int value);
+
+        void sendIpi(unsigned int lapicId, unsigned int command);
+
+        // The timer counts down at the bus frequency divided by 16, in periodic mode it restarts from initialCount once 
+        // it reaches 0, writing the initial count (re)starts the timer and writing 0 stops it
+        void startTimer(unsigned int initialCount, bool periodic);
+        void stopTimer();
+        unsigned int getTimerInitialCount();
+        unsigned int getTimerCurrentCount();
+
+    public:
+        // The legacy PIC is connected to LINT0 of the bootstrap core (virtual wire mode), the other cores ignore it
+        void bind(bool isBootstrapCore);
+
+        static unsigned int getLapicId();
+
+        // INIT-SIPI-SIPI sequence to start an application processor, startupAddr should be a page aligned address 
+        // below 1MB where the application processor will start executing in real mode
+        void sendInitIpi(unsigned int lapicId);
+        void sendStartupIpi(unsigned int lapicId, unsigned int startupAddr);
+        // Raises interrupt vector on the cpu core with this local APIC ID
+        // Important: should only be called with interrupts disabled
+        void sendFixedIpi(unsigned int lapicId, unsigned int vector);
+};
@@ -1,5 +1,6 @@
 #include "timer.h"
 #include "cpu_core.h"
+#include "timestamp_counter.h"
 #include "../global_resources/io/ports.h"
 #include "../../cpp_lib/atomic.h"
 #include "../global_resources/screen.h"
@@ -7,27 +8,143 @@
 void timerHandler(unsigned int interruptParam, unsigned int eax){
     Timer* pTimer = (Timer*)interruptParam;
 
+    if(pTimer->oneShotActive){
+        // The one shot has ended, go back to periodic interrupts
+        pTimer->elapsedTicks = pTimer->oneShotTicks;
+        pTimer->oneShotActive = false;
+        pTimer->startPeriodic();
+    }
+    else{
+        pTimer->elapsedTicks = 1;
+    }
+
     if(pTimer->pRunnable != nullptr){
         pTimer->pRunnable->run();
     }
 }
 
-Timer::Timer(unsigned int frequency)
+unsigned int Timer::lapicTimerFrequency = 0;
+unsigned int Timer::timestampCounterToNsMultiplier = 0;
+
+// 64-bit division would need libgcc, the caller makes sure that the quotient fits in 32 bits (dividend>>32 < divisor)
+static unsigned int divide64By32(unsigned long long dividend, unsigned int divisor){
+    unsigned int quotient;
+    unsigned int remainder;
+    __asm__ __volatile__("divl %4" : "=a"(quotient), "=d"(remainder) : "a"((unsigned int)dividend), "d"((unsigned int)(dividend >> 32)), "rm"(divisor));
+    return quotient;
+}
+
+Timer::Timer(unsigned int frequency, Lapic* pLapic)
     :
-    frequency((frequency==0 || frequency>1193182) ? 1 : frequency),
-    pRunnable(nullptr)
+    frequency((frequency==0 || frequency>PIT_FREQUENCY) ? 1 : frequency),
+    pLapic(pLapic),
+    useLapicTimer(false),
+    divider(0),
+    pRunnable(nullptr),
+    oneShotActive(false),
+    oneShotCount(0),
+    oneShotTicks(0),
+    elapsedTicks(0)
 {}
 
-void Timer::bind(){
-    unsigned int dividerInt = 1193182 / frequency;
-    unsigned short divider = (dividerInt>0xFFFF) ? 0xFFFF : (dividerInt & 0xFFFF);
+void Timer::calibrateLapicTimer(){
+    // Bit 0 of port 0x61 is the gate of PIT channel 2, bit 1 connects it to the speaker and bit 5 is its output
+    unsigned char port61 = portByteIn(0x61);
+    portByteOut(0x61, (port61 & 0xFD) | 0x01);
+
+    // Channel 2, lobyte/hibyte access, mode 0 (output goes high on terminal count)
+    unsigned int pitCount = PIT_FREQUENCY/LAPIC_TIMER_CALIBRATION_FREQUENCY;
+    portByteOut(0x43, 0xB0);
+    portByteOut(0x42, (unsigned char)(pitCount & 0xFF));
+    portByteOut(0x42, (unsigned char)((pitCount >> 8) & 0xFF));
+
+    // Count down from the maximum with the timer interrupt masked
+    Lapic::writeRegister(LAPIC_TIMER_DIVIDE_CONFIGURATION_REGISTER, 0x3);
+    Lapic::writeRegister(LAPIC_LVT_TIMER_REGISTER, 0x10000 | LAPIC_TIMER_VECTOR);
+    Lapic::writeRegister(LAPIC_TIMER_INITIAL_COUNT_REGISTER, 0xFFFFFFFF);
+    unsigned long long timestampCounterBegin = readTimestampCounter();
+
+    while((portByteIn(0x61) & 0x20)==0);
+
+    unsigned int lapicCount = 0xFFFFFFFF-Lapic::readRegister(LAPIC_TIMER_CURRENT_COUNT_REGISTER);
+    unsigned long long timestampCounterCycles = readTimestampCounter()-timestampCounterBegin;
+    Lapic::writeRegister(LAPIC_TIMER_INITIAL_COUNT_REGISTER, 0);
+    portByteOut(0x61, port61);
+
+    // The multiplier only fits in 32 bits if the timestamp counter runs faster than ~4MHz, which any cpu with a local 
+    // APIC does
+    unsigned long long calibrationNs = 1000000000/LAPIC_TIMER_CALIBRATION_FREQUENCY;
+    if(timestampCounterCycles > ((calibrationNs << TIMESTAMP_COUNTER_TO_NS_SHIFT) >> 32) && timestampCounterCycles <= 0xFFFFFFFF){
+        timestampCounterToNsMultiplier = divide64By32(calibrationNs << TIMESTAMP_COUNTER_TO_NS_SHIFT, (unsigned int)timestampCounterCycles);
+    }
+
+    // Not decrementing at all most likely means there is no usable local APIC timer, more than 0xFFFFFFFF counts per
+    // second can't be represented (at a bus frequency divided by 16 that is not expected)
+    if(lapicCount==0 || lapicCount>0xFFFFFFFF/LAPIC_TIMER_CALIBRATION_FREQUENCY){
+        lapicTimerFrequency = 0;
+        return;
+    }
+
+    lapicTimerFrequency = lapicCount*LAPIC_TIMER_CALIBRATION_FREQUENCY;
+}
+
+void Timer::startPeriodic(){
+    if(useLapicTimer){
+        pLapic->startTimer(divider, true);
+        return;
+    }
+
     unsigned char low  = (unsigned char)(divider & 0xFF);
     unsigned char high = (unsigned char)( (divider >> 8) & 0xFF);
 
     portByteOut(0x43, 0x36);
     portByteOut(0x40, low);
     portByteOut(0x40, high);
+}
+
+void Timer::programOneShot(unsigned int count){
+    oneShotCount = count;
+
+    if(useLapicTimer){
+        pLapic->startTimer(count, false);
+        return;
+    }
+
+    // Channel 0, lobyte/hibyte access, mode 0 (interrupt on terminal count), the counter starts once the high byte 
+    // is written
+    portByteOut(0x43, 0x30);
+    portByteOut(0x40, (unsigned char)(count & 0xFF));
+    portByteOut(0x40, (unsigned char)((count >> 8) & 0xFF));
+}
 
+bool Timer::getOneShotRemainingCount(unsigned int* remainingCount){
+    if(useLapicTimer){
+        // The current count stays 0 once the one shot ended, the interrupt is then already pending
+        unsigned int count = pLapic->getTimerCurrentCount();
+        if(count==0){
+            return false;
+        }
+        *remainingCount = count;
+        return true;
+    }
+
+    // Read-back command for channel 0 which latches both the status and the count
+    portByteOut(0x43, 0xC2);
+    unsigned char status = portByteIn(0x40);
+    unsigned char low = portByteIn(0x40);
+    unsigned char high = portByteIn(0x40);
+
+    // The output is high once the count reached 0, the interrupt is then already pending
+    if(status & 0x80){
+        return false;
+    }
+
+    // If the null count flag is set the count hasn't been loaded into the counter yet
+    *remainingCount = (status & 0x40) ? oneShotCount : (low | (high << 8));
+    return true;
+}
+
+void Timer::bind(){
     unsigned int cpuCoreId = CpuCore::getThisCpuCoreId();
     CpuCore* pCpuCore = CpuCore::getCpuCore(cpuCoreId);
 
@@ -37,11 +154,103 @@ void Timer::bind(){
         while(true);
     }
 
-    // TODO: APIC will have to be used in multicore environment so that each core gets it's own timer interrupts
-    pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(InterruptType::PITTimer, (unsigned int)this);
-    pCpuCore->getInterruptHandlerManager()->setInterruptHandler(InterruptType::PITTimer, timerHandler);
+    // The bootstrap core calibrates the local APIC timer, the local APIC timers of all cores run at the same frequency
+    bool isBootstrapCore = (cpuCoreId==0);
+    if(isBootstrapCore){
+        calibrateLapicTimer();
+    }
+
+    if(lapicTimerFrequency!=0){
+        useLapicTimer = true;
+        divider = lapicTimerFrequency/frequency;
+        if(divider==0){
+            divider = 1;
+        }
+
+        if(isBootstrapCore){
+            // The PIT is not needed anymore, a one shot with the maximal count interrupts once and then stays silent
+            portByteOut(0x43, 0x30);
+            portByteOut(0x40, 0xFF);
+            portByteOut(0x40, 0xFF);
+        }
+
+        pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(InterruptType::LapicTimer, (unsigned int)this);
+        pCpuCore->getInterruptHandlerManager()->setInterruptHandler(InterruptType::LapicTimer, timerHandler);
+    }
+    else if(isBootstrapCore){
+        useLapicTimer = false;
+        unsigned int dividerInt = PIT_FREQUENCY / frequency;
+        divider = (dividerInt>0xFFFF) ? 0xFFFF : dividerInt;
+
+        pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(InterruptType::PITTimer, (unsigned int)this);
+        pCpuCore->getInterruptHandlerManager()->setInterruptHandler(InterruptType::PITTimer, timerHandler);
+    }
+    else{
+        // Without local APIC timer only the bootstrap core receives timer interrupts
+        return;
+    }
+
+    startPeriodic();
 }
 
 void Timer::setTimerCallback(Runnable* pNewRunnable){
     atomicStore((unsigned int*)&pRunnable, (unsigned int)pNewRunnable);
 }
+
+unsigned int Timer::getElapsedTicks(){
+    return elapsedTicks;
+}
+
+void Timer::startOneShot(unsigned int numTicks){
+    if(oneShotActive || numTicks==0){
+        return;
+    }
+
+    if(numTicks>getMaxOneShotTicks()){
+        numTicks = getMaxOneShotTicks();
+    }
+
+    programOneShot(numTicks*divider);
+    oneShotTicks = numTicks;
+    oneShotActive = true;
+}
+
+unsigned int Timer::cancelOneShot(){
+    // A one shot of at most a single tick already ends at the next timer tick
+    if(!oneShotActive || oneShotTicks<=1){
+        return 0;
+    }
+
+    // Once the one shot ended the interrupt is already pending, it shouldn't report the ticks returned here a second time
+    unsigned int count;
+    if(!getOneShotRemainingCount(&count)){
+        unsigned int passedTicks = oneShotTicks;
+        oneShotTicks = 0;
+        return passedTicks;
+    }
+
+    unsigned int elapsedCount = (count<oneShotCount) ? (oneShotCount-count) : 0;
+
+    // Let the one shot end at the next tick boundary so that the timer ticks stay in phase with the original one shot
+    unsigned int passedTicks = elapsedCount/divider;
+    programOneShot(divider-(elapsedCount%divider));
+    oneShotTicks = 1;
+
+    return passedTicks;
+}
+
+bool Timer::isOneShotActive(){
+    return oneShotActive;
+}
+
+unsigned int Timer::getMaxOneShotTicks(){
+    if(useLapicTimer){
+        return 0xFFFFFFFF/divider;
+    }
+
+    return 0xFFFF/divider;
+}
+
+unsigned int Timer::getTimestampCounterToNsMultiplier(){
+    return timestampCounterToNsMultiplier;
+}
@@ -1,19 +1,70 @@
 #pragma once
 
 #include "../../cpp_lib/callback.h"
+#include "lapic.h"
 
-class Timer{    
+#define PIT_FREQUENCY 1193182
+// The local APIC timer is calibrated by counting how much it decrements while PIT channel 2 counts down
+// PIT_FREQUENCY/LAPIC_TIMER_CALIBRATION_FREQUENCY (10ms)
+#define LAPIC_TIMER_CALIBRATION_FREQUENCY 100
+// The timestamp counter is calibrated during the same 10ms, nanoseconds = (cycles*multiplier) >> TIMESTAMP_COUNTER_TO_NS_SHIFT
+#define TIMESTAMP_COUNTER_TO_NS_SHIFT 24
+
+class Timer{
         friend class CpuCore;
         friend void timerHandler(unsigned int interruptParam, unsigned int eax);
 
     private:
-        Timer(unsigned int frequency);
+        Timer(unsigned int frequency, Lapic* pLapic);
 
         unsigned int frequency;
+        Lapic* pLapic;
+        // Every core uses its local APIC timer once it has been calibrated (by the bootstrap core), otherwise only the
+        // bootstrap core gets timer interrupts from the PIT
+        bool useLapicTimer;
+        // Number of PIT or local APIC timer counts per timer tick
+        unsigned int divider;
         Runnable* pRunnable;
-    
+
+        // Local APIC timer counts per second, 0 if the local APIC timer could not be calibrated
+        static unsigned int lapicTimerFrequency;
+        static unsigned int timestampCounterToNsMultiplier;
+        static void calibrateLapicTimer();
+
+        // While a one shot is active the timer doesn't fire periodically but only once after oneShotCount counts, which
+        // corresponds to oneShotTicks timer ticks
+        bool oneShotActive;
+        unsigned int oneShotCount;
+        unsigned int oneShotTicks;
+        // Timer ticks which passed since the previous timer interrupt
+        unsigned int elapsedTicks;
+
+        void startPeriodic();
+        void programOneShot(unsigned int count);
+        // Returns false if the one shot already ended, otherwise remainingCount is set to the counts left
+        bool getOneShotRemainingCount(unsigned int* remainingCount);
+
     public:
+        // Important: the local APIC timer can only be programmed by the core it belongs to, so the methods below should 
+        // only be called on the cpu core which owns this timer
         void bind();
 
         void setTimerCallback(Runnable* pNewRunnable);
-};
\ No newline at end of file
+
+        // Only valid inside the timer callback, 1 unless the interrupt ended a one shot
+        unsigned int getElapsedTicks();
+
+        // Replaces the periodic interrupts by a single interrupt after numTicks timer ticks, after which the timer is
+        // periodic again (numTicks is limited by getMaxOneShotTicks)
+        // Important: should only be called with interrupts disabled
+        void startOneShot(unsigned int numTicks);
+        // Makes an active one shot end at the next timer tick instead, returns the number of timer ticks which already
+        // passed and thus won't be reported anymore by getElapsedTicks
+        // Important: should only be called with interrupts disabled
+        unsigned int cancelOneShot();
+        bool isOneShotActive();
+        unsigned int getMaxOneShotTicks();
+
+        // Returns 0 if the timestamp counter could not be calibrated
+        static unsigned int getTimestampCounterToNsMultiplier();
+};
@@ -0,0 +1,8 @@
+#include "timestamp_counter.h"
+
+unsigned long long readTimestampCounter(){
+    unsigned int low;
+    unsigned int high;
+    __asm__ __volatile__("rdtsc" : "=a"(low), "=d"(high));
+    return (((unsigned long long)high) << 32) | low;
+}
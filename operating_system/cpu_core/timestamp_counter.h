@@ -0,0 +1,4 @@
+#pragma once
+
+// Returns the number of cpu cycles since the cpu was reset (RDTSC instruction)
+unsigned long long readTimestampCounter();
@@ -12,6 +12,11 @@ void Tss::setEsp0(unsigned int newEsp0){
     tssEntry.esp0 = newEsp0;
 }
 
+unsigned int Tss::setupSysenterStack(unsigned int syscallHandlerParam){
+    tssEntry.esp1 = syscallHandlerParam;
+    return (unsigned int)&tssEntry.esp0;
+}
+
 void Tss::bind(){
     GdtEntry* gdtEntries = getGdtEntries();
 
@@ -25,6 +30,8 @@ void Tss::bind(){
     gdtEntries[5].base_middle = (base >> 16) & 0xFF;
     gdtEntries[5].base_high = (base >> 24 & 0xFF);
     gdtEntries[5].limit_low = limit & 0xFFFF;
+    // The gdt might have been copied from another cpu core which already marked this TSS entry as busy
+    gdtEntries[5].access = gdtEntries[5].access & ~0x02;
     gdtEntries[5].granularity = gdtEntries[5].granularity | ((limit >> 16) & 0x0F);
 
     flush_tss();
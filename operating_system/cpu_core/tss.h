@@ -41,4 +41,10 @@ class Tss{
     public:
         void bind();
         void setEsp0(unsigned int newEsp0);
+
+        // Writing the SYSENTER_ESP msr at every task switch would be slow, instead it points to esp0 (which is updated at
+        // every task switch) and the sysenter entry loads the kernel stack of the current task from there, esp1 isn't 
+        // used by the cpu (ring 1 isn't used) and holds syscallHandlerParam instead
+        // Returns the value for the SYSENTER_ESP msr, should be called after bind
+        unsigned int setupSysenterStack(unsigned int syscallHandlerParam);
 };
\ No newline at end of file
@@ -0,0 +1,180 @@
+#include "acpi_tables.h"
+
+#include "../../cpp_lib/placement_new.h"
+#include "../../cpp_lib/mem.h"
+#include "serial_log.h"
+#include "screen.h"
+
+// https://wiki.osdev.org/RSDP
+#define EBDA_SEGMENT_POINTER_ADDR 0x40E
+#define BIOS_AREA_BEGIN 0xE0000
+#define BIOS_AREA_END 0x100000
+
+#define ACPI_TABLE_HEADER_SIZE 36
+#define MADT_ENTRIES_OFFSET 44
+#define MADT_PROCESSOR_LAPIC_ENTRY 0
+#define MADT_IOAPIC_ENTRY 1
+#define MADT_INTERRUPT_SOURCE_OVERRIDE_ENTRY 2
+
+ACPITables* ACPITables::pACPITables = nullptr;
+
+ACPITables* ACPITables::getACPITables(){
+    return pACPITables;
+}
+
+void ACPITables::initialize(MemoryManager* pMemoryManager){
+    unsigned char* acpiTablesAddr = pMemoryManager->allocate(alignof(ACPITables), sizeof(ACPITables));
+    if(acpiTablesAddr == nullptr){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"Failed to allocate memory for ACPI tables!\n");
+        while(true);
+    }
+
+    pACPITables = new(acpiTablesAddr) ACPITables();
+}
+
+static bool checksumIsValid(unsigned char* pTable, unsigned int size){
+    unsigned char sum = 0;
+    for(unsigned int i=0; i<size; i++){
+        sum += pTable[i];
+    }
+    return sum==0;
+}
+
+ACPITables::ACPITables()
+    :
+    numProcessors(0),
+    ioapicAddr(0),
+    ioapicGsiBase(0)
+{
+    for(unsigned int i=0; i<NUM_ISA_IRQS; i++){
+        isaIrqGsis[i] = i;
+        isaIrqFlags[i] = 0;
+    }
+
+    unsigned char* pRSDP = findRSDP();
+    if(pRSDP==nullptr){
+        return;
+    }
+
+    unsigned char* pRSDT = (unsigned char*)(*((unsigned int*)(pRSDP+16)));
+    if(memCompare(pRSDT, (unsigned char*)"RSDT", 4)!=0 || !checksumIsValid(pRSDT, *((unsigned int*)(pRSDT+4)))){
+        return;
+    }
+
+    unsigned char* pMADT = findTable(pRSDT, (char*)"APIC");
+    if(pMADT!=nullptr){
+        parseMADT(pMADT);
+    }
+}
+
+unsigned char* ACPITables::findRSDP(){
+    // The RSDP is 16 byte aligned and either in the first KB of the extended BIOS data area or in the BIOS area
+    unsigned int ebdaAddr = ((unsigned int)(*((volatile unsigned short*)EBDA_SEGMENT_POINTER_ADDR))) << 4;
+    for(unsigned int addr=ebdaAddr; ebdaAddr!=0 && addr<ebdaAddr+1024; addr+=16){
+        if(memCompare((unsigned char*)addr, (unsigned char*)"RSD PTR ", 8)==0 && checksumIsValid((unsigned char*)addr, 20)){
+            return (unsigned char*)addr;
+        }
+    }
+
+    for(unsigned int addr=BIOS_AREA_BEGIN; addr<BIOS_AREA_END; addr+=16){
+        if(memCompare((unsigned char*)addr, (unsigned char*)"RSD PTR ", 8)==0 && checksumIsValid((unsigned char*)addr, 20)){
+            return (unsigned char*)addr;
+        }
+    }
+
+    return nullptr;
+}
+
+unsigned char* ACPITables::findTable(unsigned char* pRSDT, char signature[4]){
+    // The RSDT header is followed by 32-bit pointers to the other tables
+    unsigned int numTables = ((*((unsigned int*)(pRSDT+4)))-ACPI_TABLE_HEADER_SIZE)/4;
+    for(unsigned int i=0; i<numTables; i++){
+        unsigned char* pTable = (unsigned char*)(*((unsigned int*)(pRSDT+ACPI_TABLE_HEADER_SIZE+i*4)));
+        if(memCompare(pTable, (unsigned char*)signature, 4)==0 && checksumIsValid(pTable, *((unsigned int*)(pTable+4)))){
+            return pTable;
+        }
+    }
+
+    return nullptr;
+}
+
+void ACPITables::parseMADT(unsigned char* pMADT){
+    unsigned int madtSize = *((unsigned int*)(pMADT+4));
+
+    // Every entry starts with its type and its length
+    unsigned int offset = MADT_ENTRIES_OFFSET;
+    while(offset+2<=madtSize){
+        unsigned char entryType = pMADT[offset];
+        unsigned char entryLength = pMADT[offset+1];
+        if(entryLength<2){
+            break;
+        }
+
+        if(entryType==MADT_PROCESSOR_LAPIC_ENTRY && entryLength>=8){
+            // Processor ID (1 byte), APIC ID (1 byte), flags (4 bytes) of which bit 0 indicates the processor is enabled
+            unsigned char lapicId = pMADT[offset+3];
+            unsigned int flags = *((unsigned int*)(pMADT+offset+4));
+            if((flags & 0x1) && numProcessors<MAX_NUM_PROCESSORS){
+                processorLapicIds[numProcessors] = lapicId;
+                numProcessors++;
+            }
+        }
+        else if(entryType==MADT_IOAPIC_ENTRY && entryLength>=12 && ioapicAddr==0){
+            // I/O APIC ID (1 byte), reserved (1 byte), address (4 bytes), global system interrupt base (4 bytes)
+            ioapicAddr = *((unsigned int*)(pMADT+offset+4));
+            ioapicGsiBase = *((unsigned int*)(pMADT+offset+8));
+        }
+        else if(entryType==MADT_INTERRUPT_SOURCE_OVERRIDE_ENTRY && entryLength>=10){
+            // Bus (1 byte, always 0 for ISA), source IRQ (1 byte), global system interrupt (4 bytes), flags (2 bytes)
+            unsigned char sourceIrq = pMADT[offset+3];
+            if(sourceIrq<NUM_ISA_IRQS){
+                isaIrqGsis[sourceIrq] = *((unsigned int*)(pMADT+offset+4));
+                isaIrqFlags[sourceIrq] = *((unsigned short*)(pMADT+offset+8));
+            }
+        }
+
+        offset += entryLength;
+    }
+}
+
+unsigned int ACPITables::getNumProcessors(){
+    return numProcessors;
+}
+
+unsigned char ACPITables::getProcessorLapicId(unsigned int index){
+    if(index>=numProcessors) return 0;
+
+    return processorLapicIds[index];
+}
+
+unsigned int ACPITables::getIoapicAddr(){
+    return ioapicAddr;
+}
+
+unsigned int ACPITables::getIoapicGsiBase(){
+    return ioapicGsiBase;
+}
+
+unsigned int ACPITables::getIsaIrqGsi(unsigned int isaIrq){
+    if(isaIrq>=NUM_ISA_IRQS) return isaIrq;
+
+    return isaIrqGsis[isaIrq];
+}
+
+unsigned short ACPITables::getIsaIrqFlags(unsigned int isaIrq){
+    if(isaIrq>=NUM_ISA_IRQS) return 0;
+
+    return isaIrqFlags[isaIrq];
+}
+
+#if E2E_TESTING
+void ACPITables::logProcessors(){
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    for(unsigned int i=0; i<numProcessors; i++){
+        pSerialLog->log((char*)"ACPI: processor with lapic id ");
+        pSerialLog->log(processorLapicIds[i]);
+        pSerialLog->log((char*)"\n");
+    }
+}
+#endif
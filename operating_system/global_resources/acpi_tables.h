@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../../cpp_lib/memory_manager.h"
+
+#define MAX_NUM_PROCESSORS 32
+#define NUM_ISA_IRQS 16
+
+// The MADT (APIC description table) from the ACPI tables provided by the BIOS describes which processors (and thus which
+// local APICs) are present, where the I/O APIC is and to which of its inputs the legacy (ISA) IRQs are connected
+class ACPITables{
+    private:
+        static ACPITables* pACPITables;
+
+        ACPITables();
+
+        unsigned char* findRSDP();
+        unsigned char* findTable(unsigned char* pRSDT, char signature[4]);
+        void parseMADT(unsigned char* pMADT);
+
+        unsigned int numProcessors;
+        // Local APIC IDs of the enabled processors, this includes the bootstrap processor
+        unsigned char processorLapicIds[MAX_NUM_PROCESSORS];
+
+        // Only the first I/O APIC is used, ioapicAddr is 0 if there is none
+        unsigned int ioapicAddr;
+        unsigned int ioapicGsiBase;
+        // Global system interrupt (I/O APIC input) and MPS INTI flags (polarity in bits 0-1, trigger mode in bits 2-3) of
+        // every ISA IRQ, the IRQ is identity mapped with flags 0 (conforming to the bus) unless the MADT overrides it
+        unsigned int isaIrqGsis[NUM_ISA_IRQS];
+        unsigned short isaIrqFlags[NUM_ISA_IRQS];
+
+    public:
+        static ACPITables* getACPITables();
+        static void initialize(MemoryManager* pMemoryManager);
+
+        // Returns 0 if no MADT was found
+        unsigned int getNumProcessors();
+        unsigned char getProcessorLapicId(unsigned int index);
+
+        // Returns 0 if the MADT doesn't list an I/O APIC
+        unsigned int getIoapicAddr();
+        unsigned int getIoapicGsiBase();
+        unsigned int getIsaIrqGsi(unsigned int isaIrq);
+        unsigned short getIsaIrqFlags(unsigned int isaIrq);
+
+        #if E2E_TESTING
+        void logProcessors();
+        #endif
+};
@@ -4,6 +4,17 @@
 #define PCI_CONFIG_ADDRESS 0xCF8
 #define PCI_CONFIG_DATA 0xCFC
 
+#define PCI_STATUS_AND_COMMAND_OFFSET 0x4
+#define PCI_CAPABILITIES_POINTER_OFFSET 0x34
+#define PCI_STATUS_CAPABILITIES_LIST (1 << 20)
+#define PCI_COMMAND_INTERRUPT_DISABLE (1 << 10)
+#define PCI_MSI_CAPABILITY_ID 0x05
+// Bits of the message control register (upper half of the first dword of the MSI capability)
+#define PCI_MSI_ENABLE (1 << 16)
+#define PCI_MSI_MULTIPLE_MESSAGE_ENABLE (0x7 << 20)
+#define PCI_MSI_64_BIT_ADDRESS (1 << 23)
+#define MSI_ADDRESS_BASE 0xFEE00000
+
 unsigned int pciReadDword(unsigned char bus, unsigned char slot, unsigned char func, unsigned char offset){
 	unsigned int lbus  = (unsigned int)bus;
     unsigned int lslot = (unsigned int)slot;
@@ -21,4 +32,44 @@ void pciWriteDword(unsigned char bus, unsigned char slot, unsigned char func, un
     unsigned int address = (unsigned int)((lbus << 16) | (lslot << 11) | (lfunc << 8) | (offset & 0xfc) | ((unsigned int)0x80000000));
     portDwordOut((unsigned short)PCI_CONFIG_ADDRESS, address);
     portDwordOut((unsigned short)PCI_CONFIG_DATA, dword);
+}
+
+bool pciEnableMsi(unsigned char bus, unsigned char slot, unsigned char func, unsigned int lapicId, unsigned int vector){
+    unsigned int statusAndCommand = pciReadDword(bus, slot, func, PCI_STATUS_AND_COMMAND_OFFSET);
+    if((statusAndCommand & PCI_STATUS_CAPABILITIES_LIST)==0){
+        return false;
+    }
+
+    // Every capability starts with its ID and a pointer to the next capability (0 for the last one)
+    unsigned char capabilityOffset = pciReadDword(bus, slot, func, PCI_CAPABILITIES_POINTER_OFFSET) & 0xFC;
+    while(capabilityOffset!=0){
+        unsigned int capabilityHeader = pciReadDword(bus, slot, func, capabilityOffset);
+        if((capabilityHeader & 0xFF)==PCI_MSI_CAPABILITY_ID){
+            break;
+        }
+        capabilityOffset = (capabilityHeader >> 8) & 0xFC;
+    }
+    if(capabilityOffset==0){
+        return false;
+    }
+
+    // Message address (the local APIC ID goes in bits 12-19), followed by the upper half of the address for 64-bit
+    // capable devices and then the message data (the interrupt vector, fixed delivery mode and edge triggered)
+    unsigned int messageControl = pciReadDword(bus, slot, func, capabilityOffset);
+    pciWriteDword(bus, slot, func, capabilityOffset+4, MSI_ADDRESS_BASE | ((lapicId & 0xFF) << 12));
+    if(messageControl & PCI_MSI_64_BIT_ADDRESS){
+        pciWriteDword(bus, slot, func, capabilityOffset+8, 0);
+        pciWriteDword(bus, slot, func, capabilityOffset+12, vector & 0xFF);
+    }
+    else{
+        pciWriteDword(bus, slot, func, capabilityOffset+8, vector & 0xFF);
+    }
+    // A single message is enough
+    pciWriteDword(bus, slot, func, capabilityOffset, (messageControl & ~PCI_MSI_MULTIPLE_MESSAGE_ENABLE) | PCI_MSI_ENABLE);
+
+    // The interrupt pin isn't used anymore
+    statusAndCommand = pciReadDword(bus, slot, func, PCI_STATUS_AND_COMMAND_OFFSET);
+    pciWriteDword(bus, slot, func, PCI_STATUS_AND_COMMAND_OFFSET, (statusAndCommand & 0xFFFF) | PCI_COMMAND_INTERRUPT_DISABLE);
+
+    return true;
 }
\ No newline at end of file
@@ -1,4 +1,7 @@
 #pragma once
 
 unsigned int pciReadDword(unsigned char bus, unsigned char slot, unsigned char func, unsigned char offset);
-void pciWriteDword(unsigned char bus, unsigned char slot, unsigned char func, unsigned char offset, unsigned int dword);
\ No newline at end of file
+void pciWriteDword(unsigned char bus, unsigned char slot, unsigned char func, unsigned char offset, unsigned int dword);
+// Makes the device send its interrupts as message signaled interrupts (MSI) with this interrupt vector directly to the
+// local APIC with this ID instead of using its interrupt pin, returns false if the device doesn't support MSI
+bool pciEnableMsi(unsigned char bus, unsigned char slot, unsigned char func, unsigned int lapicId, unsigned int vector);
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "ioapic.h"
+#include "acpi_tables.h"
+#include "io/ports.h"
+#include "../../cpp_lib/placement_new.h"
+#include "serial_log.h"
+#include "screen.h"
+
+// Redirection entry bits
+#define IOAPIC_ACTIVE_LOW (1 << 13)
+#define IOAPIC_LEVEL_TRIGGERED (1 << 15)
+#define IOAPIC_MASKED (1 << 16)
+
+// MPS INTI flags of an interrupt source override, 00 means the polarity/trigger mode conforms to the bus
+#define MPS_INTI_POLARITY_MASK 0x3
+#define MPS_INTI_ACTIVE_HIGH 0x1
+#define MPS_INTI_ACTIVE_LOW 0x3
+#define MPS_INTI_TRIGGER_MODE_MASK 0xC
+#define MPS_INTI_EDGE_TRIGGERED 0x4
+#define MPS_INTI_LEVEL_TRIGGERED 0xC
+
+#define MASTER_PIC_DATA_PORT 0x21
+#define SLAVE_PIC_DATA_PORT 0xA1
+
+Ioapic* Ioapic::pIoapic = nullptr;
+
+Ioapic* Ioapic::getIoapic(){
+    return pIoapic;
+}
+
+void Ioapic::initialize(MemoryManager* pMemoryManager){
+    ACPITables* pACPITables = ACPITables::getACPITables();
+    if(pACPITables==nullptr || pACPITables->getIoapicAddr()==0){
+        return;
+    }
+
+    unsigned char* ioapicAddr = pMemoryManager->allocate(alignof(Ioapic), sizeof(Ioapic));
+    if(ioapicAddr == nullptr){
+        Screen* pScreen = Screen::getScreen();
+        pScreen->printk((char*)"Failed to allocate memory for the I/O APIC!\n");
+        while(true);
+    }
+
+    pIoapic = new(ioapicAddr) Ioapic(pACPITables->getIoapicAddr(), pACPITables->getIoapicGsiBase());
+}
+
+Ioapic::Ioapic(unsigned int baseAddr, unsigned int gsiBase)
+    :
+    baseAddr(baseAddr),
+    gsiBase(gsiBase)
+{
+    // Bits 16-23 of the version register contain the index of the last redirection entry
+    numInputs = ((readRegister(IOAPIC_VERSION_REGISTER) >> 16) & 0xFF)+1;
+
+    // Interrupts keep coming from the legacy PIC until they are routed here
+    for(unsigned int i=0; i<numInputs; i++){
+        writeRegister(IOAPIC_REDIRECTION_TABLE_REGISTER+2*i, IOAPIC_MASKED);
+    }
+
+    #if E2E_TESTING
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    pSerialLog->log((char*)"IOAPIC: number of inputs: ");
+    pSerialLog->log(numInputs);
+    pSerialLog->log((char*)"\n");
+    #endif
+}
+
+unsigned int Ioapic::readRegister(unsigned int reg){
+    *((volatile unsigned int*)(baseAddr+IOAPIC_REGISTER_SELECT)) = reg;
+    return *((volatile unsigned int*)(baseAddr+IOAPIC_REGISTER_WINDOW));
+}
+
+void Ioapic::writeRegister(unsigned int reg, unsigned int value){
+    *((volatile unsigned int*)(baseAddr+IOAPIC_REGISTER_SELECT)) = reg;
+    *((volatile unsigned int*)(baseAddr+IOAPIC_REGISTER_WINDOW)) = value;
+}
+
+unsigned int Ioapic::getBaseAddr(){
+    return baseAddr;
+}
+
+bool Ioapic::routeIsaIrq(unsigned int isaIrq, bool isPciInterrupt, unsigned int vector, unsigned int lapicId){
+    if(isaIrq>=NUM_ISA_IRQS){
+        return false;
+    }
+
+    ACPITables* pACPITables = ACPITables::getACPITables();
+    unsigned int gsi = pACPITables->getIsaIrqGsi(isaIrq);
+    if(gsi<gsiBase || gsi-gsiBase>=numInputs){
+        return false;
+    }
+    unsigned int input = gsi-gsiBase;
+
+    unsigned short flags = pACPITables->getIsaIrqFlags(isaIrq);
+    bool activeLow = isPciInterrupt;
+    if((flags & MPS_INTI_POLARITY_MASK)==MPS_INTI_ACTIVE_HIGH){
+        activeLow = false;
+    }
+    else if((flags & MPS_INTI_POLARITY_MASK)==MPS_INTI_ACTIVE_LOW){
+        activeLow = true;
+    }
+    bool levelTriggered = isPciInterrupt;
+    if((flags & MPS_INTI_TRIGGER_MODE_MASK)==MPS_INTI_EDGE_TRIGGERED){
+        levelTriggered = false;
+    }
+    else if((flags & MPS_INTI_TRIGGER_MODE_MASK)==MPS_INTI_LEVEL_TRIGGERED){
+        levelTriggered = true;
+    }
+
+    // Fixed delivery mode and physical destination mode (bits 8-11 are 0)
+    unsigned int redirectionEntryLow = vector & 0xFF;
+    if(activeLow){
+        redirectionEntryLow |= IOAPIC_ACTIVE_LOW;
+    }
+    if(levelTriggered){
+        redirectionEntryLow |= IOAPIC_LEVEL_TRIGGERED;
+    }
+
+    // Otherwise the interrupt would also still reach the bootstrap core through the legacy PIC
+    if(isaIrq<8){
+        portByteOut(MASTER_PIC_DATA_PORT, portByteIn(MASTER_PIC_DATA_PORT) | (1 << isaIrq));
+    }
+    else{
+        portByteOut(SLAVE_PIC_DATA_PORT, portByteIn(SLAVE_PIC_DATA_PORT) | (1 << (isaIrq-8)));
+    }
+
+    registerLock.lock();
+    // The destination is written first, the entry is only unmasked once it is complete
+    writeRegister(IOAPIC_REDIRECTION_TABLE_REGISTER+2*input, IOAPIC_MASKED);
+    writeRegister(IOAPIC_REDIRECTION_TABLE_REGISTER+2*input+1, lapicId << 24);
+    writeRegister(IOAPIC_REDIRECTION_TABLE_REGISTER+2*input, redirectionEntryLow);
+    registerLock.unlock();
+
+    #if E2E_TESTING
+    SerialLog* pSerialLog = SerialLog::getSerialLog();
+    pSerialLog->log((char*)"IOAPIC: IRQ ");
+    pSerialLog->log(isaIrq);
+    pSerialLog->log((char*)" sent to lapic id ");
+    pSerialLog->log(lapicId);
+    pSerialLog->log((char*)"\n");
+    #endif
+
+    return true;
+}
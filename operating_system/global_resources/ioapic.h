@@ -0,0 +1,49 @@
+#pragma once
+
+#include "../../cpp_lib/memory_manager.h"
+#include "../../cpp_lib/atomic.h"
+
+// The registers of the I/O APIC are accessed indirectly: the register number is written to IOREGSEL after which the
+// register can be read or written through IOWIN
+#define IOAPIC_REGISTER_SELECT 0x00
+#define IOAPIC_REGISTER_WINDOW 0x10
+
+#define IOAPIC_VERSION_REGISTER 0x01
+// Every input of the I/O APIC has a 64-bit redirection entry (two registers) starting at this register
+#define IOAPIC_REDIRECTION_TABLE_REGISTER 0x10
+
+// Unlike the legacy PIC (which only interrupts the bootstrap core), the I/O APIC can send each of its inputs as any
+// interrupt vector to any local APIC
+class Ioapic{
+    private:
+        static Ioapic* pIoapic;
+
+        Ioapic(unsigned int baseAddr, unsigned int gsiBase);
+
+        unsigned int readRegister(unsigned int reg);
+        void writeRegister(unsigned int reg, unsigned int value);
+
+        unsigned int baseAddr;
+        // Global system interrupt of the first input
+        unsigned int gsiBase;
+        unsigned int numInputs;
+
+        // Writing IOREGSEL and then IOWIN isn't atomic, different cpu cores might route interrupts at the same time
+        SpinLock registerLock;
+
+    public:
+        // Returns nullptr if the ACPI tables don't list an I/O APIC, interrupts then only come from the legacy PIC
+        static Ioapic* getIoapic();
+        // Should be called after ACPITables::initialize
+        static void initialize(MemoryManager* pMemoryManager);
+
+        unsigned int getBaseAddr();
+
+        // Sends legacy IRQ isaIrq as interrupt vector to the cpu core with this local APIC ID and masks it in the legacy
+        // PIC, the vector should be one of the local APIC vectors (64-79) since the EOI goes to the local APIC
+        // PCI interrupt lines are level triggered and active low (unless the ACPI tables say otherwise), ISA IRQs are
+        // edge triggered and active high
+        // Returns false if the IRQ isn't connected to this I/O APIC
+        // Important: should only be called with interrupts disabled
+        bool routeIsaIrq(unsigned int isaIrq, bool isPciInterrupt, unsigned int vector, unsigned int lapicId);
+};
@@ -7,6 +7,7 @@
 
 #include "serial_log.h"
 #include "screen.h"
+#include "ioapic.h"
 
 #include "../cpu_core/cpu_core.h"
 
@@ -121,6 +122,10 @@ void handlePhysicalNetworkInterfaceInterrupt(unsigned int interruptParam, unsign
 
             pPhysicalNetworkInterface->finishReadBuffer();
         }
+
+        // The received packets might have woken up the network management task, switch to it immediately instead of
+        // letting the packets wait until the next timer tick
+        CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->rescheduleIfRequested();
     }
 }
 
@@ -326,6 +331,8 @@ PhysicalNetworkInterface::PhysicalNetworkInterface()
     for(int i = 0; i < 0x80; i++) writeCommand(MULTICAST_TABLE_ARRAY_FIRST_REGISTER + i*4, 0);
     pScreen->printk((char*)"Linkup is done.\n");
 
+    pciBus = bus;
+    pciSlot = slot;
     interruptLine = pciReadDword(bus, slot, 0, MAX_LAT_MIN_GRANT_INT_PIN_INT_LINE_OFFSET) & 0xFF;
     pScreen->printk((char*)"Interrupt line is: ");
     pScreen->printk(interruptLine);
@@ -481,36 +488,70 @@ void PhysicalNetworkInterface::registerPacketHandler(Callable<Pair<unsigned char
     atomicStore((unsigned int*)&pPacketHandler, (unsigned int)pNewPacketHandler);
 
     if(!interruptsEnabled){
-        // Network card interrupts will be enabled on cpu core 0
-        CpuCore* pCpuCore = CpuCore::getCpuCore(0);
-        if(pCpuCore==nullptr){
-            Screen* pScreen = Screen::getScreen();
-            pScreen->printk((char*)"Failed to get cpu core 0 to enable network card interrupts\n");
-            while(true);
-        }
+        // Network card interrupts will be handled by the cpu core which registers the packet handler
+        CpuCore* pCpuCore = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId());
 
-        InterruptType interruptType;
-        switch(interruptLine){
-            case 9:
-                interruptType = InterruptType::Free1;
-                break;
-            case 10:
-                interruptType = InterruptType::Free2;
-                break;
-            case 11:
-                interruptType = InterruptType::Free3;
-                break;
-            default:
-                {
-                    Screen* pScreen = Screen::getScreen();
-                    pScreen->printk((char*)"Unknown interrupt line for network card\n");
-                    while(true);
+        class RouteNetworkCardInterrupts : public Runnable{
+            private:
+                PhysicalNetworkInterface* pPhysicalNetworkInterface;
+                CpuCore* pCpuCore;
+
+            public:
+                RouteNetworkCardInterrupts(PhysicalNetworkInterface* pPhysicalNetworkInterface, CpuCore* pCpuCore)
+                    :
+                    pPhysicalNetworkInterface(pPhysicalNetworkInterface),
+                    pCpuCore(pCpuCore)
+                {}
+
+                void run() override{
+                    InterruptHandlerManager* pInterruptHandlerManager = pCpuCore->getInterruptHandlerManager();
+
+                    // Preferably the network card sends its interrupts directly to the local APIC of the cpu core (MSI),
+                    // otherwise its interrupt line is routed there by the I/O APIC
+                    pInterruptHandlerManager->setInterruptHandlerParam(InterruptType::NetworkCardApic, (unsigned int)pPhysicalNetworkInterface);
+                    pInterruptHandlerManager->setInterruptHandler(InterruptType::NetworkCardApic, handlePhysicalNetworkInterfaceInterrupt);
+                    if(pciEnableMsi(pPhysicalNetworkInterface->pciBus, pPhysicalNetworkInterface->pciSlot, 0, pCpuCore->getLapicId(), (unsigned int)InterruptType::NetworkCardApic)){
+                        return;
+                    }
+                    Ioapic* pIoapic = Ioapic::getIoapic();
+                    if(pIoapic!=nullptr && pIoapic->routeIsaIrq(pPhysicalNetworkInterface->interruptLine, true, (unsigned int)InterruptType::NetworkCardApic, pCpuCore->getLapicId())){
+                        return;
+                    }
+
+                    // The legacy PIC only interrupts the bootstrap core
+                    if(pCpuCore!=CpuCore::getCpuCore(0)){
+                        Screen* pScreen = Screen::getScreen();
+                        pScreen->printk((char*)"Network card interrupts can only be sent to cpu core 0\n");
+                        while(true);
+                    }
+
+                    InterruptType interruptType;
+                    switch(pPhysicalNetworkInterface->interruptLine){
+                        case 9:
+                            interruptType = InterruptType::Free1;
+                            break;
+                        case 10:
+                            interruptType = InterruptType::Free2;
+                            break;
+                        case 11:
+                            interruptType = InterruptType::Free3;
+                            break;
+                        default:
+                            {
+                                Screen* pScreen = Screen::getScreen();
+                                pScreen->printk((char*)"Unknown interrupt line for network card\n");
+                                while(true);
+                            }
+                            break;
+                    }
+
+                    pInterruptHandlerManager->setInterruptHandlerParam(interruptType, (unsigned int)pPhysicalNetworkInterface);
+                    pInterruptHandlerManager->setInterruptHandler(interruptType, handlePhysicalNetworkInterfaceInterrupt);
                 }
-                break;
-        }
+        };
 
-        pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(interruptType, (unsigned int)this);
-        pCpuCore->getInterruptHandlerManager()->setInterruptHandler(interruptType, handlePhysicalNetworkInterfaceInterrupt);
+        RouteNetworkCardInterrupts routeNetworkCardInterrupts(this, pCpuCore);
+        pCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(routeNetworkCardInterrupts);
 
         class NetworkCardEnableInterrupts : public Runnable{
             private:
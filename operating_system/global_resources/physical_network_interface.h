@@ -96,6 +96,7 @@ typedef struct e1000TxDescTCPIPData{
 class PhysicalNetworkInterface : public NetworkInterface{
         friend void handlePhysicalNetworkInterfaceInterrupt(unsigned int interruptParam, unsigned int eax);
         friend class NetworkCardEnableInterrupts;
+        friend class RouteNetworkCardInterrupts;
 
     private:
         static PhysicalNetworkInterface* pPhysicalNetworkInterface;
@@ -122,6 +123,9 @@ class PhysicalNetworkInterface : public NetworkInterface{
         bool usingMemMappedRegisters;
 
         unsigned char mac[6];
+        unsigned char pciBus;
+        unsigned char pciSlot;
+        // Legacy IRQ of the network card, only used if the network card doesn't support MSI
         unsigned int interruptLine;
 
         unsigned int currentRx = 0;
@@ -4,6 +4,9 @@
 #include "screen.h"
 #include "../cpu_core/cpu_core.h"
 #include "../../cpp_lib/atomic.h"
+#include "ioapic.h"
+
+#define RTC_IRQ 8
 
 #define REGISTER_NUMBER_SPECIFIER_PORT 0x70
 #define REGISTER_READER_WRITER_PORT 0x71
@@ -67,13 +70,7 @@ void RTCTimer::setTimerFrequency(unsigned int frequency){
         }
     }
 
-    // RTCTimer interrupts will be handled by the CPU core 0
-    CpuCore* pCpuCore = CpuCore::getCpuCore(0);
-    if(pCpuCore == nullptr){
-        Screen* pScreen = Screen::getScreen();
-        pScreen->printk((char*)"Failed to get CPU core 0!\n");
-        while(true);
-    }
+    CpuCore* pCpuCore = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId());
 
     class ChangeRTCTimerRate : public Runnable{
         private:
@@ -106,16 +103,47 @@ void RTCTimer::setTimerCallback(Runnable* pNewRunnable){
     atomicStore((unsigned int*)&pRunnable, (unsigned int)pNewRunnable);
 
     if(!interruptsEnabled){
-        // RTCTimer interrupts will be handled by the CPU core 0
-        CpuCore* pCpuCore = CpuCore::getCpuCore(0);
-        if(pCpuCore == nullptr){
-            Screen* pScreen = Screen::getScreen();
-            pScreen->printk((char*)"Failed to get CPU core 0!\n");
-            while(true);
-        }
-
-        pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(InterruptType::RTCTimer, (unsigned int)this);
-        pCpuCore->getInterruptHandlerManager()->setInterruptHandler(InterruptType::RTCTimer, rtcTimerInterruptHandler);
+        // RTCTimer interrupts will be handled by the cpu core which sets the callback
+        CpuCore* pCpuCore = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId());
+
+        class RouteRTCTimerInterrupts : public Runnable{
+            private:
+                RTCTimer* pRTCTimer;
+                CpuCore* pCpuCore;
+
+            public:
+                RouteRTCTimerInterrupts(RTCTimer* pRTCTimer, CpuCore* pCpuCore)
+                    :
+                    pRTCTimer(pRTCTimer),
+                    pCpuCore(pCpuCore)
+                {}
+
+                void run() override{
+                    InterruptHandlerManager* pInterruptHandlerManager = pCpuCore->getInterruptHandlerManager();
+
+                    Ioapic* pIoapic = Ioapic::getIoapic();
+                    if(pIoapic!=nullptr){
+                        pInterruptHandlerManager->setInterruptHandlerParam(InterruptType::RTCTimerApic, (unsigned int)pRTCTimer);
+                        pInterruptHandlerManager->setInterruptHandler(InterruptType::RTCTimerApic, rtcTimerInterruptHandler);
+                        if(pIoapic->routeIsaIrq(RTC_IRQ, false, (unsigned int)InterruptType::RTCTimerApic, pCpuCore->getLapicId())){
+                            return;
+                        }
+                    }
+
+                    // The legacy PIC only interrupts the bootstrap core
+                    if(pCpuCore!=CpuCore::getCpuCore(0)){
+                        Screen* pScreen = Screen::getScreen();
+                        pScreen->printk((char*)"RTC timer interrupts can only be sent to cpu core 0\n");
+                        while(true);
+                    }
+
+                    pInterruptHandlerManager->setInterruptHandlerParam(InterruptType::RTCTimer, (unsigned int)pRTCTimer);
+                    pInterruptHandlerManager->setInterruptHandler(InterruptType::RTCTimer, rtcTimerInterruptHandler);
+                }
+        };
+
+        RouteRTCTimerInterrupts routeRTCTimerInterrupts(this, pCpuCore);
+        pCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(routeRTCTimerInterrupts);
 
         interruptsEnabled = true;
         allowNextInterrupt();
@@ -24,5 +24,6 @@ class RTCTimer{
         // but should be a power of 2
         void setTimerFrequency(unsigned int frequency);
 
+        // The interrupts are sent to the cpu core which sets the first callback
         void setTimerCallback(Runnable* pNewRunnable);
 };
\ No newline at end of file
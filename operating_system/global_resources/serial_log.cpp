@@ -24,6 +24,10 @@ void SerialLog::initialize(MemoryManager* pMemoryManager){
 }
 
 SerialLog::SerialLog(){
+    for(unsigned int i=0; i<NUM_CPU_CORES; i++){
+        lineBufferLengths[i] = 0;
+    }
+
     //https://wiki.osdev.org/Serial_Ports
     portByteOut(SERIAL_LOG_PORT + 1, 0x00);    // Disable all interrupts
     portByteOut(SERIAL_LOG_PORT + 3, 0x80);    // Enable DLAB (set baud rate divisor)
@@ -38,15 +42,43 @@ SerialLog::SerialLog(){
     pScreen->printk((char*)"The LogManager was successfully initialized.\n");
 }
 
+void SerialLog::writeLine(char* line, unsigned int length){
+    logLock.lock();
+
+    for(unsigned int i=0; i<length; i++){
+        // Check if the transmission buffer is empty
+        while((portByteIn(SERIAL_LOG_PORT+5) & 0x20)==0);
+
+        portByteOut(SERIAL_LOG_PORT, line[i]);
+    }
+
+    logLock.unlock();
+}
+
 void SerialLog::log(char* message){
+    // The line buffer of this cpu core (and the lock) shouldn't be used by an interrupt handler halfway through
+    unsigned int eflags;
+    __asm__ __volatile__("pushf; pop %0; cli" : "=r"(eflags) :: "memory");
+
+    unsigned int cpuCoreId = CpuCore::getThisCpuCoreId();
+    char* lineBuffer = lineBuffers[cpuCoreId];
+    unsigned int* pLineBufferLength = &lineBufferLengths[cpuCoreId];
+
     int i=0;
     while(message[i]!='\0'){
-        // Check if the transmission buffer is empty
-        while((portByteIn(SERIAL_LOG_PORT+5) & 0x20)==0);
+        lineBuffer[*pLineBufferLength] = message[i];
+        (*pLineBufferLength)++;
 
-        portByteOut(SERIAL_LOG_PORT, message[i]);
+        if(message[i]=='\n' || *pLineBufferLength==SERIAL_LOG_LINE_BUFFER_SIZE){
+            writeLine(lineBuffer, *pLineBufferLength);
+            *pLineBufferLength = 0;
+        }
         i++;
     }
+
+    if(eflags & (1 << 9)){
+        __asm__ __volatile__("sti" ::: "memory");
+    }
 }
 
 void SerialLog::log(int a){
@@ -75,9 +107,7 @@ void SerialLog::logHex(unsigned long long a){
 
         int numMissingZeros = 8-strlen(lowerAAsHexadecimalString);
         for(int i=0; i<numMissingZeros; i++){
-            while((portByteIn(SERIAL_LOG_PORT+5) & 0x20)==0);
-
-            portByteOut(SERIAL_LOG_PORT, '0');
+            log((char*)"0");
         }
     }
 
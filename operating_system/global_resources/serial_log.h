@@ -1,6 +1,11 @@
 #pragma once
 
 #include "../../cpp_lib/memory_manager.h"
+#include "../../cpp_lib/atomic.h"
+#include "../cpu_core/cpu_core.h"
+
+// Longer lines are written in parts
+#define SERIAL_LOG_LINE_BUFFER_SIZE 128
 
 class SerialLog{
     private:
@@ -8,10 +13,18 @@ class SerialLog{
 
         SerialLog();
 
+        // Every cpu core collects its messages until a full line can be written, this way lines logged by different
+        // cpu cores at the same time aren't mixed up
+        char lineBuffers[NUM_CPU_CORES][SERIAL_LOG_LINE_BUFFER_SIZE];
+        unsigned int lineBufferLengths[NUM_CPU_CORES];
+        SpinLock logLock;
+        void writeLine(char* line, unsigned int length);
+
     public:
         static SerialLog* getSerialLog();
         static void initialize(MemoryManager* pMemoryManager);
 
+        // A line is only written once its newline is logged
         void log(char* message);
         void log(int a);
         void logHex(unsigned int a);
@@ -7,6 +7,8 @@
 #include "../../cpp_lib/memory_manager.h"
 #include "../paging/paging_structures.h"
 #include "../global_resources/bios_map.h"
+#include "../global_resources/acpi_tables.h"
+#include "../global_resources/ioapic.h"
 #include "../global_resources/physical_network_interface.h"
 #include "../global_resources/serial_log.h"
 #include "../global_resources/rtc_timer.h"
@@ -32,6 +34,8 @@ void main(){
     #endif
     PhysicalNetworkInterface::initialize(&memoryManager);
     BIOSMap::initialize(&memoryManager);
+    ACPITables::initialize(&memoryManager);
+    Ioapic::initialize(&memoryManager);
 
     // Clear the screen
     Screen* pScreen = Screen::getScreen();
@@ -53,12 +57,13 @@ void main(){
     }
 
     // Allocate memory for the kernel paging structures
+    // Kernel space is mapped the same way by every task and thus uses global pages, which stay in the TLB on task switches
     unsigned char* kernelPagingStructuresAddr = memoryManager.allocate(alignof(PagingStructures), sizeof(PagingStructures));
     if(kernelPagingStructuresAddr == nullptr){
         pScreen->printk((char*)"Failed to allocate memory for KernelPagingStructures\n");
         while(1);
     }
-    PagingStructures* pKernelPagingStructures = new(kernelPagingStructuresAddr) PagingStructures();
+    PagingStructures* pKernelPagingStructures = new(kernelPagingStructuresAddr) PagingStructures(NUM_PAGE_TABLES_FOR_KERNEL);
 
     // Create coarsed grained memory allocator using the kernel paging structures
     // Unlike the memoryManager, this allocator is meant for allocating full pages and doesn't waste memory
@@ -97,6 +102,13 @@ void main(){
 
         pageAllocator.allocatePageRange(PhysicalNetworkInterfaceMMIOPageIndex, PhysicalNetworkInterfaceMMIOPageIndex);
     }
+    // Register the memory used by the local APIC registers as used memory in the pageAllocator
+    pageAllocator.allocatePageRange(LAPIC_BASE_ADDR/0x1000, LAPIC_BASE_ADDR/0x1000);
+    // Register the memory used by the I/O APIC registers as used memory in the pageAllocator
+    Ioapic* pIoapic = Ioapic::getIoapic();
+    if(pIoapic!=nullptr){
+        pageAllocator.allocatePageRange(pIoapic->getBaseAddr()/0x1000, pIoapic->getBaseAddr()/0x1000);
+    }
     #if E2E_TESTING
     pageAllocator.logState();
     #endif
@@ -107,7 +119,7 @@ void main(){
         pScreen->printk((char*)"Failed to allocate memory for SocketManager\n");
         while(1);
     }
-    SocketManager* pSocketManager = new(socketManagerAddr) SocketManager();
+    SocketManager* pSocketManager = new(socketManagerAddr) SocketManager(&memoryManager);
 
     // Allocate a cpu core
     unsigned char* cpuCoreAddr = memoryManager.allocate(alignof(CpuCore), sizeof(CpuCore));
@@ -117,7 +129,8 @@ void main(){
     }
     CpuCore* pCpuCore = new(cpuCoreAddr) CpuCore(pSocketManager, 
         pKernelPagingStructures->getPageDirectory()->getPhysicalAddr(),
-        &pageAllocator);
+        &pageAllocator,
+        &memoryManager);
 
     // Bind to the CpuCore => sets up interrupts, paging, task switching
     pCpuCore->bind();
@@ -142,6 +155,9 @@ void main(){
             {}
 
             void run() override{
+                // Start the other cpu cores first, the kernel tasks run on this core
+                pCpuCore->startApplicationProcessors(pMemoryManager);
+
                 TaskArguments osManagementTaskArguments = {};
                 osManagementTaskArguments.args[0] = (unsigned int)pSocketManager;
                 osManagementTaskArguments.args[1] = (unsigned int)pMemoryManager;
@@ -151,14 +167,24 @@ void main(){
                 osManagementKernelTask.setProcessCode(pOsManagementTaskCode, osManagementTaskArguments);
                 osManagementKernelTask.setToRunningState();
 
+                // The network management task gets its own cpu core (the last one) which also handles the interrupts of
+                // the network interfaces, this way packets don't interrupt user tasks, unless the interrupts can only come 
+                // from the legacy PIC (which only interrupts this cpu core) or there is no other cpu core for user tasks
+                CpuCore* pNetworkCpuCore = pCpuCore;
+                if(Ioapic::getIoapic()!=nullptr && CpuCore::getNumCpuCores()>1){
+                    pNetworkCpuCore = CpuCore::getCpuCore(CpuCore::getNumCpuCores()-1);
+                    pNetworkCpuCore->reserveForKernelTasks();
+                }
+
                 TaskArguments networkManagementTaskArguments = {};
-                networkManagementTaskArguments.args[0] = (unsigned int)pCpuCore;
+                networkManagementTaskArguments.args[0] = (unsigned int)pNetworkCpuCore;
                 networkManagementTaskArguments.args[1] = (unsigned int)pSocketManager;
                 networkManagementTaskArguments.args[2] = (unsigned int)pMemoryManager;
                 networkManagementTaskArguments.numArgs = 3;
 
                 unsigned int* pNetworkManagementTaskCode = (unsigned int*)networkManagementTask;
                 networkManagementKernelTask.setProcessCode(pNetworkManagementTaskCode, networkManagementTaskArguments);
+                networkManagementKernelTask.setRunningCpuCore(pNetworkCpuCore);
                 networkManagementKernelTask.setToRunningState();
             }
     };
@@ -173,6 +199,9 @@ void main(){
     while(1){
         #if E2E_TESTING
         e2eTestingLog(10);
+        #else
+        // No need to keep the cpu busy until the first timer interrupt switches to another task
+        __asm__ __volatile__("hlt" ::: "memory");
         #endif
     }
 }
\ No newline at end of file
@@ -18,9 +18,10 @@ void handleLoopbackInterfaceInterrupt(unsigned int interruptParam, unsigned int
     }
 }
 
-LoopbackNetworkInterface::LoopbackNetworkInterface(InterruptType interruptLine, InterruptTrigger interruptTrigger, unsigned char mac[6])
+LoopbackNetworkInterface::LoopbackNetworkInterface(InterruptType interruptLine, InterruptType ipiInterruptLine, InterruptTrigger interruptTrigger, unsigned char mac[6])
     :
     interruptLine(interruptLine),
+    ipiInterruptLine(ipiInterruptLine),
     interruptTrigger(interruptTrigger),
     pPacketHandler(nullptr),
     interruptsEnabled(false)
@@ -43,16 +44,13 @@ void LoopbackNetworkInterface::registerPacketHandler(Callable<Pair<unsigned char
     atomicStore((unsigned int*)&pPacketHandler, (unsigned int)pNewPacketHandler);
 
     if(!interruptsEnabled){
-        // Network card interrupts will be enabled on cpu core 0
-        CpuCore* pCpuCore = CpuCore::getCpuCore(0);
-        if(pCpuCore==nullptr){
-            Screen* pScreen = Screen::getScreen();
-            pScreen->printk((char*)"Failed to get cpu core 0 to enable network card interrupts\n");
-            while(true);
-        }
+        // Loopback interrupts will be handled by the cpu core which registers the packet handler
+        CpuCore* pCpuCore = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId());
 
         pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(interruptLine, (unsigned int)this);
         pCpuCore->getInterruptHandlerManager()->setInterruptHandler(interruptLine, handleLoopbackInterfaceInterrupt);
+        pCpuCore->getInterruptHandlerManager()->setInterruptHandlerParam(ipiInterruptLine, (unsigned int)this);
+        pCpuCore->getInterruptHandlerManager()->setInterruptHandler(ipiInterruptLine, handleLoopbackInterfaceInterrupt);
 
         interruptsEnabled = true;
     }
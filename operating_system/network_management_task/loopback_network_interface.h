@@ -20,6 +20,7 @@ class LoopbackNetworkInterface : public NetworkInterface{
 
         unsigned char mac[6];
         InterruptType interruptLine;
+        InterruptType ipiInterruptLine;
         InterruptTrigger interruptTrigger;
 
         // One single buffer is sufficient because incoming packets will be handled immediately
@@ -33,7 +34,9 @@ class LoopbackNetworkInterface : public NetworkInterface{
         Callable<Pair<unsigned char*, unsigned int>>* pPacketHandler;
 
     public:
-        LoopbackNetworkInterface(InterruptType interruptLine, InterruptTrigger interruptTrigger, unsigned char mac[6]);
+        // Received packets are handled by the cpu core which registers the packet handler, interruptTrigger should raise 
+        // interruptLine when it is called on that cpu core and send ipiInterruptLine to it as an IPI otherwise
+        LoopbackNetworkInterface(InterruptType interruptLine, InterruptType ipiInterruptLine, InterruptTrigger interruptTrigger, unsigned char mac[6]);
 
         unsigned char* getMac() override;
         
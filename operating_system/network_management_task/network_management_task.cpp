@@ -21,18 +21,94 @@
 #define LOINT_ARP_HASH_TABLE_SIZE 1
 #define LOINT_ARP_HASH_ENTRY_LIST_SIZE 1
 
-// TODO: ideally in multi-core environment this function should trigger an IPI to a specific core
-// Different cores all handling this interrupt will definitely result concurrency issues 
-// for the LoopbackNetworkInterface and its NetworkStackHandler
+// Cpu core which runs the network management task and handles the loopback interrupts
+static CpuCore* pNetworkCpuCore = nullptr;
+
+// Different cores all handling this interrupt would result in concurrency issues for the LoopbackNetworkInterface and
+// its NetworkStackHandler, thus other cpu cores send an IPI to the network cpu core
+// On the network cpu core itself the packets are handled immediately with a software interrupt, the loopback buffers
+// are then empty again before the next packet is written
 void loopbackInterfaceInterruptTrigger(){
-    __asm__ __volatile__(
-        ".intel_syntax noprefix;"
-        "int 80;"
-        ".att_syntax;"
-        ::: "memory");
+    CpuCore* pThisCpuCore = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId());
+    if(pThisCpuCore==pNetworkCpuCore){
+        __asm__ __volatile__(
+            ".intel_syntax noprefix;"
+            "int 80;"
+            ".att_syntax;"
+            ::: "memory");
+    }
+    else{
+        pThisCpuCore->sendIpi(pNetworkCpuCore, InterruptType::LoopbackIpi);
+    }
+}
+
+// Sends fragments of the UDP packet until it is done, until it waits on an ARP reply or until the network card buffers are
+// full, fragmentOffset and identification keep track of how far the packet got
+// Returns false if the network card buffers are full
+static bool sendOutgoingUDPPacket(
+    OutgoingUDPPacket& outgoingUDPPacket,
+    unsigned int& fragmentOffset,
+    unsigned short& identification,
+    NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pPhysicalNetworkStackHandler,
+    NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pLoopbackNetworkStackHandler,
+    PhysicalNetworkInterface* pPhysicalNetworkInterface,
+    LoopbackNetworkInterface* pLoopbackNetworkInterface
+){
+    NetworkInterface* pNetworkInterface = outgoingUDPPacket.destinationIP==
+        #ifdef THIS_IP
+            THIS_IP
+        #else
+            0
+        #endif
+        ? (NetworkInterface*)pLoopbackNetworkInterface : (NetworkInterface*)pPhysicalNetworkInterface;
+    unsigned char* writeBuffer = pNetworkInterface->getWriteBuffer();
+    Pair<IPv4PacketProgress, unsigned int> state;
+
+    while(writeBuffer!=nullptr){
+        if(outgoingUDPPacket.dataLen==0){
+            break;
+        }
+
+        if(fragmentOffset==0){
+            unsigned char* udpHeader = outgoingUDPPacket.data;
+            udpHeader[0] = outgoingUDPPacket.sourcePort >> 8;
+            udpHeader[1] = outgoingUDPPacket.sourcePort & 0xFF;
+            udpHeader[2] = outgoingUDPPacket.destinationPort >> 8;
+            udpHeader[3] = outgoingUDPPacket.destinationPort & 0xFF;
+            udpHeader[4] = outgoingUDPPacket.dataLen >> 8;
+            udpHeader[5] = outgoingUDPPacket.dataLen & 0xFF;
+            udpHeader[6] = 0x00;
+            udpHeader[7] = 0x00;
+        }
+
+        if(pNetworkInterface==pPhysicalNetworkInterface){
+            state = pPhysicalNetworkStackHandler->handleOutgoingIPv4Packet(
+                outgoingUDPPacket.destinationIP, outgoingUDPPacket.sourcePort, outgoingUDPPacket.destinationPort, UDP_IPV4_PROTOCOL, 
+                outgoingUDPPacket.data, outgoingUDPPacket.dataLen, identification, fragmentOffset, writeBuffer);    
+        }
+        else if(pNetworkInterface==pLoopbackNetworkInterface){
+            state = pLoopbackNetworkStackHandler->handleOutgoingIPv4Packet(
+                outgoingUDPPacket.destinationIP, outgoingUDPPacket.sourcePort, outgoingUDPPacket.destinationPort, UDP_IPV4_PROTOCOL, 
+                outgoingUDPPacket.data, outgoingUDPPacket.dataLen, identification, fragmentOffset, writeBuffer);
+        }
+        
+        if(state.second>0){
+            bool usesIPv4Context = state.first==IPv4PacketProgress::Done || state.first==IPv4PacketProgress::SendingFragment;
+            pNetworkInterface->finishWriteBuffer(state.second, usesIPv4Context);
+            writeBuffer = pNetworkInterface->getWriteBuffer();
+        }
+
+        if(state.first==IPv4PacketProgress::WaitingOnARPReply || state.first==IPv4PacketProgress::ARPTableFull || state.first==IPv4PacketProgress::Done){
+            break;
+        }
+    }
+
+    return writeBuffer!=nullptr;
 }
 
 void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager, MemoryManager* pMemoryManager){
+    pNetworkCpuCore = pThisCpuCore;
+
     PhysicalNetworkInterface* pPhysicalNetworkInterface = PhysicalNetworkInterface::getPhysicalNetworkInterface();
 
     // Allocate a NetworkStackHandler for the PhysicalNetworkInterface
@@ -76,7 +152,7 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
         while(1);
     }
     LoopbackNetworkInterface* pLoopbackNetworkInterface = new(loopbackNetworkInterfaceAddr) LoopbackNetworkInterface(
-        InterruptType::Int80, loopbackInterfaceInterruptTrigger, loopbackMac);
+        InterruptType::Int80, InterruptType::LoopbackIpi, loopbackInterfaceInterruptTrigger, loopbackMac);
     
     // Allocate a NetworkStackHandler for the LoopbackNetworkInterface
     unsigned char* loopbackNetworkStackHandlerAddr = pMemoryManager->allocate(
@@ -113,10 +189,14 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
     class PhysicalNetworkInterfacePacketHandler : public Callable<Pair<unsigned char*, unsigned int>>{
         private:
             NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pNetworkStackHandler;
+            CpuCore* pCpuCore;
+            WaitQueue* pNetworkEventWaitQueue;
 
         public:
-            PhysicalNetworkInterfacePacketHandler(NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pNetworkStackHandler){
+            PhysicalNetworkInterfacePacketHandler(NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pNetworkStackHandler, CpuCore* pCpuCore, WaitQueue* pNetworkEventWaitQueue){
                 this->pNetworkStackHandler = pNetworkStackHandler;
+                this->pCpuCore = pCpuCore;
+                this->pNetworkEventWaitQueue = pNetworkEventWaitQueue;
             }
 
             void call(Pair<unsigned char*, unsigned int> packet){
@@ -126,6 +206,12 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                 PacketType packetType = pNetworkStackHandler->handleIncomingEthernetPacket(readBuffer, readBufferLen);
 
                 switch(packetType){
+                    // The network management task only needs to be woken up for IPv4 packets and ARP replies (which
+                    // might allow pending transmission requests to continue)
+                    case PacketType::IPv4Packet:
+                    case PacketType::ARPReply:
+                        pCpuCore->wakeUpAll(pNetworkEventWaitQueue);
+                        break;
                     // ARP requests can easily be handled so let's just do that immediately in the interrupthandler
                     case PacketType::ARPRequest:
                         {
@@ -146,7 +232,7 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
         pScreen->printk((char*)"Failed to allocate memory for the PhysicalNetworkInterfacePacketHandler\n");
         while(1);
     }
-    PhysicalNetworkInterfacePacketHandler* pPhysicalNetworkInterfacePacketHandler = new(physicalNetworkInterfacePacketHandlerAddr) PhysicalNetworkInterfacePacketHandler(pPhysicalNetworkStackHandler);
+    PhysicalNetworkInterfacePacketHandler* pPhysicalNetworkInterfacePacketHandler = new(physicalNetworkInterfacePacketHandlerAddr) PhysicalNetworkInterfacePacketHandler(pPhysicalNetworkStackHandler, pThisCpuCore, pSocketManager->getNetworkEventWaitQueue());
     pPhysicalNetworkInterface->registerPacketHandler(pPhysicalNetworkInterfacePacketHandler);
     
     // Setup packet handler for the loopback network interface
@@ -154,11 +240,15 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
         private:
             NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pNetworkStackHandler;
             LoopbackNetworkInterface* pLoopbackNetworkInterface;
+            CpuCore* pCpuCore;
+            WaitQueue* pNetworkEventWaitQueue;
 
         public:
-            LoopbackNetworkInterfacePacketHandler(NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pNetworkStackHandler, LoopbackNetworkInterface* pLoopbackNetworkInterface){
+            LoopbackNetworkInterfacePacketHandler(NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pNetworkStackHandler, LoopbackNetworkInterface* pLoopbackNetworkInterface, CpuCore* pCpuCore, WaitQueue* pNetworkEventWaitQueue){
                 this->pNetworkStackHandler = pNetworkStackHandler;
                 this->pLoopbackNetworkInterface = pLoopbackNetworkInterface;
+                this->pCpuCore = pCpuCore;
+                this->pNetworkEventWaitQueue = pNetworkEventWaitQueue;
             }
 
             void call(Pair<unsigned char*, unsigned int> packet){
@@ -168,6 +258,12 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                 PacketType packetType = pNetworkStackHandler->handleIncomingEthernetPacket(readBuffer, readBufferLen);
 
                 switch(packetType){
+                    // The network management task only needs to be woken up for IPv4 packets and ARP replies (which
+                    // might allow pending transmission requests to continue)
+                    case PacketType::IPv4Packet:
+                    case PacketType::ARPReply:
+                        pCpuCore->wakeUpAll(pNetworkEventWaitQueue);
+                        break;
                     // ARP requests can easily be handled so let's just do that immediately in the interrupthandler
                     case PacketType::ARPRequest:
                         {
@@ -187,7 +283,7 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
         pScreen->printk((char*)"Failed to allocate memory for the LoopbackNetworkInterfacePacketHandler\n");
         while(1);
     }
-    LoopbackNetworkInterfacePacketHandler* pLoopbackNetworkInterfacePacketHandler = new(loopbackNetworkInterfacePacketHandlerAddr) LoopbackNetworkInterfacePacketHandler(pLoopbackNetworkStackHandler, pLoopbackNetworkInterface);
+    LoopbackNetworkInterfacePacketHandler* pLoopbackNetworkInterfacePacketHandler = new(loopbackNetworkInterfacePacketHandlerAddr) LoopbackNetworkInterfacePacketHandler(pLoopbackNetworkStackHandler, pLoopbackNetworkInterface, pThisCpuCore, pSocketManager->getNetworkEventWaitQueue());
     pLoopbackNetworkInterface->registerPacketHandler(pLoopbackNetworkInterfacePacketHandler);
 
     RTCTimer* pRTCTimer = RTCTimer::getRTCTimer();
@@ -328,57 +424,19 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                     {}
 
                     void run(){
+                        // The socket can't be closed (and its send buffer can't be changed) while its lock is held
+                        TicketLock* pSocketLock = pSocketManager->lockSocket(transmissionRequestsIterator);
+                        if(pSocketLock==nullptr){
+                            // The socket was already closed, nobody is waiting for this transmission request anymore
+                            pSocketManager->remove(transmissionRequestsIterator);
+                            return;
+                        }
+
                         OutgoingUDPPacket outgoingUDPPacket = transmissionRequestsIterator->getTop();
-                        NetworkInterface* pNetworkInterface = outgoingUDPPacket.destinationIP==
-                            #ifdef THIS_IP
-                                THIS_IP
-                            #else
-                                0
-                            #endif
-                            ? (NetworkInterface*)pLoopbackNetworkInterface : (NetworkInterface*)pPhysicalNetworkInterface;
                         unsigned short identification = outgoingUDPPacket.identification;
                         unsigned int fragmentOffset = outgoingUDPPacket.fragmentOffset;
-                        unsigned char* writeBuffer = pNetworkInterface->getWriteBuffer();
-                        Pair<IPv4PacketProgress, unsigned int> state;
-
-                        while(writeBuffer!=nullptr){
-                            if(outgoingUDPPacket.dataLen==0){
-                                break;
-                            }
-
-                            if(fragmentOffset==0){
-                                unsigned char* udpHeader = outgoingUDPPacket.data;
-                                udpHeader[0] = outgoingUDPPacket.sourcePort >> 8;
-                                udpHeader[1] = outgoingUDPPacket.sourcePort & 0xFF;
-                                udpHeader[2] = outgoingUDPPacket.destinationPort >> 8;
-                                udpHeader[3] = outgoingUDPPacket.destinationPort & 0xFF;
-                                udpHeader[4] = outgoingUDPPacket.dataLen >> 8;
-                                udpHeader[5] = outgoingUDPPacket.dataLen & 0xFF;
-                                udpHeader[6] = 0x00;
-                                udpHeader[7] = 0x00;
-                            }
-
-                            if(pNetworkInterface==pPhysicalNetworkInterface){
-                                state = pPhysicalNetworkStackHandler->handleOutgoingIPv4Packet(
-                                    outgoingUDPPacket.destinationIP, outgoingUDPPacket.sourcePort, outgoingUDPPacket.destinationPort, UDP_IPV4_PROTOCOL, 
-                                    outgoingUDPPacket.data, outgoingUDPPacket.dataLen, identification, fragmentOffset, writeBuffer);    
-                            }
-                            else if(pNetworkInterface==pLoopbackNetworkInterface){
-                                state = pLoopbackNetworkStackHandler->handleOutgoingIPv4Packet(
-                                    outgoingUDPPacket.destinationIP, outgoingUDPPacket.sourcePort, outgoingUDPPacket.destinationPort, UDP_IPV4_PROTOCOL, 
-                                    outgoingUDPPacket.data, outgoingUDPPacket.dataLen, identification, fragmentOffset, writeBuffer);
-                            }
-                            
-                            if(state.second>0){
-                                bool usesIPv4Context = state.first==IPv4PacketProgress::Done || state.first==IPv4PacketProgress::SendingFragment;
-                                pNetworkInterface->finishWriteBuffer(state.second, usesIPv4Context);
-                                writeBuffer = pNetworkInterface->getWriteBuffer();
-                            }
-
-                            if(state.first==IPv4PacketProgress::WaitingOnARPReply || state.first==IPv4PacketProgress::ARPTableFull || state.first==IPv4PacketProgress::Done){
-                                break;
-                            }
-                        }
+                        bool networkCardHasSpace = sendOutgoingUDPPacket(outgoingUDPPacket, fragmentOffset, identification, 
+                            pPhysicalNetworkStackHandler, pLoopbackNetworkStackHandler, pPhysicalNetworkInterface, pLoopbackNetworkInterface);
 
                         if(outgoingUDPPacket.dataLen==0){
                             // Outgoing UDP packet makes no sense, remove it
@@ -398,7 +456,7 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                                 pSocketManager->relocateToEnd(transmissionRequestsIterator);
                             }
                         }
-                        else if(writeBuffer==nullptr){
+                        else if(!networkCardHasSpace){
                             // Not possible to send anymore packets, network card buffer is full
                             // Will try again next time
                             transmissionRequestsIterator->updateTop(fragmentOffset, identification);
@@ -408,6 +466,8 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                             transmissionRequestsIterator->updateTop(fragmentOffset, identification);
                             transmissionRequestsIterator.goToNext();
                         }
+
+                        pSocketLock->unlock();
                     }
             };
 
@@ -419,7 +479,9 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                 pPhysicalNetworkInterface,
                 pLoopbackNetworkInterface
             );
-            pThisCpuCore->withTaskSwitchingPaused(handleTranmissionRequest);
+            // Tasks on other cpu cores can use the socket concurrently, thus it is locked (and interrupts are disabled 
+            // since the lock should never be held by an interrupted or switched away task)
+            pThisCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(handleTranmissionRequest);
         }
 
         class HandleReceivedPacket : public Runnable{
@@ -439,16 +501,13 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                 }
         };
         IPv4Packet* newPacket = pPhysicalNetworkStackHandler->getLatestIPv4Packet();
-        if(newPacket==nullptr){
-            yield();
-        }
-        else{
+        if(newPacket!=nullptr){
             while(newPacket!=nullptr){
                 HandleReceivedPacket handleReceivedPacket(
                     pSocketManager,
                     newPacket
                 );
-                pThisCpuCore->withTaskSwitchingPaused(handleReceivedPacket);
+                pThisCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(handleReceivedPacket);
 
                 #if E2E_TESTING
                 pSerialLog->log((char*)"NMT: new datagram begin\n");
@@ -477,16 +536,13 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
         }
 
         newPacket = pLoopbackNetworkStackHandler->getLatestIPv4Packet();
-        if(newPacket==nullptr){
-            yield();
-        }
-        else{
+        if(newPacket!=nullptr){
             while(newPacket!=nullptr){
                 HandleReceivedPacket handleReceivedPacket(
                     pSocketManager,
                     newPacket
                 );
-                pThisCpuCore->withTaskSwitchingPaused(handleReceivedPacket);
+                pThisCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(handleReceivedPacket);
 
                 #if E2E_TESTING
                 pSerialLog->log((char*)"NMT: new datagram begin\n");
@@ -513,5 +569,132 @@ void networkManagementTask(CpuCore* pThisCpuCore, SocketManager* pSocketManager,
                 newPacket = pLoopbackNetworkStackHandler->getLatestIPv4Packet();
             }
         }
+
+        // Socket rings are handled after the received packets, receives which just got a datagram are then completed
+        // immediately
+        for(unsigned int i=0; i<MAX_NUM_SOCKET_RINGS; i++){
+            class HandleSocketRings : public Runnable{
+                private:
+                    SocketManager* pSocketManager;
+                    NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pPhysicalNetworkStackHandler;
+                    NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pLoopbackNetworkStackHandler;
+                    PhysicalNetworkInterface* pPhysicalNetworkInterface;
+                    LoopbackNetworkInterface* pLoopbackNetworkInterface;
+                    unsigned int index;
+
+                public:
+                    HandleSocketRings(
+                        SocketManager* pSocketManager,
+                        NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pPhysicalNetworkStackHandler,
+                        NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pLoopbackNetworkStackHandler,
+                        PhysicalNetworkInterface* pPhysicalNetworkInterface,
+                        LoopbackNetworkInterface* pLoopbackNetworkInterface,
+                        unsigned int index
+                    )
+                        :
+                        pSocketManager(pSocketManager),
+                        pPhysicalNetworkStackHandler(pPhysicalNetworkStackHandler),
+                        pLoopbackNetworkStackHandler(pLoopbackNetworkStackHandler),
+                        pPhysicalNetworkInterface(pPhysicalNetworkInterface),
+                        pLoopbackNetworkInterface(pLoopbackNetworkInterface),
+                        index(index)
+                    {}
+
+                    void run(){
+                        // The buffer area of the send can't be freed while the lock of the socket rings is held
+                        OutgoingUDPPacket outgoingUDPPacket;
+                        TicketLock* pSocketRingsLock = pSocketManager->lockSocketRingsSend(index, outgoingUDPPacket);
+                        if(pSocketRingsLock==nullptr){
+                            return;
+                        }
+
+                        unsigned short identification = outgoingUDPPacket.identification;
+                        unsigned int fragmentOffset = outgoingUDPPacket.fragmentOffset;
+                        sendOutgoingUDPPacket(outgoingUDPPacket, fragmentOffset, identification, 
+                            pPhysicalNetworkStackHandler, pLoopbackNetworkStackHandler, pPhysicalNetworkInterface, pLoopbackNetworkInterface);
+
+                        if(fragmentOffset>=outgoingUDPPacket.dataLen){
+                            pSocketManager->finishSocketRingsSend(index);
+                        }
+                        else{
+                            // Waiting on an ARP reply or on space in the network card buffers, try again next time
+                            pSocketManager->updateSocketRingsSend(index, fragmentOffset, identification);
+                        }
+
+                        pSocketRingsLock->unlock();
+                    }
+            };
+
+            HandleSocketRings handleSocketRings(
+                pSocketManager,
+                pPhysicalNetworkStackHandler,
+                pLoopbackNetworkStackHandler,
+                pPhysicalNetworkInterface,
+                pLoopbackNetworkInterface,
+                i
+            );
+            pThisCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(handleSocketRings);
+        }
+
+        // Block until there is something to do again instead of polling
+        class WaitForNetworkEvent : public Runnable{
+            private:
+                CpuCore* pCpuCore;
+                SocketManager* pSocketManager;
+                NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pPhysicalNetworkStackHandler;
+                NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pLoopbackNetworkStackHandler;
+
+            public:
+                WaitForNetworkEvent(
+                    CpuCore* pCpuCore,
+                    SocketManager* pSocketManager,
+                    NetworkStackHandler<PHYINT_NUM_PACKET_BUFFERS, PHYINT_ARP_HASH_TABLE_SIZE, PHYINT_ARP_HASH_ENTRY_LIST_SIZE>* pPhysicalNetworkStackHandler,
+                    NetworkStackHandler<LOINT_NUM_PACKET_BUFFERS, LOINT_ARP_HASH_TABLE_SIZE, LOINT_ARP_HASH_ENTRY_LIST_SIZE>* pLoopbackNetworkStackHandler
+                ){
+                    this->pCpuCore = pCpuCore;
+                    this->pSocketManager = pSocketManager;
+                    this->pPhysicalNetworkStackHandler = pPhysicalNetworkStackHandler;
+                    this->pLoopbackNetworkStackHandler = pLoopbackNetworkStackHandler;
+                }
+
+                void run(){
+                    if(pPhysicalNetworkStackHandler->getLatestIPv4Packet()!=nullptr || pLoopbackNetworkStackHandler->getLatestIPv4Packet()!=nullptr){
+                        return;
+                    }
+
+                    // Tasks with socket rings only do a syscall to wake up this task once it asked for it
+                    bool socketRingsHavePendingWork = false;
+                    if(pSocketManager->requestSocketRingsWakeUp(socketRingsHavePendingWork)){
+                        return;
+                    }
+
+                    TicketLock* pTransmissionRequestsLock = pSocketManager->getTransmissionRequestsLock();
+                    pTransmissionRequestsLock->lock();
+                    if(pSocketManager->consumeSocketRingsDoorbell()){
+                        // Submissions were posted after the socket rings were checked
+                        pTransmissionRequestsLock->unlock();
+                    }
+                    else if(pSocketManager->hasTransmissionRequests() || socketRingsHavePendingWork){
+                        pTransmissionRequestsLock->unlock();
+
+                        // Transmission requests might be waiting for an ARP reply or for space in the network card 
+                        // buffers, simply try again at the next timer interrupt
+                        pCpuCore->waitOn(pCpuCore->getTimerTickWaitQueue());
+                    }
+                    else{
+                        // Tasks on other cpu cores add transmission requests while holding the transmission requests 
+                        // lock, it is only released once this task is in the wait queue
+                        pCpuCore->waitOn(pSocketManager->getNetworkEventWaitQueue(), pTransmissionRequestsLock);
+                        pTransmissionRequestsLock->unlock();
+                    }
+                }
+        };
+        WaitForNetworkEvent waitForNetworkEvent(
+            pThisCpuCore,
+            pSocketManager,
+            pPhysicalNetworkStackHandler,
+            pLoopbackNetworkStackHandler
+        );
+        pThisCpuCore->getInterruptHandlerManager()->withInterruptsDisabled(waitForNetworkEvent);
     }
 }
\ No newline at end of file
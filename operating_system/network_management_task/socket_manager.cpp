@@ -1,12 +1,14 @@
 #include "socket_manager.h"
 #include "../../cpp_lib/mem.h"
+#include "../../cpp_lib/placement_new.h"
 #include "../../cpp_lib/atomic.h"
 
-SocketManager::SocketManager(){
+SocketManager::SocketManager(MemoryManager* pMemoryManager)
+    :
+    socketTableAllocator(pMemoryManager)
+{
     for(int i = 0; i < NUM_POSSIBLE_TASKS; i++){
-        for(int j = 0; j < MAX_NUM_SOCKETS_PER_TASK; j++){
-            socketDescs[i][j].isActive = 0;
-        }
+        socketTables[i] = nullptr;
     }
 
     for(int i = 0; i < NUM_UDP_PORTS; i++){
@@ -22,92 +24,206 @@ SocketManager::SocketManager(){
         transmissionRequestListElements[i].next = &transmissionRequestListElements[i + 1];
     }
     transmissionRequestListElements[MAX_NUM_TRANSMISSION_REQUESTS - 1].next = nullptr;
+
+    socketRingsDoorbell = 0;
+    for(int i = 0; i < MAX_NUM_SOCKET_RINGS; i++){
+        socketRingsTables[i] = nullptr;
+    }
+}
+
+TicketLock* SocketManager::getUDPPortLock(unsigned short udpPort){
+    return &udpPortLocks[udpPort % NUM_UDP_PORT_LOCKS];
+}
+
+bool SocketManager::createSocketTable(unsigned short taskID){
+    if(taskID >= NUM_POSSIBLE_TASKS){
+        return false;
+    }
+
+    socketTablesLock.lock();
+
+    if(socketTables[taskID]!=nullptr){
+        socketTablesLock.unlock();
+        return true;
+    }
+
+    unsigned char* socketTableAddr = socketTableAllocator.allocate();
+    if(socketTableAddr==nullptr){
+        socketTablesLock.unlock();
+        return false;
+    }
+
+    SocketTable* pSocketTable = new(socketTableAddr) SocketTable();
+    for(int i = 0; i < MAX_NUM_SOCKETS_PER_TASK; i++){
+        pSocketTable->socketDescs[i].isActive = 0;
+        pSocketTable->socketDescs[i].generation = 0;
+        pSocketTable->socketDescs[i].pSocketTable = pSocketTable;
+    }
+    pSocketTable->eventSequence = 0;
+    pSocketTable->socketRings.isActive = 0;
+    // The socket table should be complete before other cpu cores can see it
+    atomicStore((unsigned int*)&socketTables[taskID], (unsigned int)pSocketTable);
+
+    socketTablesLock.unlock();
+
+    return true;
 }
 
-void SocketManager::closeSocket(unsigned char taskID, unsigned char socketID){
-    if(socketID >= MAX_NUM_SOCKETS_PER_TASK){
+SocketDesc* SocketManager::getSocketDesc(unsigned short taskID, unsigned char socketID){
+    if(taskID >= NUM_POSSIBLE_TASKS || socketID >= MAX_NUM_SOCKETS_PER_TASK){
+        return nullptr;
+    }
+
+    SocketTable* pSocketTable = socketTables[taskID];
+    if(pSocketTable==nullptr){
+        return nullptr;
+    }
+
+    return &pSocketTable->socketDescs[socketID];
+}
+
+void SocketManager::closeSocket(unsigned short taskID, unsigned char socketID){
+    SocketDesc* pSocketDesc = getSocketDesc(taskID, socketID);
+
+    if(pSocketDesc==nullptr){
         return;
     }
 
-    SocketDesc* pSocketDesc = &socketDescs[taskID][socketID];
+    // The UDP port lock has to be taken before the lock of the socket, so the port is read first
+    pSocketDesc->lock.lock();
+    if(pSocketDesc->isActive==0){
+        pSocketDesc->lock.unlock();
+        return;
+    }
+    unsigned short udpPort = pSocketDesc->udpPort;
+    pSocketDesc->lock.unlock();
+
+    TicketLock* pUDPPortLock = getUDPPortLock(udpPort);
+    pUDPPortLock->lock();
+    pSocketDesc->lock.lock();
+
+    // The socket might have been closed (or even opened again) in the meantime by another cpu core
+    bool isClosed = false;
+    if(pSocketDesc->isActive==1 && pSocketDesc->udpPort==udpPort){
+        udpPortStates[udpPort].isActive = 0;
+        pSocketDesc->isActive = 0;
+        // Pending receives of the socket rings and receiveBatch are dropped
+        pSocketDesc->postedReceivesHead = 0;
+        pSocketDesc->numPostedReceives = 0;
+        pSocketDesc->numCompletedPostedReceives = 0;
+        isClosed = true;
+    }
 
-    if(pSocketDesc->isActive==1){
-        atomicStore(&udpPortStates[pSocketDesc->udpPort].isActive, 0);
-        atomicStore(&pSocketDesc->isActive, 0);
+    pSocketDesc->lock.unlock();
+    pUDPPortLock->unlock();
+
+    if(isClosed){
+        // Tasks waiting on this socket should notice that it was closed
+        CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->wakeUpAll(&pSocketDesc->waitQueue);
+        advanceSocketEventSequence(pSocketDesc->pSocketTable);
     }
 }
 
-void SocketManager::closeAllSocketsForTask(unsigned char taskID){
+void SocketManager::closeAllSocketsForTask(unsigned short taskID){
     for(int i = 0; i < MAX_NUM_SOCKETS_PER_TASK; i++){
         closeSocket(taskID, i);
     }
+
+    // The socket rings are in the memory of the task, the network management task shouldn't touch them anymore
+    removeSocketRings(taskID);
 }
 
-int SocketManager::openSocket(unsigned char taskID, unsigned short udpPort){
+int SocketManager::openSocket(unsigned short taskID, unsigned short udpPort){
     if(udpPort >= NUM_UDP_PORTS){
         return -1;
     }
 
+    if(taskID >= NUM_POSSIBLE_TASKS || socketTables[taskID]==nullptr){
+        return -1;
+    }
+
+    TicketLock* pUDPPortLock = getUDPPortLock(udpPort);
+    pUDPPortLock->lock();
+
     if(udpPortStates[udpPort].isActive==1){
+        pUDPPortLock->unlock();
         return -1;
     }
 
+    SocketDesc* socketDescs = socketTables[taskID]->socketDescs;
     for(int i = 0; i < MAX_NUM_SOCKETS_PER_TASK; i++){
-        if(socketDescs[taskID][i].isActive==0){
-            socketDescs[taskID][i].isActive = 1;
-            socketDescs[taskID][i].udpPort = udpPort;
-            socketDescs[taskID][i].receiveBuffer = nullptr;
-            socketDescs[taskID][i].receiveBufferSize = 0;
-            socketDescs[taskID][i].sendBuffer = nullptr;
-            socketDescs[taskID][i].sendBufferSize = 0;
-            socketDescs[taskID][i].sendBufferIdentification = 0;
-            socketDescs[taskID][i].sendBufferFragmentOffset = 0;
-            socketDescs[taskID][i].sendBufferIndicatorWhenFinished = nullptr;
+        socketDescs[i].lock.lock();
+        if(socketDescs[i].isActive==0){
+            socketDescs[i].isActive = 1;
+            socketDescs[i].udpPort = udpPort;
+            socketDescs[i].receiveBuffer = nullptr;
+            socketDescs[i].receiveBufferSize = 0;
+            socketDescs[i].sendBuffer = nullptr;
+            socketDescs[i].sendBufferSize = 0;
+            socketDescs[i].sendBufferIdentification = 0;
+            socketDescs[i].sendBufferFragmentOffset = 0;
+            socketDescs[i].sendBufferIndicatorWhenFinished = nullptr;
+            socketDescs[i].eventPending = 0;
+            socketDescs[i].generation++;
+            socketDescs[i].postedReceivesHead = 0;
+            socketDescs[i].numPostedReceives = 0;
+            socketDescs[i].numCompletedPostedReceives = 0;
 
             udpPortStates[udpPort].isActive = 1;
             udpPortStates[udpPort].taskID = taskID;
             udpPortStates[udpPort].socketID = i;
 
+            socketDescs[i].lock.unlock();
+            pUDPPortLock->unlock();
             return i;
         }
+        socketDescs[i].lock.unlock();
     }
 
+    pUDPPortLock->unlock();
     return -1;
 }
 
-int SocketManager::setReceiveBuffer(unsigned char taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize){
-    if(socketID >= MAX_NUM_SOCKETS_PER_TASK){
+int SocketManager::setReceiveBuffer(unsigned short taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize){
+    if(newBufferSize < 2*RECEIVE_BUFFER_HEADER_SIZE && (newBufferSize!=0 || newBuffer!=nullptr)){
         return -1;
     }
     
-    if(newBufferSize < 2*RECEIVE_BUFFER_HEADER_SIZE && (newBufferSize!=0 || newBuffer!=nullptr)){
+    SocketDesc* pSocketDesc = getSocketDesc(taskID, socketID);
+
+    if(pSocketDesc==nullptr){
         return -1;
     }
-    
-    SocketDesc* pSocketDesc = &socketDescs[taskID][socketID];
+
+    pSocketDesc->lock.lock();
 
     if(pSocketDesc->isActive==0){
+        pSocketDesc->lock.unlock();
         return -1;
     }
 
     pSocketDesc->receiveBuffer = newBuffer;
     pSocketDesc->receiveBufferSize = newBufferSize;
 
+    pSocketDesc->lock.unlock();
     return 0;
 }
 
-int SocketManager::setSendBuffer(unsigned char taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize, int* indicatorWhenFinished){    
-    if(socketID >= MAX_NUM_SOCKETS_PER_TASK){
+int SocketManager::setSendBuffer(unsigned short taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize, int* indicatorWhenFinished){    
+    if(newBufferSize < SEND_BUFFER_HEADER_SIZE+UDP_HEADER_SIZE && (newBufferSize!=0 || newBuffer!=nullptr || indicatorWhenFinished!=nullptr)){
         return -1;
     }
+    
+    SocketDesc* pSocketDesc = getSocketDesc(taskID, socketID);
 
-    if(newBufferSize < SEND_BUFFER_HEADER_SIZE+UDP_HEADER_SIZE && (newBufferSize!=0 || newBuffer!=nullptr || indicatorWhenFinished!=nullptr)){
+    if(pSocketDesc==nullptr){
         return -1;
     }
-    
-    SocketDesc* pSocketDesc = &socketDescs[taskID][socketID];
+
+    pSocketDesc->lock.lock();
 
     if(pSocketDesc->isActive==0){
+        pSocketDesc->lock.unlock();
         return -1;
     }
 
@@ -118,12 +234,17 @@ int SocketManager::setSendBuffer(unsigned char taskID, unsigned char socketID, u
         pSocketDesc->sendBufferIdentification = 0;
         pSocketDesc->sendBufferFragmentOffset = 0;
         pSocketDesc->sendBufferIndicatorWhenFinished = nullptr;
+        pSocketDesc->lock.unlock();
         return 0;
     }
 
+    transmissionRequestsLock.lock();
+
     // First remove element from unusedTransmissionRequestsList
     DoublyLinkedListElement<TransmissionRequest>* newTransmissionRequest = unusedTransmissionRequestsHead;
     if(newTransmissionRequest==nullptr){
+        transmissionRequestsLock.unlock();
+        pSocketDesc->lock.unlock();
         return -1;
     }
     unusedTransmissionRequestsHead = unusedTransmissionRequestsHead->next;
@@ -142,6 +263,8 @@ int SocketManager::setSendBuffer(unsigned char taskID, unsigned char socketID, u
     }
     transmissionRequestsHead = newTransmissionRequest;
 
+    transmissionRequestsLock.unlock();
+
     // Change the pSocketDesc accordingly
     pSocketDesc->sendBuffer = newBuffer;
     pSocketDesc->sendBufferSize = newBufferSize;
@@ -149,9 +272,236 @@ int SocketManager::setSendBuffer(unsigned char taskID, unsigned char socketID, u
     pSocketDesc->sendBufferFragmentOffset = 0;
     pSocketDesc->sendBufferIndicatorWhenFinished = indicatorWhenFinished;
 
+    pSocketDesc->lock.unlock();
+
+    // Let the network management task know that there is something to send
+    CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->wakeUpAll(&networkEventWaitQueue);
+
     return 0;
 }
 
+int SocketManager::sendBatch(unsigned short taskID, SendBatchEntry* entries, SendBatchEntry* kernelEntries, unsigned char** buffers, 
+    unsigned int numEntries)
+{
+    if(numEntries > MAX_BATCH_SIZE){
+        return -1;
+    }
+
+    // First the sockets are checked, the UDP port and generation of every socket are remembered since the lock of the 
+    // socket can't be held while taking the transmission requests lock for the whole batch
+    bool isAccepted[MAX_BATCH_SIZE];
+    unsigned short udpPorts[MAX_BATCH_SIZE];
+    unsigned int socketGenerations[MAX_BATCH_SIZE];
+    for(unsigned int i = 0; i < numEntries; i++){
+        isAccepted[i] = false;
+
+        SocketDesc* pSocketDesc = getSocketDesc(taskID, entries[i].socketID);
+        if(pSocketDesc!=nullptr && buffers[i]!=nullptr && entries[i].bufferSize >= UDP_HEADER_SIZE && 
+            entries[i].bufferSize <= 0xFFFF-IPV4_MINIMAL_HEADER_SIZE){
+            pSocketDesc->lock.lock();
+            if(pSocketDesc->isActive==1){
+                udpPorts[i] = pSocketDesc->udpPort;
+                socketGenerations[i] = pSocketDesc->generation;
+                isAccepted[i] = true;
+            }
+            pSocketDesc->lock.unlock();
+        }
+    }
+
+    transmissionRequestsLock.lock();
+
+    // Earlier entries get a transmission request first
+    DoublyLinkedListElement<TransmissionRequest>* newTransmissionRequests[MAX_BATCH_SIZE];
+    for(unsigned int i = 0; i < numEntries; i++){
+        if(!isAccepted[i]){
+            continue;
+        }
+
+        if(unusedTransmissionRequestsHead==nullptr){
+            isAccepted[i] = false;
+            continue;
+        }
+        newTransmissionRequests[i] = unusedTransmissionRequestsHead;
+        unusedTransmissionRequestsHead = unusedTransmissionRequestsHead->next;
+    }
+
+    // Transmission requests are added at the start of the list, thus the last entry is added first
+    int numAccepted = 0;
+    for(unsigned int i = numEntries; i > 0; i--){
+        if(!isAccepted[i-1]){
+            entries[i-1].status = BATCH_ENTRY_FAILED;
+            continue;
+        }
+        entries[i-1].status = BATCH_ENTRY_PENDING;
+
+        OutgoingUDPPacket packet;
+        packet.sourcePort = udpPorts[i-1];
+        packet.destinationPort = entries[i-1].destinationPort;
+        packet.destinationIP = entries[i-1].destinationIP;
+        packet.data = buffers[i-1];
+        packet.dataLen = entries[i-1].bufferSize;
+
+        DoublyLinkedListElement<TransmissionRequest>* newTransmissionRequest = newTransmissionRequests[i-1];
+        newTransmissionRequest->value = TransmissionRequest(this, taskID, entries[i-1].socketID, socketGenerations[i-1], 
+            packet, &kernelEntries[i-1].status);
+
+        newTransmissionRequest->next = transmissionRequestsHead;
+        newTransmissionRequest->prev = nullptr;
+        if(transmissionRequestsHead!=nullptr){
+            transmissionRequestsHead->prev = newTransmissionRequest;
+        }
+        else{
+            transmissionRequestsTail = newTransmissionRequest;
+        }
+        transmissionRequestsHead = newTransmissionRequest;
+
+        numAccepted++;
+    }
+
+    transmissionRequestsLock.unlock();
+
+    if(numAccepted > 0){
+        // Let the network management task know that there is something to send
+        CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->wakeUpAll(&networkEventWaitQueue);
+    }
+
+    return numAccepted;
+}
+
+int SocketManager::receiveBatch(unsigned short taskID, ReceiveBatchEntry* entries, ReceiveBatchEntry* kernelEntries, 
+    unsigned char** buffers, unsigned int numEntries)
+{
+    if(numEntries > MAX_BATCH_SIZE){
+        return -1;
+    }
+
+    int numAccepted = 0;
+    for(unsigned int i = 0; i < numEntries; i++){
+        SocketDesc* pSocketDesc = getSocketDesc(taskID, entries[i].socketID);
+        if(pSocketDesc==nullptr || buffers[i]==nullptr){
+            entries[i].status = BATCH_ENTRY_FAILED;
+            continue;
+        }
+
+        pSocketDesc->lock.lock();
+
+        if(pSocketDesc->isActive==0 || pSocketDesc->numPostedReceives >= MAX_NUM_POSTED_RECEIVES_PER_SOCKET){
+            entries[i].status = BATCH_ENTRY_FAILED;
+            pSocketDesc->lock.unlock();
+            continue;
+        }
+
+        entries[i].status = BATCH_ENTRY_PENDING;
+        PostedReceive* pPostedReceive = &pSocketDesc->postedReceives[
+            (pSocketDesc->postedReceivesHead + pSocketDesc->numPostedReceives) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET];
+        pPostedReceive->userData = 0;
+        pPostedReceive->buffer = buffers[i];
+        pPostedReceive->bufferSize = entries[i].bufferSize;
+        pPostedReceive->pBatchEntry = &kernelEntries[i];
+        pSocketDesc->numPostedReceives++;
+        numAccepted++;
+
+        pSocketDesc->lock.unlock();
+    }
+
+    return numAccepted;
+}
+
+int SocketManager::consumeSocketEvent(unsigned short taskID, unsigned char socketID){
+    SocketDesc* pSocketDesc = getSocketDesc(taskID, socketID);
+
+    if(pSocketDesc==nullptr || pSocketDesc->isActive==0){
+        return -1;
+    }
+
+    if(pSocketDesc->eventPending==0){
+        return 0;
+    }
+
+    pSocketDesc->eventPending = 0;
+    return 1;
+}
+
+TicketLock* SocketManager::getSocketLock(unsigned short taskID, unsigned char socketID){
+    SocketDesc* pSocketDesc = getSocketDesc(taskID, socketID);
+
+    if(pSocketDesc==nullptr){
+        return nullptr;
+    }
+
+    return &pSocketDesc->lock;
+}
+
+WaitQueue* SocketManager::getSocketWaitQueue(unsigned short taskID, unsigned char socketID){
+    SocketDesc* pSocketDesc = getSocketDesc(taskID, socketID);
+
+    if(pSocketDesc==nullptr){
+        return nullptr;
+    }
+
+    return &pSocketDesc->waitQueue;
+}
+
+unsigned int SocketManager::consumeSocketEvents(unsigned short taskID, unsigned int socketMask){
+    unsigned int readySockets = 0;
+
+    for(unsigned int i = 0; i < MAX_NUM_SOCKETS_PER_TASK; i++){
+        if((socketMask & (1 << i))==0){
+            continue;
+        }
+
+        SocketDesc* pSocketDesc = getSocketDesc(taskID, i);
+        if(pSocketDesc==nullptr){
+            continue;
+        }
+
+        // A socket which isn't open is reported as well, otherwise the task could wait for it forever
+        pSocketDesc->lock.lock();
+        if(consumeSocketEvent(taskID, i)!=0){
+            readySockets |= (1 << i);
+        }
+        pSocketDesc->lock.unlock();
+    }
+
+    return readySockets;
+}
+
+volatile int* SocketManager::getSocketEventSequence(unsigned short taskID){
+    if(taskID >= NUM_POSSIBLE_TASKS || socketTables[taskID]==nullptr){
+        return nullptr;
+    }
+
+    return (volatile int*)&socketTables[taskID]->eventSequence;
+}
+
+WaitQueue* SocketManager::getNetworkEventWaitQueue(){
+    return &networkEventWaitQueue;
+}
+
+TicketLock* SocketManager::getTransmissionRequestsLock(){
+    return &transmissionRequestsLock;
+}
+
+bool SocketManager::hasTransmissionRequests(){
+    return transmissionRequestsHead!=nullptr;
+}
+
+void SocketManager::notifySocketEvent(SocketDesc* pSocketDesc){
+    pSocketDesc->eventPending = 1;
+    CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->wakeUpAll(&pSocketDesc->waitQueue);
+    advanceSocketEventSequence(pSocketDesc->pSocketTable);
+}
+
+void SocketManager::advanceSocketEventSequence(SocketTable* pSocketTable){
+    // A lost increment could leave the event sequence unchanged, which a task in waitSockets would miss
+    unsigned int eventSequence;
+    do{
+        eventSequence = pSocketTable->eventSequence;
+    }while(!conditionalExchange(&pSocketTable->eventSequence, eventSequence, eventSequence+1));
+
+    CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->futexWake(&pSocketTable->eventSequence);
+}
+
 void SocketManager::handleReceivedPacket(IPv4Packet* packet){
     if(packet->protocol != 17){
         return;
@@ -165,38 +515,47 @@ void SocketManager::handleReceivedPacket(IPv4Packet* packet){
 
     unsigned short destinationPort = (packet->pData->data[2] << 8) | packet->pData->data[3];
 
+    if(destinationPort >= NUM_UDP_PORTS){
+        return;
+    }
+
+    TicketLock* pUDPPortLock = getUDPPortLock(destinationPort);
+    pUDPPortLock->lock();
+
     if(udpPortStates[destinationPort].isActive==0){
+        pUDPPortLock->unlock();
         return;
     }
 
-    unsigned char taskID = udpPortStates[destinationPort].taskID;
+    unsigned short taskID = udpPortStates[destinationPort].taskID;
     unsigned char socketID = udpPortStates[destinationPort].socketID;
-    SocketDesc* pSocketDesc = &socketDescs[taskID][socketID];
+    SocketDesc* pSocketDesc = &socketTables[taskID]->socketDescs[socketID];
 
-    unsigned short udpLengthAccordingToHeader = (packet->pData->data[4] << 8) | packet->pData->data[5];
+    // Once the lock of the socket is taken, the socket can't be closed anymore
+    pSocketDesc->lock.lock();
+    pUDPPortLock->unlock();
 
-    // Received packet format in receivebuffer:
-    // | Source IP | Source Port | Packet Size | Data | Next Source IP | Next Source Port | Next Packet Size | ...
-    if(udpLengthAccordingToHeader-UDP_HEADER_SIZE + 2*RECEIVE_BUFFER_HEADER_SIZE > pSocketDesc->receiveBufferSize){
-        return;
-    }
+    copyReceivedPacket(pSocketDesc, packet);
 
+    pSocketDesc->lock.unlock();
+}
+
+bool SocketManager::copyUDPData(IPv4Packet* packet, unsigned short udpLength, unsigned char* destination){
     unsigned short accumulatedUDPSize = 0;
     IPv4Packet* pCurrentIPv4Packet = packet;
     while(pCurrentIPv4Packet!=nullptr){
-        if(accumulatedUDPSize + pCurrentIPv4Packet->dataSize > udpLengthAccordingToHeader){
-            return;
+        if(accumulatedUDPSize + pCurrentIPv4Packet->dataSize > udpLength){
+            return false;
         }
 
         if(pCurrentIPv4Packet==packet){
             memCopy(pCurrentIPv4Packet->pData->data + UDP_HEADER_SIZE, 
-                (unsigned char*)(pSocketDesc->receiveBuffer + RECEIVE_BUFFER_HEADER_SIZE), 
+                destination, 
                 pCurrentIPv4Packet->dataSize - UDP_HEADER_SIZE);
         }
         else{
             memCopy(pCurrentIPv4Packet->pData->data, 
-                (unsigned char*)(pSocketDesc->receiveBuffer + RECEIVE_BUFFER_HEADER_SIZE) + 
-                (accumulatedUDPSize - UDP_HEADER_SIZE), 
+                destination + (accumulatedUDPSize - UDP_HEADER_SIZE), 
                 pCurrentIPv4Packet->dataSize);
         }
 
@@ -204,11 +563,58 @@ void SocketManager::handleReceivedPacket(IPv4Packet* packet){
         pCurrentIPv4Packet = pCurrentIPv4Packet->nextFragment;
     }
 
-    if(accumulatedUDPSize != udpLengthAccordingToHeader){
+    return accumulatedUDPSize == udpLength;
+}
+
+void SocketManager::copyReceivedPacket(SocketDesc* pSocketDesc, IPv4Packet* packet){
+    unsigned short udpLengthAccordingToHeader = (packet->pData->data[4] << 8) | packet->pData->data[5];
+    unsigned short sourcePort = (packet->pData->data[0] << 8) | packet->pData->data[1];
+
+    // Receive submissions of the socket rings and entries of receiveBatch are used before the receive buffer
+    if(pSocketDesc->numCompletedPostedReceives < pSocketDesc->numPostedReceives){
+        PostedReceive* pPostedReceive = &pSocketDesc->postedReceives[
+            (pSocketDesc->postedReceivesHead + pSocketDesc->numCompletedPostedReceives) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET];
+
+        if(udpLengthAccordingToHeader < UDP_HEADER_SIZE || (unsigned int)(udpLengthAccordingToHeader-UDP_HEADER_SIZE) > pPostedReceive->bufferSize){
+            return;
+        }
+
+        if(!copyUDPData(packet, udpLengthAccordingToHeader, pPostedReceive->buffer)){
+            return;
+        }
+
+        pPostedReceive->result = udpLengthAccordingToHeader-UDP_HEADER_SIZE;
+        pPostedReceive->sourceIP = packet->sourceIP;
+        pPostedReceive->sourcePort = sourcePort;
+        pSocketDesc->numCompletedPostedReceives++;
+
+        if(pPostedReceive->pBatchEntry!=nullptr){
+            ReceiveBatchEntry* pBatchEntry = pPostedReceive->pBatchEntry;
+            pBatchEntry->sourceIP = packet->sourceIP;
+            pBatchEntry->sourcePort = sourcePort;
+            pBatchEntry->receivedSize = udpLengthAccordingToHeader-UDP_HEADER_SIZE;
+            // The task should only see the new status once the other fields are written
+            __asm__ __volatile__("" ::: "memory");
+            pBatchEntry->status = BATCH_ENTRY_DONE;
+            CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->futexWake(&pBatchEntry->status);
+
+            removeCompletedBatchReceives(pSocketDesc);
+            notifySocketEvent(pSocketDesc);
+        }
+
+        // Otherwise the socket event is notified once the network management task posted the completion
         return;
     }
 
-    unsigned short sourcePort = (packet->pData->data[0] << 8) | packet->pData->data[1];
+    // Received packet format in receivebuffer:
+    // | Source IP | Source Port | Packet Size | Data | Next Source IP | Next Source Port | Next Packet Size | ...
+    if((unsigned int)(udpLengthAccordingToHeader-UDP_HEADER_SIZE + 2*RECEIVE_BUFFER_HEADER_SIZE) > pSocketDesc->receiveBufferSize){
+        return;
+    }
+
+    if(!copyUDPData(packet, udpLengthAccordingToHeader, (unsigned char*)(pSocketDesc->receiveBuffer + RECEIVE_BUFFER_HEADER_SIZE))){
+        return;
+    }
 
     pSocketDesc->receiveBuffer[0] = (packet->sourceIP) & 0xFF;
     pSocketDesc->receiveBuffer[1] = ((packet->sourceIP) >> 8) & 0xFF;
@@ -223,22 +629,77 @@ void SocketManager::handleReceivedPacket(IPv4Packet* packet){
         pSocketDesc->receiveBuffer[i + RECEIVE_BUFFER_HEADER_SIZE + (udpLengthAccordingToHeader-UDP_HEADER_SIZE)] = 0;
     }
 
+    // The header is complete now, the task might be waiting with futexWait on the word containing its last byte (the 
+    // high byte of the packet size)
+    CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->futexWake(&pSocketDesc->receiveBuffer[RECEIVE_BUFFER_HEADER_SIZE-1]);
+
     pSocketDesc->receiveBuffer += RECEIVE_BUFFER_HEADER_SIZE + (udpLengthAccordingToHeader-UDP_HEADER_SIZE);
     pSocketDesc->receiveBufferSize -= RECEIVE_BUFFER_HEADER_SIZE + (udpLengthAccordingToHeader-UDP_HEADER_SIZE);
+
+    notifySocketEvent(pSocketDesc);
 }
 
 SocketManager::TransmissionRequestsIterator SocketManager::getTransmissionRequestsIterator(){
-    return TransmissionRequestsIterator(this);
+    // Called by the network management task with interrupts enabled
+    unsigned int eflags = transmissionRequestsLock.lockAndDisableInterrupts();
+    TransmissionRequestsIterator iterator(this);
+    transmissionRequestsLock.unlockAndRestoreInterrupts(eflags);
+
+    return iterator;
+}
+
+TicketLock* SocketManager::lockSocket(TransmissionRequestsIterator& iterator){
+    if(iterator.currentTransmissionRequest==nullptr){
+        return nullptr;
+    }
+
+    TransmissionRequest* pTransmissionRequest = &iterator.currentTransmissionRequest->value;
+    if(pTransmissionRequest->isBatchDatagram){
+        // The socket of a datagram of sendBatch is known, but it might have been closed (and even opened again)
+        SocketDesc* pSocketDesc = &socketTables[pTransmissionRequest->taskID]->socketDescs[pTransmissionRequest->socketID];
+        pSocketDesc->lock.lock();
+        if(pSocketDesc->isActive==0 || pSocketDesc->generation!=pTransmissionRequest->socketGeneration){
+            pSocketDesc->lock.unlock();
+            return nullptr;
+        }
+        return &pSocketDesc->lock;
+    }
+
+    unsigned short udpPort = pTransmissionRequest->getUDPPort();
+    TicketLock* pUDPPortLock = getUDPPortLock(udpPort);
+    pUDPPortLock->lock();
+
+    if(udpPortStates[udpPort].isActive==0){
+        pUDPPortLock->unlock();
+        return nullptr;
+    }
+
+    unsigned short taskID = udpPortStates[udpPort].taskID;
+    unsigned char socketID = udpPortStates[udpPort].socketID;
+    SocketDesc* pSocketDesc = &socketTables[taskID]->socketDescs[socketID];
+
+    // The UDP port state of an open socket is only changed while holding the lock of the socket, thus the transmission 
+    // request can keep using it without the UDP port lock
+    pSocketDesc->lock.lock();
+    pUDPPortLock->unlock();
+
+    return &pSocketDesc->lock;
 }
 
 void SocketManager::TransmissionRequest::updateTop(unsigned int newFragmentOffset, unsigned short newIdentification){
+    if(isBatchDatagram){
+        batchDatagram.fragmentOffset = newFragmentOffset;
+        batchDatagram.identification = newIdentification;
+        return;
+    }
+
     if(pSocketManager->udpPortStates[udpPort].isActive==0){
         return;
     }
 
-    unsigned char taskID = pSocketManager->udpPortStates[udpPort].taskID;
+    unsigned short taskID = pSocketManager->udpPortStates[udpPort].taskID;
     unsigned char socketID = pSocketManager->udpPortStates[udpPort].socketID;
-    SocketDesc* pSocketDesc = &pSocketManager->socketDescs[taskID][socketID];
+    SocketDesc* pSocketDesc = &pSocketManager->socketTables[taskID]->socketDescs[socketID];
 
     if(pSocketDesc->sendBufferSize == 0){
         return;
@@ -249,15 +710,20 @@ void SocketManager::TransmissionRequest::updateTop(unsigned int newFragmentOffse
 }
 
  bool SocketManager::TransmissionRequest::removeTop(){
+    // A datagram of sendBatch is a transmission request on its own
+    if(isBatchDatagram){
+        return true;
+    }
+
     bool removeFullTransmissionRequest = false;
 
     if(pSocketManager->udpPortStates[udpPort].isActive==0){
         removeFullTransmissionRequest = true;
     }
     else{
-        unsigned char taskID = pSocketManager->udpPortStates[udpPort].taskID;
+        unsigned short taskID = pSocketManager->udpPortStates[udpPort].taskID;
         unsigned char socketID = pSocketManager->udpPortStates[udpPort].socketID;
-        SocketDesc* pSocketDesc = &pSocketManager->socketDescs[taskID][socketID];
+        SocketDesc* pSocketDesc = &pSocketManager->socketTables[taskID]->socketDescs[socketID];
 
         if(pSocketDesc->sendBufferSize < 2*(SEND_BUFFER_HEADER_SIZE + UDP_HEADER_SIZE)){
             // It's impossible that there is still another packet in the buffer
@@ -287,16 +753,24 @@ void SocketManager::TransmissionRequest::updateTop(unsigned int newFragmentOffse
 }
 
 void SocketManager::TransmissionRequest::indicateAsFinished(){
+    if(isBatchDatagram){
+        *pBatchStatus = BATCH_ENTRY_DONE;
+        CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->futexWake(pBatchStatus);
+        pSocketManager->notifySocketEvent(&pSocketManager->socketTables[taskID]->socketDescs[socketID]);
+        return;
+    }
+
     if(pSocketManager->udpPortStates[udpPort].isActive==0){
         return;
     }
 
-    unsigned char taskID = pSocketManager->udpPortStates[udpPort].taskID;
+    unsigned short taskID = pSocketManager->udpPortStates[udpPort].taskID;
     unsigned char socketID = pSocketManager->udpPortStates[udpPort].socketID;
-    SocketDesc* pSocketDesc = &pSocketManager->socketDescs[taskID][socketID];
+    SocketDesc* pSocketDesc = &pSocketManager->socketTables[taskID]->socketDescs[socketID];
 
     if(pSocketDesc->sendBufferIndicatorWhenFinished!=nullptr){
         *(pSocketDesc->sendBufferIndicatorWhenFinished) = 1;
+        CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->futexWake(pSocketDesc->sendBufferIndicatorWhenFinished);
     }
     
     // If indicated that this was finished, then remove buffers that were set by the task since task 
@@ -304,6 +778,8 @@ void SocketManager::TransmissionRequest::indicateAsFinished(){
     pSocketDesc->sendBufferIndicatorWhenFinished = nullptr;
     pSocketDesc->sendBuffer = nullptr;
     pSocketDesc->sendBufferSize = 0;
+
+    pSocketManager->notifySocketEvent(pSocketDesc);
 }
 
 SocketManager::TransmissionRequestsIterator::TransmissionRequestsIterator(SocketManager* pSocketManager)
@@ -313,13 +789,17 @@ SocketManager::TransmissionRequestsIterator::TransmissionRequestsIterator(Socket
 {}
 
 OutgoingUDPPacket SocketManager::TransmissionRequest::getTop(){
+    if(isBatchDatagram){
+        return batchDatagram;
+    }
+
     if(pSocketManager->udpPortStates[udpPort].isActive==0){
         return OutgoingUDPPacket();
     }
 
-    unsigned char taskID = pSocketManager->udpPortStates[udpPort].taskID;
+    unsigned short taskID = pSocketManager->udpPortStates[udpPort].taskID;
     unsigned char socketID = pSocketManager->udpPortStates[udpPort].socketID;
-    SocketDesc* pSocketDesc = &pSocketManager->socketDescs[taskID][socketID];
+    SocketDesc* pSocketDesc = &pSocketManager->socketTables[taskID]->socketDescs[socketID];
 
     if(pSocketDesc->sendBufferSize < SEND_BUFFER_HEADER_SIZE + UDP_HEADER_SIZE){
         return OutgoingUDPPacket();
@@ -369,11 +849,32 @@ SocketManager::TransmissionRequest* SocketManager::TransmissionRequestsIterator:
 SocketManager::TransmissionRequest::TransmissionRequest(){
     pSocketManager = nullptr;
     udpPort = 0;
+    isBatchDatagram = false;
+    taskID = 0;
+    socketID = 0;
+    socketGeneration = 0;
+    pBatchStatus = nullptr;
 }
 
 SocketManager::TransmissionRequest::TransmissionRequest(SocketManager* pSocketManager, unsigned short udpPort){
     this->pSocketManager = pSocketManager;
     this->udpPort = udpPort;
+    isBatchDatagram = false;
+    taskID = 0;
+    socketID = 0;
+    socketGeneration = 0;
+    pBatchStatus = nullptr;
+}
+
+SocketManager::TransmissionRequest::TransmissionRequest(SocketManager* pSocketManager, unsigned short taskID, unsigned char socketID, unsigned int socketGeneration, OutgoingUDPPacket packet, volatile int* pStatus){
+    this->pSocketManager = pSocketManager;
+    this->udpPort = packet.sourcePort;
+    isBatchDatagram = true;
+    this->taskID = taskID;
+    this->socketID = socketID;
+    this->socketGeneration = socketGeneration;
+    batchDatagram = packet;
+    pBatchStatus = pStatus;
 }
 
 void SocketManager::remove(TransmissionRequestsIterator& iterator){
@@ -383,6 +884,9 @@ void SocketManager::remove(TransmissionRequestsIterator& iterator){
 
     DoublyLinkedListElement<TransmissionRequest>* currentTransmissionRequest = iterator.currentTransmissionRequest;
 
+    // Tasks on other cpu cores might be adding transmission requests at the same time
+    transmissionRequestsLock.lock();
+
     // First move iterator already to next element
     iterator.currentTransmissionRequest = currentTransmissionRequest->next;
 
@@ -403,6 +907,8 @@ void SocketManager::remove(TransmissionRequestsIterator& iterator){
 
     currentTransmissionRequest->next = unusedTransmissionRequestsHead;
     unusedTransmissionRequestsHead = currentTransmissionRequest;
+
+    transmissionRequestsLock.unlock();
 }
 
 void SocketManager::relocateToEnd(TransmissionRequestsIterator& iterator){
@@ -412,12 +918,15 @@ void SocketManager::relocateToEnd(TransmissionRequestsIterator& iterator){
 
     // If there is no next element, then we would just move this element to the end and then go to it
     // Which would be the same as doing nothing
+    // (new transmission requests are only added at the start of the list, so next can't change concurrently)
     if(iterator.currentTransmissionRequest->next==nullptr){
         return;
     }
 
     DoublyLinkedListElement<TransmissionRequest>* currentTransmissionRequest = iterator.currentTransmissionRequest;
 
+    transmissionRequestsLock.lock();
+
     // First remove this element from the list and let iterator point to next element
     iterator.currentTransmissionRequest = currentTransmissionRequest->next;
     currentTransmissionRequest->next->prev = currentTransmissionRequest->prev;
@@ -435,4 +944,376 @@ void SocketManager::relocateToEnd(TransmissionRequestsIterator& iterator){
     currentTransmissionRequest->prev = transmissionRequestsTail;
     currentTransmissionRequest->next = nullptr;
     transmissionRequestsTail = currentTransmissionRequest;
-}
\ No newline at end of file
+
+    transmissionRequestsLock.unlock();
+}
+int SocketManager::setupSocketRings(unsigned short taskID, SocketRings* pRings, SocketRings* pKernelRings, unsigned char* bufferArea, 
+    unsigned int bufferAreaSize)
+{
+    if(taskID >= NUM_POSSIBLE_TASKS || socketTables[taskID]==nullptr){
+        return -1;
+    }
+
+    if(pRings==nullptr){
+        removeSocketRings(taskID);
+        return 0;
+    }
+
+    SocketTable* pSocketTable = socketTables[taskID];
+
+    socketRingsTablesLock.lock();
+
+    // Setting up socket rings again reuses the index of the previous socket rings
+    int index = -1;
+    for(int i = 0; i < MAX_NUM_SOCKET_RINGS; i++){
+        if(socketRingsTables[i]==pSocketTable){
+            index = i;
+            break;
+        }
+    }
+    if(index==-1){
+        for(int i = 0; i < MAX_NUM_SOCKET_RINGS; i++){
+            if(socketRingsTables[i]==nullptr){
+                index = i;
+                break;
+            }
+        }
+    }
+    if(index==-1){
+        socketRingsTablesLock.unlock();
+        return -1;
+    }
+
+    SocketRingsDesc* pSocketRingsDesc = &pSocketTable->socketRings;
+    pSocketRingsDesc->lock.lock();
+
+    // Submissions of previous socket rings point to the previous buffer area
+    dropPostedReceives(pSocketTable);
+
+    pSocketRingsDesc->isActive = 1;
+    pSocketRingsDesc->pRings = pKernelRings;
+    pSocketRingsDesc->bufferArea = bufferArea;
+    pSocketRingsDesc->bufferAreaSize = bufferAreaSize;
+    pSocketRingsDesc->submissionHead = 0;
+    pSocketRingsDesc->completionTail = 0;
+    pSocketRingsDesc->sendState = RING_SEND_NONE;
+    pSocketRingsDesc->completionsWaiting = 0;
+
+    // The page directory of the calling task is loaded here, thus the rings are initialized through its own address
+    pRings->submissionTail = 0;
+    pRings->completionHead = 0;
+    pRings->submissionHead = 0;
+    pRings->completionTail = 0;
+    // The network management task didn't look at these rings yet, the first submission should wake it up
+    pRings->flags = SOCKET_RINGS_NEED_WAKEUP;
+
+    pSocketRingsDesc->lock.unlock();
+
+    atomicStore((unsigned int*)&socketRingsTables[index], (unsigned int)pSocketTable);
+
+    socketRingsTablesLock.unlock();
+
+    return 0;
+}
+
+void SocketManager::removeSocketRings(unsigned short taskID){
+    if(taskID >= NUM_POSSIBLE_TASKS || socketTables[taskID]==nullptr){
+        return;
+    }
+
+    SocketTable* pSocketTable = socketTables[taskID];
+
+    socketRingsTablesLock.lock();
+
+    // Once this lock is taken, the network management task isn't using the rings or the buffer area anymore
+    SocketRingsDesc* pSocketRingsDesc = &pSocketTable->socketRings;
+    pSocketRingsDesc->lock.lock();
+    if(pSocketRingsDesc->isActive==1){
+        pSocketRingsDesc->isActive = 0;
+        dropPostedReceives(pSocketTable);
+    }
+    pSocketRingsDesc->lock.unlock();
+
+    for(int i = 0; i < MAX_NUM_SOCKET_RINGS; i++){
+        if(socketRingsTables[i]==pSocketTable){
+            atomicStore((unsigned int*)&socketRingsTables[i], (unsigned int)nullptr);
+        }
+    }
+
+    socketRingsTablesLock.unlock();
+}
+
+void SocketManager::dropPostedReceives(SocketTable* pSocketTable){
+    for(int i = 0; i < MAX_NUM_SOCKETS_PER_TASK; i++){
+        SocketDesc* pSocketDesc = &pSocketTable->socketDescs[i];
+        pSocketDesc->lock.lock();
+
+        // Entries of receiveBatch are moved forward in the queue, keeping their order
+        unsigned int numKept = 0;
+        unsigned int numCompletedKept = 0;
+        for(unsigned int j = 0; j < pSocketDesc->numPostedReceives; j++){
+            PostedReceive* pPostedReceive = &pSocketDesc->postedReceives[(pSocketDesc->postedReceivesHead + j) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET];
+            if(pPostedReceive->pBatchEntry==nullptr){
+                continue;
+            }
+
+            pSocketDesc->postedReceives[(pSocketDesc->postedReceivesHead + numKept) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET] = *pPostedReceive;
+            if(j < pSocketDesc->numCompletedPostedReceives){
+                numCompletedKept++;
+            }
+            numKept++;
+        }
+        pSocketDesc->numPostedReceives = numKept;
+        pSocketDesc->numCompletedPostedReceives = numCompletedKept;
+        removeCompletedBatchReceives(pSocketDesc);
+
+        pSocketDesc->lock.unlock();
+    }
+}
+
+void SocketManager::removeCompletedBatchReceives(SocketDesc* pSocketDesc){
+    // Completed entries of receiveBatch already got their status, they only wait until they are at the head of the queue
+    while(pSocketDesc->numCompletedPostedReceives > 0 && pSocketDesc->postedReceives[pSocketDesc->postedReceivesHead].pBatchEntry!=nullptr){
+        pSocketDesc->postedReceivesHead = (pSocketDesc->postedReceivesHead + 1) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET;
+        pSocketDesc->numPostedReceives--;
+        pSocketDesc->numCompletedPostedReceives--;
+    }
+}
+
+bool SocketManager::postSocketRingCompletion(SocketRingsDesc* pSocketRingsDesc, unsigned int userData, int result, unsigned int sourceIP, unsigned short sourcePort){
+    SocketRings* pRings = pSocketRingsDesc->pRings;
+
+    // If the task wrote nonsense in the completion head, the completion ring simply looks full
+    if(pSocketRingsDesc->completionTail-pRings->completionHead >= SOCKET_RINGS_NUM_ENTRIES){
+        return false;
+    }
+
+    SocketRingCompletion* pCompletion = &pRings->completions[pSocketRingsDesc->completionTail & (SOCKET_RINGS_NUM_ENTRIES-1)];
+    pCompletion->userData = userData;
+    pCompletion->result = result;
+    pCompletion->sourceIP = sourceIP;
+    pCompletion->sourcePort = sourcePort;
+
+    // The task should only see the new completion tail once the completion is written
+    __asm__ __volatile__("" ::: "memory");
+    pSocketRingsDesc->completionTail++;
+    pRings->completionTail = pSocketRingsDesc->completionTail;
+
+    return true;
+}
+
+void SocketManager::postSocketRingSendCompletion(SocketTable* pSocketTable){
+    SocketRingsDesc* pSocketRingsDesc = &pSocketTable->socketRings;
+
+    if(!postSocketRingCompletion(pSocketRingsDesc, pSocketRingsDesc->sendUserData, pSocketRingsDesc->send.dataLen-UDP_HEADER_SIZE, 0, 0)){
+        pSocketRingsDesc->sendState = RING_SEND_FINISHED;
+        return;
+    }
+    pSocketRingsDesc->sendState = RING_SEND_NONE;
+
+    SocketDesc* pSocketDesc = &pSocketTable->socketDescs[pSocketRingsDesc->sendSocketID];
+    pSocketDesc->lock.lock();
+    if(pSocketDesc->isActive==1){
+        notifySocketEvent(pSocketDesc);
+    }
+    pSocketDesc->lock.unlock();
+}
+
+void SocketManager::handleSocketRingSubmission(SocketTable* pSocketTable, SocketRingSubmission& submission){
+    SocketRingsDesc* pSocketRingsDesc = &pSocketTable->socketRings;
+
+    if(submission.socketID >= MAX_NUM_SOCKETS_PER_TASK){
+        postSocketRingCompletion(pSocketRingsDesc, submission.userData, -1, 0, 0);
+        return;
+    }
+
+    // Written this way so a huge offset can't make the end of the buffer wrap around
+    bool bufferIsValid = submission.bufferOffset <= pSocketRingsDesc->bufferAreaSize && 
+        submission.bufferSize <= pSocketRingsDesc->bufferAreaSize-submission.bufferOffset;
+    unsigned char* buffer = pSocketRingsDesc->bufferArea+submission.bufferOffset;
+
+    SocketDesc* pSocketDesc = &pSocketTable->socketDescs[submission.socketID];
+    pSocketDesc->lock.lock();
+
+    if(pSocketDesc->isActive==1 && bufferIsValid){
+        if(submission.opcode==SOCKET_RING_RECEIVE && pSocketDesc->numPostedReceives < MAX_NUM_POSTED_RECEIVES_PER_SOCKET){
+            PostedReceive* pPostedReceive = &pSocketDesc->postedReceives[
+                (pSocketDesc->postedReceivesHead + pSocketDesc->numPostedReceives) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET];
+            pPostedReceive->userData = submission.userData;
+            pPostedReceive->buffer = buffer;
+            pPostedReceive->bufferSize = submission.bufferSize;
+            pPostedReceive->pBatchEntry = nullptr;
+            pSocketDesc->numPostedReceives++;
+
+            pSocketDesc->lock.unlock();
+            return;
+        }
+        
+        if(submission.opcode==SOCKET_RING_SEND && submission.bufferSize >= UDP_HEADER_SIZE && 
+            submission.bufferSize <= 0xFFFF-IPV4_MINIMAL_HEADER_SIZE){
+            OutgoingUDPPacket packet;
+            packet.sourcePort = pSocketDesc->udpPort;
+            packet.destinationPort = submission.destinationPort;
+            packet.destinationIP = submission.destinationIP;
+            packet.data = buffer;
+            packet.dataLen = submission.bufferSize;
+
+            // Like a datagram which already left, the send is finished even if the socket is closed in the meantime
+            pSocketRingsDesc->send = packet;
+            pSocketRingsDesc->sendState = RING_SEND_IN_PROGRESS;
+            pSocketRingsDesc->sendUserData = submission.userData;
+            pSocketRingsDesc->sendSocketID = submission.socketID;
+
+            pSocketDesc->lock.unlock();
+            return;
+        }
+    }
+
+    // Space in the completion ring was checked before the submission was taken
+    postSocketRingCompletion(pSocketRingsDesc, submission.userData, -1, 0, 0);
+    if(pSocketDesc->isActive==1){
+        notifySocketEvent(pSocketDesc);
+    }
+
+    pSocketDesc->lock.unlock();
+}
+
+TicketLock* SocketManager::lockSocketRingsSend(unsigned int index, OutgoingUDPPacket& packet){
+    if(index >= MAX_NUM_SOCKET_RINGS){
+        return nullptr;
+    }
+
+    SocketTable* pSocketTable = socketRingsTables[index];
+    if(pSocketTable==nullptr){
+        return nullptr;
+    }
+
+    SocketRingsDesc* pSocketRingsDesc = &pSocketTable->socketRings;
+    pSocketRingsDesc->lock.lock();
+
+    if(pSocketRingsDesc->isActive==0){
+        pSocketRingsDesc->lock.unlock();
+        return nullptr;
+    }
+
+    SocketRings* pRings = pSocketRingsDesc->pRings;
+
+    // The network management task is looking at the submission ring now
+    pRings->flags = 0;
+
+    // Completions are posted first, they make space for new submissions
+    pSocketRingsDesc->completionsWaiting = 0;
+    for(int i = 0; i < MAX_NUM_SOCKETS_PER_TASK; i++){
+        SocketDesc* pSocketDesc = &pSocketTable->socketDescs[i];
+        pSocketDesc->lock.lock();
+
+        bool postedCompletion = false;
+        while(pSocketDesc->numCompletedPostedReceives > 0){
+            PostedReceive* pPostedReceive = &pSocketDesc->postedReceives[pSocketDesc->postedReceivesHead];
+            if(pPostedReceive->pBatchEntry!=nullptr){
+                // Entries of receiveBatch after a receive submission which was still waiting for its completion
+                removeCompletedBatchReceives(pSocketDesc);
+                continue;
+            }
+            if(!postSocketRingCompletion(pSocketRingsDesc, pPostedReceive->userData, pPostedReceive->result, pPostedReceive->sourceIP, pPostedReceive->sourcePort)){
+                pSocketRingsDesc->completionsWaiting = 1;
+                break;
+            }
+            pSocketDesc->postedReceivesHead = (pSocketDesc->postedReceivesHead + 1) % MAX_NUM_POSTED_RECEIVES_PER_SOCKET;
+            pSocketDesc->numPostedReceives--;
+            pSocketDesc->numCompletedPostedReceives--;
+            postedCompletion = true;
+        }
+        if(postedCompletion){
+            notifySocketEvent(pSocketDesc);
+        }
+
+        pSocketDesc->lock.unlock();
+    }
+
+    if(pSocketRingsDesc->sendState==RING_SEND_FINISHED){
+        postSocketRingSendCompletion(pSocketTable);
+    }
+
+    // Sends are handled one at a time, the submissions after a send wait until it is finished
+    while(pSocketRingsDesc->sendState==RING_SEND_NONE && pSocketRingsDesc->submissionHead!=pRings->submissionTail){
+        // A submission which fails immediately should be able to post its completion
+        if(pSocketRingsDesc->completionTail-pRings->completionHead >= SOCKET_RINGS_NUM_ENTRIES){
+            break;
+        }
+
+        // The task can change the submission at any moment, thus it is copied first
+        __asm__ __volatile__("" ::: "memory");
+        SocketRingSubmission submission = pRings->submissions[pSocketRingsDesc->submissionHead & (SOCKET_RINGS_NUM_ENTRIES-1)];
+        pSocketRingsDesc->submissionHead++;
+        pRings->submissionHead = pSocketRingsDesc->submissionHead;
+
+        handleSocketRingSubmission(pSocketTable, submission);
+    }
+
+    if(pSocketRingsDesc->sendState!=RING_SEND_IN_PROGRESS){
+        pSocketRingsDesc->lock.unlock();
+        return nullptr;
+    }
+
+    packet = pSocketRingsDesc->send;
+    return &pSocketRingsDesc->lock;
+}
+
+void SocketManager::updateSocketRingsSend(unsigned int index, unsigned int newFragmentOffset, unsigned short newIdentification){
+    SocketRingsDesc* pSocketRingsDesc = &socketRingsTables[index]->socketRings;
+
+    pSocketRingsDesc->send.fragmentOffset = newFragmentOffset;
+    pSocketRingsDesc->send.identification = newIdentification;
+}
+
+void SocketManager::finishSocketRingsSend(unsigned int index){
+    postSocketRingSendCompletion(socketRingsTables[index]);
+}
+
+bool SocketManager::requestSocketRingsWakeUp(bool& hasPendingWork){
+    bool hasNewSubmissions = false;
+
+    for(int i = 0; i < MAX_NUM_SOCKET_RINGS; i++){
+        SocketTable* pSocketTable = socketRingsTables[i];
+        if(pSocketTable==nullptr){
+            continue;
+        }
+
+        SocketRingsDesc* pSocketRingsDesc = &pSocketTable->socketRings;
+        pSocketRingsDesc->lock.lock();
+
+        if(pSocketRingsDesc->isActive==1){
+            // atomicStore is also a full memory barrier, a task either sees the flag or its submission is seen here
+            atomicStore((unsigned int*)&pSocketRingsDesc->pRings->flags, SOCKET_RINGS_NEED_WAKEUP);
+
+            if(pSocketRingsDesc->sendState!=RING_SEND_NONE || pSocketRingsDesc->completionsWaiting==1){
+                hasPendingWork = true;
+            }
+            else if(pSocketRingsDesc->submissionHead!=pSocketRingsDesc->pRings->submissionTail){
+                hasNewSubmissions = true;
+            }
+        }
+
+        pSocketRingsDesc->lock.unlock();
+    }
+
+    return hasNewSubmissions;
+}
+
+void SocketManager::ringSocketRingsDoorbell(){
+    transmissionRequestsLock.lock();
+    socketRingsDoorbell = 1;
+    transmissionRequestsLock.unlock();
+
+    CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->wakeUpAll(&networkEventWaitQueue);
+}
+
+bool SocketManager::consumeSocketRingsDoorbell(){
+    if(socketRingsDoorbell==0){
+        return false;
+    }
+
+    socketRingsDoorbell = 0;
+    return true;
+}
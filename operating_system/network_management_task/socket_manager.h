@@ -2,19 +2,39 @@
 
 #include "../../cpp_lib/pair.h"
 #include "../../cpp_lib/list.h"
+#include "../../cpp_lib/atomic.h"
+#include "../../cpp_lib/syscalls.h"
 
 #include "network_stack_handler.h"
 #include "../cpu_core/cpu_core.h"
+#include "../paging/slab_allocator.h"
 
 #define MAX_NUM_SOCKETS_PER_TASK 10
 #define NUM_UDP_PORTS 9000
-#define MAX_NUM_TRANSMISSION_REQUESTS 15
+#define NUM_UDP_PORT_LOCKS 64
+#define MAX_NUM_TRANSMISSION_REQUESTS 64
+#define SOCKET_TABLE_SLAB_NUM_PAGES 16
+#define MAX_NUM_SOCKET_RINGS 16
+#define MAX_NUM_POSTED_RECEIVES_PER_SOCKET 16
+#define MAX_BATCH_SIZE 32
 
 #define RECEIVE_BUFFER_HEADER_SIZE (4 + 2 + 2)
 #define SEND_BUFFER_HEADER_SIZE (4 + 2 + 2)
 
 #define UDP_HEADER_SIZE 8
 
+// Receive submission of the socket rings or entry of receiveBatch, waiting for a datagram on its socket
+typedef struct PostedReceive{
+    unsigned int userData;
+    unsigned char* buffer;
+    unsigned int bufferSize;
+    int result;
+    unsigned int sourceIP;
+    unsigned short sourcePort;
+    // Kernel address of the receiveBatch entry, nullptr for a receive submission of the socket rings
+    ReceiveBatchEntry* pBatchEntry;
+} PostedReceive;
+
 typedef struct SocketDesc{
     unsigned int isActive;
     unsigned short udpPort;
@@ -25,6 +45,23 @@ typedef struct SocketDesc{
     unsigned short sendBufferIdentification;
     unsigned int sendBufferFragmentOffset;
     int* sendBufferIndicatorWhenFinished;
+    // Set when a packet was received or a send buffer was finished, cleared by consumeSocketEvent
+    unsigned int eventPending;
+    // Incremented every time the socket is opened, datagrams of sendBatch only belong to the socket if it still has the
+    // same generation
+    unsigned int generation;
+    // Queue of receive submissions from the socket rings and entries of receiveBatch, the first 
+    // numCompletedPostedReceives already got a datagram (receiveBatch entries are removed right away, receive 
+    // submissions wait until the network management task posts their completion)
+    PostedReceive postedReceives[MAX_NUM_POSTED_RECEIVES_PER_SOCKET];
+    unsigned int postedReceivesHead;
+    unsigned int numPostedReceives;
+    unsigned int numCompletedPostedReceives;
+    WaitQueue waitQueue;
+    // Socket table this socket is part of
+    struct SocketTable* pSocketTable;
+    // Protects the fields above, the network management task and the task owning the socket use it concurrently
+    TicketLock lock;
 } SocketDesc;
 
 struct OutgoingUDPPacket{
@@ -37,9 +74,42 @@ struct OutgoingUDPPacket{
     unsigned int fragmentOffset = 0;
 };
 
+#define RING_SEND_NONE 0
+#define RING_SEND_IN_PROGRESS 1
+// The send is done but its completion didn't fit in the completion ring yet
+#define RING_SEND_FINISHED 2
+
+typedef struct SocketRingsDesc{
+    unsigned int isActive;
+    // Kernel addresses of the rings and the buffer area of the task
+    SocketRings* pRings;
+    unsigned char* bufferArea;
+    unsigned int bufferAreaSize;
+    // The task can write anything in the rings, thus the indexes written by the OS are kept here as well
+    unsigned int submissionHead;
+    unsigned int completionTail;
+    // Send submissions are handled one at a time
+    unsigned int sendState;
+    unsigned int sendUserData;
+    unsigned char sendSocketID;
+    OutgoingUDPPacket send;
+    // Set if completions of receives didn't fit in the completion ring
+    unsigned int completionsWaiting;
+    // Protects the fields above (and the buffer area from being freed), taken before the locks of the sockets
+    TicketLock lock;
+} SocketRingsDesc;
+
+struct SocketTable{
+    SocketDesc socketDescs[MAX_NUM_SOCKETS_PER_TASK];
+    SocketRingsDesc socketRings;
+    // Incremented (atomically, the sockets have separate locks) after every socket event of the task and every time a 
+    // socket of the task is closed, waitSockets waits for it to change with futexWait
+    unsigned int eventSequence;
+};
+
 typedef struct UDPPortState{
     unsigned int isActive;
-    unsigned char taskID;
+    unsigned short taskID;
     unsigned char socketID;
 } UDPPortState;
 
@@ -49,11 +119,15 @@ class SocketManager{
             public:
                 TransmissionRequest();
                 TransmissionRequest(SocketManager* pSocketManager, unsigned short udpPort);
+                // A datagram of sendBatch has its own buffer instead of the send buffer of the socket, pStatus is the 
+                // kernel address of the status of its batch entry
+                TransmissionRequest(SocketManager* pSocketManager, unsigned short taskID, unsigned char socketID, unsigned int socketGeneration, OutgoingUDPPacket packet, volatile int* pStatus);
 
                 inline unsigned short getUDPPort(){
                     return udpPort;
                 }
 
+                // These should only be used while holding the lock returned by SocketManager::lockSocket
                 OutgoingUDPPacket getTop();
                 void updateTop(unsigned int newFragmentOffset, unsigned short newIdentification);
                 // Remove top returns true if transmission request is now empty, 
@@ -63,8 +137,16 @@ class SocketManager{
                 void indicateAsFinished();
 
             private:
+                friend class SocketManager;
+
                 SocketManager* pSocketManager;
                 unsigned short udpPort;
+                bool isBatchDatagram;
+                unsigned short taskID;
+                unsigned char socketID;
+                unsigned int socketGeneration;
+                OutgoingUDPPacket batchDatagram;
+                volatile int* pBatchStatus;
         };
 
         class TransmissionRequestsIterator{
@@ -82,27 +164,151 @@ class SocketManager{
                 DoublyLinkedListElement<TransmissionRequest>* currentTransmissionRequest;
         };
 
-        SocketManager();
+        SocketManager(MemoryManager* pMemoryManager);
+
+        // Sockets are used by tasks on every cpu core, instead of one lock for the whole socket manager every socket 
+        // has its own lock, the UDP port states are protected by NUM_UDP_PORT_LOCKS locks (udpPort % NUM_UDP_PORT_LOCKS)
+        // and the list of transmission requests has its own lock, this way syscalls for different sockets can run on 
+        // different cpu cores at the same time
+        // Locks are always taken in this order: socket rings lock, UDP port lock, socket lock, transmission requests 
+        // lock (and then the locks of CpuCore for waking up tasks)
+        // The methods below take the locks they need themselves unless said otherwise
+        // Important: should only be called with interrupts disabled (the locks should never be held by an interrupted 
+        // or switched away task)
+
+        // Makes sure a socket table exists for the task with this taskID, should be called before the task starts running
+        // Returns false if no memory is left
+        bool createSocketTable(unsigned short taskID);
         
-        void closeSocket(unsigned char taskID, unsigned char socketID);
-        void closeAllSocketsForTask(unsigned char taskID);
+        void closeSocket(unsigned short taskID, unsigned char socketID);
+        // Also stops using the socket rings of the task
+        void closeAllSocketsForTask(unsigned short taskID);
         // Returns -1 for failure, otherwise returns the socketID
-        int openSocket(unsigned char taskID, unsigned short udpPort);
+        int openSocket(unsigned short taskID, unsigned short udpPort);
 
         // Returns -1 for failure, otherwise returns 0
-        int setReceiveBuffer(unsigned char taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize);
+        int setReceiveBuffer(unsigned short taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize);
         // Returns -1 for failure, otherwise returns 0
-        int setSendBuffer(unsigned char taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize, int* indicatorWhenFinished);
+        int setSendBuffer(unsigned short taskID, unsigned char socketID, unsigned char* newBuffer, unsigned int newBufferSize, int* indicatorWhenFinished);
+
+        // Events are only notified while holding the lock of the socket, tasks waiting for an event release it once they
+        // are in the wait queue of the socket (see CpuCore::waitOn)
+        // Returns nullptr if the socketID is invalid or if the task has no socket table
+        TicketLock* getSocketLock(unsigned short taskID, unsigned char socketID);
+        // Returns -1 if the socketID does not point to an open socket, 1 if an event was pending (the event is then cleared)
+        // and 0 if no event was pending
+        // Important: should only be called while holding the lock of the socket
+        int consumeSocketEvent(unsigned short taskID, unsigned char socketID);
+        WaitQueue* getSocketWaitQueue(unsigned short taskID, unsigned char socketID);
+        // Consumes the pending events of the sockets in socketMask (bit i for socketID i), returns a bitmap of the sockets 
+        // which had an event or aren't open
+        unsigned int consumeSocketEvents(unsigned short taskID, unsigned int socketMask);
+        // A task should read the event sequence before consumeSocketEvents, if that found no events it can wait with 
+        // futexWait until the event sequence changes
+        // Returns nullptr if the task has no socket table
+        volatile int* getSocketEventSequence(unsigned short taskID);
+
+        // The network management task waits on this queue, it is woken up when a new transmission request is added
+        WaitQueue* getNetworkEventWaitQueue();
+        // Transmission requests are only added while holding this lock, the network management task releases it once 
+        // it is in the network event wait queue
+        TicketLock* getTransmissionRequestsLock();
+        // Important: should only be called while holding the transmission requests lock
+        bool hasTransmissionRequests();
 
         void handleReceivedPacket(IPv4Packet* packet);
+
+        // Adds a transmission request for every datagram of the batch and sets the status of every entry, entries is 
+        // the address used by the calling task (read and written here) while kernelEntries and buffers should be kernel 
+        // addresses (buffers[i]==nullptr if the buffer of entry i is invalid), those are used by the network management task
+        // Returns the number of accepted entries
+        int sendBatch(unsigned short taskID, SendBatchEntry* entries, SendBatchEntry* kernelEntries, unsigned char** buffers, 
+            unsigned int numEntries);
+        // Posts a receive for every entry (used before the receive buffer of the socket, just like receive submissions 
+        // of the socket rings) and sets the status of every entry, the addresses are the same as for sendBatch
+        // Returns the number of accepted entries
+        int receiveBatch(unsigned short taskID, ReceiveBatchEntry* entries, ReceiveBatchEntry* kernelEntries, 
+            unsigned char** buffers, unsigned int numEntries);
+
+        // Socket rings let a task submit sends and receives without a syscall, the network management task handles the 
+        // submissions of every socket rings in its loop (index 0 up to MAX_NUM_SOCKET_RINGS-1)
+        // pRings is the address used by the calling task (the rings are initialized through it), pKernelRings and 
+        // bufferArea should be kernel addresses (used by the network management task), pRings==nullptr removes the 
+        // socket rings of the task
+        // Returns -1 for failure, otherwise returns 0
+        int setupSocketRings(unsigned short taskID, SocketRings* pRings, SocketRings* pKernelRings, unsigned char* bufferArea, 
+            unsigned int bufferAreaSize);
+        void removeSocketRings(unsigned short taskID);
+        // Posts the completions of finished submissions and takes new submissions from the submission ring, the socket 
+        // rings can't be removed until the returned lock is released
+        // Returns nullptr (without taking a lock) if there is no send in progress, otherwise packet is the send in 
+        // progress and updateSocketRingsSend or finishSocketRingsSend should be called before releasing the lock
+        TicketLock* lockSocketRingsSend(unsigned int index, OutgoingUDPPacket& packet);
+        // These should only be used while holding the lock returned by lockSocketRingsSend
+        void updateSocketRingsSend(unsigned int index, unsigned int newFragmentOffset, unsigned short newIdentification);
+        void finishSocketRingsSend(unsigned int index);
+        // Called by the network management task before it waits, sets SOCKET_RINGS_NEED_WAKEUP in every socket rings 
+        // without new submissions
+        // Returns true if there are new submissions (the network management task shouldn't wait then), hasPendingWork is 
+        // set if a send is in progress or a completion didn't fit yet (those are retried at the next timer tick)
+        bool requestSocketRingsWakeUp(bool& hasPendingWork);
+        // Tasks which see SOCKET_RINGS_NEED_WAKEUP ring the doorbell, the doorbell is only rung while holding the 
+        // transmission requests lock (like adding a transmission request) thus the network management task can check 
+        // it right before it waits
+        void ringSocketRingsDoorbell();
+        // Returns true if the doorbell was rung (it is then cleared)
+        // Important: should only be called while holding the transmission requests lock
+        bool consumeSocketRingsDoorbell();
+
+        // Only the network management task iterates over (and removes) transmission requests, tasks on other cpu cores 
+        // only add new transmission requests at the start of the list
         TransmissionRequestsIterator getTransmissionRequestsIterator();
+        // Takes the lock of the socket the current transmission request belongs to, the socket can then not be closed 
+        // (and its buffers not be changed) until the returned lock is released
+        // Returns nullptr (without taking a lock) if the socket was already closed
+        TicketLock* lockSocket(TransmissionRequestsIterator& iterator);
         // removeTransmissionRequest will first move the iterator to the next element before removing
         // if next element was nullptr, this method will returns false
         void remove(TransmissionRequestsIterator& iterator);
         void relocateToEnd(TransmissionRequestsIterator& iterator);
 
     private:
-        SocketDesc socketDescs[NUM_POSSIBLE_TASKS][MAX_NUM_SOCKETS_PER_TASK];
+        // Should only be called while holding the lock of the socket
+        void notifySocketEvent(SocketDesc* pSocketDesc);
+        // Increments the event sequence of the socket table and wakes up the task if it waits in waitSockets
+        void advanceSocketEventSequence(SocketTable* pSocketTable);
+        void copyReceivedPacket(SocketDesc* pSocketDesc, IPv4Packet* packet);
+        // Copies the UDP data of the (possibly fragmented) packet to destination, returns false if the fragments don't 
+        // add up to udpLength
+        bool copyUDPData(IPv4Packet* packet, unsigned short udpLength, unsigned char* destination);
+        // Should only be called while holding the lock of the socket rings
+        // Returns false if the completion ring is full
+        bool postSocketRingCompletion(SocketRingsDesc* pSocketRingsDesc, unsigned int userData, int result, unsigned int sourceIP, unsigned short sourcePort);
+        void postSocketRingSendCompletion(SocketTable* pSocketTable);
+        void handleSocketRingSubmission(SocketTable* pSocketTable, SocketRingSubmission& submission);
+        // Drops the receive submissions of the socket rings, entries of receiveBatch stay posted
+        void dropPostedReceives(SocketTable* pSocketTable);
+        // Should only be called while holding the lock of the socket
+        void removeCompletedBatchReceives(SocketDesc* pSocketDesc);
+        // Returns nullptr if the socketID is invalid or if the task has no socket table
+        SocketDesc* getSocketDesc(unsigned short taskID, unsigned char socketID);
+        TicketLock* getUDPPortLock(unsigned short udpPort);
+
+        // Only taken when a new socket table is allocated
+        SpinLock socketTablesLock;
+        TicketLock udpPortLocks[NUM_UDP_PORT_LOCKS];
+        TicketLock transmissionRequestsLock;
+        WaitQueue networkEventWaitQueue;
+        // Protected by the transmission requests lock
+        unsigned int socketRingsDoorbell;
+        // Socket tables of the tasks using socket rings, only changed while holding socketRingsTablesLock (the network 
+        // management task reads it without the lock, socket tables are never freed)
+        SpinLock socketRingsTablesLock;
+        SocketTable* socketRingsTables[MAX_NUM_SOCKET_RINGS];
+        // Socket tables are only allocated for task IDs which are actually used and are never freed (a socket table is 
+        // reused when a new task gets the same task ID), this way the network management task can never access a freed table
+        SlabAllocator<SocketTable, SOCKET_TABLE_SLAB_NUM_PAGES> socketTableAllocator;
+        SocketTable* socketTables[NUM_POSSIBLE_TASKS];
         UDPPortState udpPortStates[NUM_UDP_PORTS];
         DoublyLinkedListElement<TransmissionRequest> transmissionRequestListElements[MAX_NUM_TRANSMISSION_REQUESTS];
         DoublyLinkedListElement<TransmissionRequest>* transmissionRequestsHead;
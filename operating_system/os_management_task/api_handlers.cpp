@@ -38,8 +38,8 @@ CoAPResponse TaskAPIHandler::handlePUT(char* path,
         }
     }
 
-    // Only one CPU core is supported for now, thus all tasks will be scheduled there
-    CpuCore* pCpuCore = CpuCore::getCpuCore(0);
+    // The task is only bound to this CpuCore until it is started, setToRunningState places it on the least loaded core
+    CpuCore* pCpuCore = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId());
     CreateUserTaskResult result = pTaskManager->createUserTask(pCpuCore, taskId);
 
     CoAPResponse response;
@@ -206,7 +206,43 @@ CoAPResponse TaskStateAPIHandler::handleGET(char* path,
         return response;
     }
 
-    if(pUserTask->getRunningState()){
+    TaskCrashInfo crashInfo = pUserTask->getCrashInfo();
+    if(crashInfo.hasCrashed){
+        // Response looks like "Crashed\nexception: {n}\nfaultAddress: 0x{hex}\neip: 0x{hex}"
+        char valueString[11];
+        unsigned int responseSize = 0;
+        char* stateString = (char*)"Crashed";
+        memCopy((unsigned char*)stateString, responseBuffer+responseSize, strlen(stateString));
+        responseSize += strlen(stateString);
+
+        char* exceptionName = (char*)"\nexception: ";
+        memCopy((unsigned char*)exceptionName, responseBuffer+responseSize, strlen(exceptionName));
+        responseSize += strlen(exceptionName);
+        unsignedIntToDecimalString(crashInfo.exceptionNumber, valueString);
+        memCopy((unsigned char*)valueString, responseBuffer+responseSize, strlen(valueString));
+        responseSize += strlen(valueString);
+
+        char* names[2] = {(char*)"\nfaultAddress: 0x", (char*)"\neip: 0x"};
+        unsigned int values[2] = {crashInfo.faultAddress, crashInfo.eip};
+
+        for(int i=0; i<2; i++){
+            unsigned int nameSize = strlen(names[i]);
+            memCopy((unsigned char*)names[i], responseBuffer+responseSize, nameSize);
+            responseSize += nameSize;
+
+            intToHexadecimalString(values[i], valueString);
+            unsigned int valueSize = strlen(valueString);
+            memCopy((unsigned char*)valueString, responseBuffer+responseSize, valueSize);
+            responseSize += valueSize;
+        }
+
+        CoAPResponse response;
+        response.responseCode = CONTENT_RESPONSE_CODE;
+        response.responseSize = responseSize;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+    else if(pUserTask->getRunningState()){
         char* responseString = (char*)"Running";
         CoAPResponse response;
         response.responseCode = CONTENT_RESPONSE_CODE;
@@ -479,4 +515,383 @@ CoAPResponse TaskDataAPIHandler::handlePUT(char* path,
     }
     response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
     return response;
+}
+
+TaskWeightAPIHandler::TaskWeightAPIHandler(TaskManager* pTaskManager)
+    :
+    pTaskManager(pTaskManager)
+{}
+
+CoAPResponse TaskWeightAPIHandler::handlePUT(char* path,
+    ContentFormat contentFormat,
+    unsigned char* payload, 
+    unsigned int payloadSize, 
+    unsigned char responseBuffer[RESPONSE_BUFFER_SIZE])
+{
+    if(contentFormat!=ContentFormat::Text_Plain_Charset_UTF8){
+        CoAPResponse response;
+        response.responseCode = UNSUPPORTED_CONTENT_FORMAT_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    // Payload should be the new weight as a decimal number
+    if(payloadSize==0){
+        CoAPResponse response;
+        response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    unsigned long long weight = 0;
+    for(unsigned int i=0; i<payloadSize; i++){
+        if(payload[i]<'0' || payload[i]>'9'){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            response.responseSize = 0;
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+
+        weight = weight*10 + (payload[i]-'0');
+
+        if(weight>MAX_TASK_WEIGHT){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            char* responseString = (char*)"Task weight cannot be greater than 65536";
+            response.responseSize = strlen(responseString);
+            memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+    }
+
+    unsigned long long taskId = 0;
+    // /tasks/{id}/weight -> id starts at index 7
+    for(int i=7; i<strlen(path); i++){
+        if(path[i]=='/'){
+            if(i==7){
+                CoAPResponse response;
+                response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+                response.responseSize = 0;
+                response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+                return response;
+            }
+
+            break;
+        }
+
+        if(path[i]<'0' || path[i]>'9'){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            response.responseSize = 0;
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+
+        taskId = taskId*10 + (path[i]-'0');
+
+        if(taskId>0xFFFFFFFF){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            char* responseString = (char*)"Task ID cannot be greater than 0xFFFFFFFF";
+            response.responseSize = strlen(responseString);
+            memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+    }
+
+    CpuCore::UserTask* pUserTask = pTaskManager->getUserTask(taskId);
+
+    if(pUserTask == nullptr){
+        CoAPResponse response;
+        response.responseCode = NOT_FOUND_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    if(!pUserTask->setWeight(weight)){
+        CoAPResponse response;
+        response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+        char* responseString = (char*)"Task weight cannot be 0";
+        response.responseSize = strlen(responseString);
+        memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    CoAPResponse response;
+    response.responseCode = CHANGED_RESPONSE_CODE;
+    response.responseSize = 0;
+    response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+    return response;
+}
+
+TaskQuantumAPIHandler::TaskQuantumAPIHandler(TaskManager* pTaskManager)
+    :
+    pTaskManager(pTaskManager)
+{}
+
+CoAPResponse TaskQuantumAPIHandler::handlePUT(char* path,
+    ContentFormat contentFormat,
+    unsigned char* payload, 
+    unsigned int payloadSize, 
+    unsigned char responseBuffer[RESPONSE_BUFFER_SIZE])
+{
+    if(contentFormat!=ContentFormat::Text_Plain_Charset_UTF8){
+        CoAPResponse response;
+        response.responseCode = UNSUPPORTED_CONTENT_FORMAT_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    // Payload should be the new quantum (in timer ticks) as a decimal number
+    if(payloadSize==0){
+        CoAPResponse response;
+        response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    unsigned long long quantum = 0;
+    for(unsigned int i=0; i<payloadSize; i++){
+        if(payload[i]<'0' || payload[i]>'9'){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            response.responseSize = 0;
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+
+        quantum = quantum*10 + (payload[i]-'0');
+
+        if(quantum>MAX_TASK_QUANTUM){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            char* responseString = (char*)"Task quantum cannot be greater than 1000";
+            response.responseSize = strlen(responseString);
+            memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+    }
+
+    unsigned long long taskId = 0;
+    // /tasks/{id}/quantum -> id starts at index 7
+    for(int i=7; i<strlen(path); i++){
+        if(path[i]=='/'){
+            if(i==7){
+                CoAPResponse response;
+                response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+                response.responseSize = 0;
+                response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+                return response;
+            }
+
+            break;
+        }
+
+        if(path[i]<'0' || path[i]>'9'){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            response.responseSize = 0;
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+
+        taskId = taskId*10 + (path[i]-'0');
+
+        if(taskId>0xFFFFFFFF){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            char* responseString = (char*)"Task ID cannot be greater than 0xFFFFFFFF";
+            response.responseSize = strlen(responseString);
+            memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+    }
+
+    CpuCore::UserTask* pUserTask = pTaskManager->getUserTask(taskId);
+
+    if(pUserTask == nullptr){
+        CoAPResponse response;
+        response.responseCode = NOT_FOUND_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    if(!pUserTask->setQuantum(quantum)){
+        CoAPResponse response;
+        response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+        char* responseString = (char*)"Task quantum cannot be 0";
+        response.responseSize = strlen(responseString);
+        memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    CoAPResponse response;
+    response.responseCode = CHANGED_RESPONSE_CODE;
+    response.responseSize = 0;
+    response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+    return response;
+}
+
+TaskStatsAPIHandler::TaskStatsAPIHandler(TaskManager* pTaskManager)
+    :
+    pTaskManager(pTaskManager)
+{}
+
+CoAPResponse TaskStatsAPIHandler::handleGET(char* path,
+    ContentFormat contentFormat,
+    unsigned char* payload, 
+    unsigned int payloadSize, 
+    unsigned char responseBuffer[RESPONSE_BUFFER_SIZE])
+{
+    unsigned long long taskId = 0;
+    // /tasks/{id}/stats -> id starts at index 7
+    for(int i=7; i<strlen(path); i++){
+        if(path[i]=='/'){
+            if(i==7){
+                CoAPResponse response;
+                response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+                response.responseSize = 0;
+                response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+                return response;
+            }
+
+            break;
+        }
+
+        if(path[i]<'0' || path[i]>'9'){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            response.responseSize = 0;
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+
+        taskId = taskId*10 + (path[i]-'0');
+
+        if(taskId>0xFFFFFFFF){
+            CoAPResponse response;
+            response.responseCode = BAD_REQUEST_RESPONSE_CODE;
+            char* responseString = (char*)"Task ID cannot be greater than 0xFFFFFFFF";
+            response.responseSize = strlen(responseString);
+            memCopy((unsigned char*)responseString, responseBuffer, response.responseSize);
+            response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+            return response;
+        }
+    }
+
+    CpuCore::UserTask* pUserTask = pTaskManager->getUserTask(taskId);
+
+    if(pUserTask == nullptr){
+        CoAPResponse response;
+        response.responseCode = NOT_FOUND_RESPONSE_CODE;
+        response.responseSize = 0;
+        response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+        return response;
+    }
+
+    TaskStatistics statistics = pUserTask->getStatistics();
+
+    // Response looks like "runtimeCycles: {n}\nscheduled: {n}\nvoluntarySwitches: {n}\ninvoluntarySwitches: {n}"
+    char valueString[21];
+    unsignedLongLongToDecimalString(statistics.runtimeCycles, valueString);
+
+    unsigned int responseSize = 0;
+    char* name = (char*)"runtimeCycles: ";
+    memCopy((unsigned char*)name, responseBuffer+responseSize, strlen(name));
+    responseSize += strlen(name);
+    memCopy((unsigned char*)valueString, responseBuffer+responseSize, strlen(valueString));
+    responseSize += strlen(valueString);
+
+    char* names[3] = {(char*)"\nscheduled: ", (char*)"\nvoluntarySwitches: ", (char*)"\ninvoluntarySwitches: "};
+    unsigned int values[3] = {statistics.numTimesScheduled, statistics.numVoluntarySwitches, statistics.numInvoluntarySwitches};
+
+    for(int i=0; i<3; i++){
+        unsigned int nameSize = strlen(names[i]);
+        memCopy((unsigned char*)names[i], responseBuffer+responseSize, nameSize);
+        responseSize += nameSize;
+
+        unsignedIntToDecimalString(values[i], valueString);
+        unsigned int valueSize = strlen(valueString);
+        memCopy((unsigned char*)valueString, responseBuffer+responseSize, valueSize);
+        responseSize += valueSize;
+    }
+
+    CoAPResponse response;
+    response.responseCode = CONTENT_RESPONSE_CODE;
+    response.responseSize = responseSize;
+    response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+    return response;
+}
+
+CoAPResponse SchedulerStatsAPIHandler::handleGET(char* path,
+    ContentFormat contentFormat,
+    unsigned char* payload, 
+    unsigned int payloadSize, 
+    unsigned char responseBuffer[RESPONSE_BUFFER_SIZE])
+{
+    // Every cpu core keeps its own statistics, these are added up over all cpu cores (the average number of cycles of a 
+    // task switch is weighted by the number of task switches of each cpu core)
+    TaskSwitchStatistics statistics;
+    unsigned long long totalTaskSwitchCycles = 0;
+    unsigned int numCpuCores = 0;
+    for(unsigned int cpuCoreId = 0; cpuCoreId < CpuCore::getNumCpuCores(); cpuCoreId++){
+        CpuCore* pCpuCore = CpuCore::getCpuCore(cpuCoreId);
+        if(pCpuCore==nullptr){
+            continue;
+        }
+        numCpuCores++;
+
+        TaskSwitchStatistics cpuCoreStatistics = pCpuCore->getTaskSwitchStatistics();
+        statistics.numTaskSwitches += cpuCoreStatistics.numTaskSwitches;
+        statistics.numPageDirectoryReloads += cpuCoreStatistics.numPageDirectoryReloads;
+        statistics.numWakeUpPreemptions += cpuCoreStatistics.numWakeUpPreemptions;
+        statistics.numTimerInterrupts += cpuCoreStatistics.numTimerInterrupts;
+        totalTaskSwitchCycles += ((unsigned long long)cpuCoreStatistics.averageTaskSwitchCycles)*cpuCoreStatistics.numTaskSwitches;
+    }
+    if(statistics.numTaskSwitches > 0){
+        statistics.averageTaskSwitchCycles = (unsigned int)(totalTaskSwitchCycles/statistics.numTaskSwitches);
+    }
+
+    // Application processors copy the timer ticks of the bootstrap core, thus every cpu core counts the same timer ticks
+    unsigned int timerTicks = CpuCore::getCpuCore(CpuCore::getThisCpuCoreId())->getTimerTicks();
+
+    // Response looks like "cpuCores: {n}\ntaskSwitches: {n}\npageDirectoryReloads: {n}\naverageTaskSwitchCycles: {n}
+    // \nwakeUpPreemptions: {n}\ntimerInterrupts: {n}\ntimerTicks: {n}", all of them added up over the cpu cores except 
+    // timerTicks (the timer ticks every cpu core counted)
+    char* names[7] = {(char*)"cpuCores: ", (char*)"\ntaskSwitches: ", (char*)"\npageDirectoryReloads: ", 
+        (char*)"\naverageTaskSwitchCycles: ", (char*)"\nwakeUpPreemptions: ", (char*)"\ntimerInterrupts: ", (char*)"\ntimerTicks: "};
+    unsigned int values[7] = {numCpuCores, statistics.numTaskSwitches, statistics.numPageDirectoryReloads, 
+        statistics.averageTaskSwitchCycles, statistics.numWakeUpPreemptions, statistics.numTimerInterrupts, timerTicks};
+
+    unsigned int responseSize = 0;
+    for(int i=0; i<7; i++){
+        unsigned int nameSize = strlen(names[i]);
+        memCopy((unsigned char*)names[i], responseBuffer+responseSize, nameSize);
+        responseSize += nameSize;
+
+        char valueString[11];
+        unsignedIntToDecimalString(values[i], valueString);
+        unsigned int valueSize = strlen(valueString);
+        memCopy((unsigned char*)valueString, responseBuffer+responseSize, valueSize);
+        responseSize += valueSize;
+    }
+
+    CoAPResponse response;
+    response.responseCode = CONTENT_RESPONSE_CODE;
+    response.responseSize = responseSize;
+    response.contentFormat = ContentFormat::Text_Plain_Charset_UTF8;
+    return response;
 }
\ No newline at end of file
@@ -55,4 +55,55 @@ class TaskDataAPIHandler : public CoAPHandler{
             unsigned char* payload, 
             unsigned int payloadSize, 
             unsigned char responseBuffer[RESPONSE_BUFFER_SIZE]) override;
+};
+class TaskWeightAPIHandler : public CoAPHandler{
+    private:
+        TaskManager* pTaskManager;
+
+    public:
+        TaskWeightAPIHandler(TaskManager* pTaskManager);
+
+        CoAPResponse handlePUT(char* path,
+            ContentFormat contentFormat,
+            unsigned char* payload, 
+            unsigned int payloadSize, 
+            unsigned char responseBuffer[RESPONSE_BUFFER_SIZE]) override;
+};
+
+class TaskQuantumAPIHandler : public CoAPHandler{
+    private:
+        TaskManager* pTaskManager;
+
+    public:
+        TaskQuantumAPIHandler(TaskManager* pTaskManager);
+
+        CoAPResponse handlePUT(char* path,
+            ContentFormat contentFormat,
+            unsigned char* payload, 
+            unsigned int payloadSize, 
+            unsigned char responseBuffer[RESPONSE_BUFFER_SIZE]) override;
+};
+
+
+class TaskStatsAPIHandler : public CoAPHandler{
+    private:
+        TaskManager* pTaskManager;
+
+    public:
+        TaskStatsAPIHandler(TaskManager* pTaskManager);
+
+        CoAPResponse handleGET(char* path,
+            ContentFormat contentFormat,
+            unsigned char* payload, 
+            unsigned int payloadSize, 
+            unsigned char responseBuffer[RESPONSE_BUFFER_SIZE]) override;
+};
+
+class SchedulerStatsAPIHandler : public CoAPHandler{
+    public:
+        CoAPResponse handleGET(char* path,
+            ContentFormat contentFormat,
+            unsigned char* payload, 
+            unsigned int payloadSize, 
+            unsigned char responseBuffer[RESPONSE_BUFFER_SIZE]) override;
 };
\ No newline at end of file
@@ -11,7 +11,11 @@
     GET /tasks/{id}/state returns "Running" or "Not Running"
     PUT /tasks/{id}/data/{address} [data], sets data at given address for task, uses octet-stream payload
     PUT /tasks/{id}/state [state], state can only be "Running" to change state to running, uses plain-text payload
+    PUT /tasks/{id}/weight [weight], sets the scheduling weight (1 till 65536, default 1024) of the task, uses plain-text payload
+    PUT /tasks/{id}/quantum [quantum], sets the number of timer ticks (1 till 1000, a tick is 1ms) the task can run before it is preempted, uses plain-text payload
+    GET /tasks/{id}/stats returns the cpu cycles the task has been running and how often it was scheduled, gave up the cpu itself or was preempted
     DELETE /tasks/{id} to delete task
+    GET /scheduler/stats returns the number of task switches, page directory reloads and the average cost of a task switch in cpu cycles
 */
 
 void osManagementTask(SocketManager* pSocketManager, MemoryManager* pMemoryManager){
@@ -29,15 +33,23 @@ void osManagementTask(SocketManager* pSocketManager, MemoryManager* pMemoryManag
         pScreen->printk((char*)"Failed to allocate memory for TaskManager in OS management task\n");
         return;
     }
-    TaskManager* pTaskManager = new((unsigned char*)taskManagerAddr) TaskManager();
+    TaskManager* pTaskManager = new((unsigned char*)taskManagerAddr) TaskManager(pMemoryManager);
     
     TaskAPIHandler taskHandler(pTaskManager);
     TaskStateAPIHandler taskStateHandler(pTaskManager);
     TaskDataAPIHandler taskDataHandler(pTaskManager);
+    TaskWeightAPIHandler taskWeightHandler(pTaskManager);
+    TaskQuantumAPIHandler taskQuantumHandler(pTaskManager);
+    TaskStatsAPIHandler taskStatsHandler(pTaskManager);
+    SchedulerStatsAPIHandler schedulerStatsHandler;
 
     pCoAPServer->setPathHandler((char*)"/tasks/^", &taskHandler);
     pCoAPServer->setPathHandler((char*)"/tasks/^/state", &taskStateHandler);
     pCoAPServer->setPathHandler((char*)"/tasks/^/data/^", &taskDataHandler);
+    pCoAPServer->setPathHandler((char*)"/tasks/^/weight", &taskWeightHandler);
+    pCoAPServer->setPathHandler((char*)"/tasks/^/quantum", &taskQuantumHandler);
+    pCoAPServer->setPathHandler((char*)"/tasks/^/stats", &taskStatsHandler);
+    pCoAPServer->setPathHandler((char*)"/scheduler/stats", &schedulerStatsHandler);
 
     #if E2E_TESTING
     SerialLog* pSerialLog = SerialLog::getSerialLog();
@@ -1,32 +1,22 @@
 #include "task_manager.h"
 #include "../../cpp_lib/placement_new.h"
 
-#define VIRTUAL_TASK_SPACE_BEGIN_ADDR 0x2000000
-
-TaskManager::TaskManager()
+TaskManager::TaskManager(MemoryManager* pMemoryManager)
     :
-    activeTasksLinkedListHead(nullptr),
-    unusedTaskLinkedListElementsHead(nullptr)
-{
-    for(unsigned int i = 0; i < TASK_MANAGER_MAX_TASKS; i++){
-        taskLinkedListElements[i].value = {i, 0};
-        if(i == TASK_MANAGER_MAX_TASKS-1){
-            taskLinkedListElements[i].next = nullptr;
-        }
-        else{
-            taskLinkedListElements[i].next = &taskLinkedListElements[i+1];
-        }
-    }
-    unusedTaskLinkedListElementsHead = &taskLinkedListElements[0];
-}
+    pMemoryManager(pMemoryManager),
+    numTasks(0),
+    activeTasksLinkedListHead(nullptr)
+{}
 
 TaskManager::~TaskManager(){
-    LinkedListElement<Pair<unsigned int, unsigned int>>* currentElement = activeTasksLinkedListHead;
+    LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* currentElement = activeTasksLinkedListHead;
     while(currentElement != nullptr){
-        CpuCore::UserTask* userTask = (CpuCore::UserTask*)userTaskBuffers[currentElement->value.first].buffer;
+        CpuCore::UserTask* userTask = currentElement->value.second;
         userTask->~UserTask();
+        pMemoryManager->free((unsigned char*)userTask);
 
-        LinkedListElement<Pair<unsigned int, unsigned int>>* nextElement = currentElement->next;
+        LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* nextElement = currentElement->next;
+        pMemoryManager->free((unsigned char*)currentElement);
         currentElement = nextElement;
     }
 }
@@ -37,36 +27,46 @@ CreateUserTaskResult TaskManager::createUserTask(CpuCore* pCpuCore, unsigned int
     }
 
     if(activeTasksLinkedListHead != nullptr){
-        LinkedListElement<Pair<unsigned int, unsigned int>>* currentElement = activeTasksLinkedListHead;
+        LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* currentElement = activeTasksLinkedListHead;
         while(currentElement != nullptr){
-            if(currentElement->value.second == id){
+            if(currentElement->value.first == id){
                 return CreateUserTaskResult::ID_ALREADY_EXISTS;
             }
             currentElement = currentElement->next;
         }
     }
 
-    if(unusedTaskLinkedListElementsHead == nullptr){
+    if(numTasks == TASK_MANAGER_MAX_TASKS){
+        return CreateUserTaskResult::TOO_MANY_TASKS;
+    }
+
+    unsigned char* newElementAddr = pMemoryManager->allocate(alignof(LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>), 
+        sizeof(LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>));
+    if(newElementAddr == nullptr){
         return CreateUserTaskResult::TOO_MANY_TASKS;
     }
 
-    LinkedListElement<Pair<unsigned int, unsigned int>>* newElement = unusedTaskLinkedListElementsHead;
-    unusedTaskLinkedListElementsHead = unusedTaskLinkedListElementsHead->next;
+    unsigned char* userTaskAddr = pMemoryManager->allocate(alignof(CpuCore::UserTask), sizeof(CpuCore::UserTask));
+    if(userTaskAddr == nullptr){
+        pMemoryManager->free(newElementAddr);
+        return CreateUserTaskResult::TOO_MANY_TASKS;
+    }
 
-    newElement->value.second = id;
+    LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* newElement = new(newElementAddr) LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>();
+    newElement->value.first = id;
+    newElement->value.second = new(userTaskAddr) CpuCore::UserTask(pCpuCore, VIRTUAL_TASK_SPACE_BEGIN_ADDR);
     newElement->next = activeTasksLinkedListHead;
     activeTasksLinkedListHead = newElement;
-
-    CpuCore::UserTask* userTask = new(userTaskBuffers[newElement->value.first].buffer) CpuCore::UserTask(pCpuCore, VIRTUAL_TASK_SPACE_BEGIN_ADDR);
+    numTasks++;
 
     return CreateUserTaskResult::SUCCESS;
 }
 
 CpuCore::UserTask* TaskManager::getUserTask(unsigned int id){
-    LinkedListElement<Pair<unsigned int, unsigned int>>* currentElement = activeTasksLinkedListHead;
+    LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* currentElement = activeTasksLinkedListHead;
     while(currentElement != nullptr){
-        if(currentElement->value.second == id){
-            return (CpuCore::UserTask*)userTaskBuffers[currentElement->value.first].buffer;
+        if(currentElement->value.first == id){
+            return currentElement->value.second;
         }
         currentElement = currentElement->next;
     }
@@ -79,22 +79,22 @@ RemoveUserTaskResult TaskManager::removeUserTask(unsigned int id){
         return RemoveUserTaskResult::ID_IS_NULL;
     }
 
-    LinkedListElement<Pair<unsigned int, unsigned int>>* previousElement = nullptr;
-    LinkedListElement<Pair<unsigned int, unsigned int>>* currentElement = activeTasksLinkedListHead;
+    LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* previousElement = nullptr;
+    LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* currentElement = activeTasksLinkedListHead;
     while(currentElement != nullptr){
-        if(currentElement->value.second == id){
+        if(currentElement->value.first == id){
             if(previousElement == nullptr){
                 activeTasksLinkedListHead = currentElement->next;
             }
             else{
                 previousElement->next = currentElement->next;
             }
+            numTasks--;
 
-            currentElement->next = unusedTaskLinkedListElementsHead;
-            unusedTaskLinkedListElementsHead = currentElement;
-
-            CpuCore::UserTask* userTask = (CpuCore::UserTask*)userTaskBuffers[currentElement->value.first].buffer;
+            CpuCore::UserTask* userTask = currentElement->value.second;
             userTask->~UserTask();
+            pMemoryManager->free((unsigned char*)userTask);
+            pMemoryManager->free((unsigned char*)currentElement);
 
             return RemoveUserTaskResult::SUCCESS;
         }
@@ -2,14 +2,11 @@
 
 #include "../../cpp_lib/list.h"
 #include "../../cpp_lib/pair.h"
+#include "../../cpp_lib/memory_manager.h"
 #include "../cpu_core/cpu_core.h"
 
 #define TASK_MANAGER_MAX_TASKS (2*NUM_POSSIBLE_TASKS)
 
-typedef struct UserTaskBuffer{
-    unsigned char buffer[sizeof(CpuCore::UserTask)];
-} UserTaskBuffer __attribute__((aligned(alignof(CpuCore::UserTask))));
-
 enum class CreateUserTaskResult{
     SUCCESS,
     ID_IS_NULL,
@@ -25,14 +22,14 @@ enum class RemoveUserTaskResult{
 
 class TaskManager{
     private:
-        UserTaskBuffer userTaskBuffers[TASK_MANAGER_MAX_TASKS];
+        // User tasks and their list elements are allocated when the task is created and freed again when it is removed
+        MemoryManager* pMemoryManager;
+        unsigned int numTasks;
 
-        LinkedListElement<Pair<unsigned int, unsigned int>> taskLinkedListElements[TASK_MANAGER_MAX_TASKS];
-        LinkedListElement<Pair<unsigned int, unsigned int>>* activeTasksLinkedListHead;
-        LinkedListElement<Pair<unsigned int, unsigned int>>* unusedTaskLinkedListElementsHead;
+        LinkedListElement<Pair<unsigned int, CpuCore::UserTask*>>* activeTasksLinkedListHead;
     
     public:
-        TaskManager();
+        TaskManager(MemoryManager* pMemoryManager);
         ~TaskManager();
 
         CreateUserTaskResult createUserTask(CpuCore* pCpuCore, unsigned int id);
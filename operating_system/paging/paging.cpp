@@ -80,7 +80,7 @@ void PageTable::changePTE(unsigned int pteIndex, PTE& newPTE){
 
     if(newPTE.pagePhysicalAddr & 0xFFF) return;
 
-    unsigned int newPteBits = newPTE.pagePhysicalAddr | (((unsigned int)(!newPTE.kernelPrivilegeOnly) << 2)+((unsigned int)1 << 1)+((unsigned int)newPTE.pteIsValid));
+    unsigned int newPteBits = newPTE.pagePhysicalAddr | (((unsigned int)newPTE.isGlobal << 8)+((unsigned int)(!newPTE.kernelPrivilegeOnly) << 2)+((unsigned int)(!newPTE.isReadOnly) << 1)+((unsigned int)newPTE.pteIsValid));
 
     pageTableEntries[pteIndex] = newPteBits;
 }
@@ -94,6 +94,8 @@ PTE PageTable::getPTE(unsigned int pteIndex){
 
     requestedPTE.kernelPrivilegeOnly = !(bool)(requestedPTEBits & 0x4);
     requestedPTE.pteIsValid = (bool)(requestedPTEBits & 0x1);
+    requestedPTE.isGlobal = (bool)(requestedPTEBits & 0x100);
+    requestedPTE.isReadOnly = !(bool)(requestedPTEBits & 0x2);
     requestedPTE.pagePhysicalAddr = requestedPTEBits & 0xFFFFF000;
 
     return requestedPTE;
@@ -14,6 +14,11 @@ typedef struct PTE{
     unsigned int pagePhysicalAddr;
     bool kernelPrivilegeOnly;
     bool pteIsValid;
+    // Global pages are not flushed from the TLB when CR3 is reloaded, should only be used for mappings which
+    // are the same in every page directory
+    bool isGlobal = false;
+    // Read-only pages can still be written by the kernel (CR0.WP is not set), only user mode writes cause a page fault
+    bool isReadOnly = false;
 } PTE;
 
 class PageDirectory{
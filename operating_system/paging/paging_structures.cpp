@@ -2,7 +2,7 @@
 #include "../../cpp_lib/placement_new.h"
 #include "../global_resources/screen.h"
 
-PagingStructures::PagingStructures(){
+PagingStructures::PagingStructures(unsigned int numGlobalPageTables){
     Screen* pScreen = Screen::getScreen();
 
     if(sizeof(PageDirectory)!=8192){
@@ -21,7 +21,7 @@ PagingStructures::PagingStructures(){
         PageTable* pPageTable = new((unsigned char*)&pageTables[i]) PageTable();
 
         for(unsigned int j = 0; j < 1024; j++){
-            PTE newPTE = {(unsigned int)(i*(0x1000*1024)+j*0x1000), true, true};
+            PTE newPTE = {(unsigned int)(i*(0x1000*1024)+j*0x1000), true, true, i<numGlobalPageTables};
             pPageTable->changePTE(j, newPTE);
         }
 
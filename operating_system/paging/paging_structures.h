@@ -10,7 +10,9 @@ class PagingStructures : public PagingStructureAccessor{
         Page pageTables[1023];
 
     public:
-        PagingStructures();
+        // The pages managed by the first numGlobalPageTables page tables are marked global, these mappings should never 
+        // be changed by page directories of tasks
+        PagingStructures(unsigned int numGlobalPageTables);
 
         PageDirectory* getPageDirectory() override;
         PageTable* getPageTable(unsigned int i) override;
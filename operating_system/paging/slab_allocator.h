@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../../cpp_lib/memory_manager.h"
+
+// Hands out objects of type T from slabs of NUM_PAGES_PER_SLAB contiguous pages, a new slab is only allocated from the 
+// MemoryManager once all objects of the previous slabs are in use, this way memory usage grows with the number of objects
+// which are in use at the same time instead of some compile time maximum
+// Slabs come from the MemoryManager instead of the PageAllocator because the kernel objects in them are also used while 
+// the page directory of a user task is loaded, pages of the PageAllocator (from 0x2000000 on) can be remapped there
+// Slabs are never given back to the MemoryManager
+// Important: allocate and free should not be called concurrently
+template<typename T, unsigned int NUM_PAGES_PER_SLAB>
+class SlabAllocator{
+    private:
+        union Slot{
+            Slot* nextFreeSlot;
+            alignas(T) unsigned char object[sizeof(T)];
+        };
+
+        MemoryManager* pMemoryManager;
+        Slot* freeSlotsHead;
+
+        bool addSlab(){
+            unsigned char* slabBegin = pMemoryManager->allocate(0x1000, NUM_PAGES_PER_SLAB*0x1000);
+            if(slabBegin==nullptr){
+                return false;
+            }
+
+            Slot* slots = (Slot*)slabBegin;
+            unsigned int numSlots = (NUM_PAGES_PER_SLAB*0x1000)/sizeof(Slot);
+            for(unsigned int i=numSlots; i>0; i--){
+                slots[i-1].nextFreeSlot = freeSlotsHead;
+                freeSlotsHead = &slots[i-1];
+            }
+
+            return true;
+        }
+
+    public:
+        SlabAllocator(MemoryManager* pMemoryManager)
+            :
+            pMemoryManager(pMemoryManager),
+            freeSlotsHead(nullptr)
+        {}
+
+        // Returns nullptr if no memory is left, otherwise returns uninitialized memory for an object of type T 
+        // (use placement new)
+        unsigned char* allocate(){
+            if(freeSlotsHead==nullptr && !addSlab()){
+                return nullptr;
+            }
+
+            Slot* pSlot = freeSlotsHead;
+            freeSlotsHead = pSlot->nextFreeSlot;
+
+            return pSlot->object;
+        }
+
+        // The destructor of the object should already have been called
+        void free(T* pObject){
+            Slot* pSlot = (Slot*)pObject;
+            pSlot->nextFreeSlot = freeSlotsHead;
+            freeSlotsHead = pSlot;
+        }
+};